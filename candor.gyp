@@ -22,6 +22,8 @@
       'src/code-space.cc',
       'src/cpu.cc',
       'src/gc.cc',
+      'src/perf-counters.cc',
+      'src/runtime-stats.cc',
       'src/heap.cc',
       'src/lexer.cc',
       'src/parser.cc',
@@ -38,6 +40,8 @@
       'src/pic.cc',
       'src/macroassembler.cc',
       'src/runtime.cc',
+      'src/simd.cc',
+      'src/sort.cc',
     ],
     'conditions': [
       ['target_arch == "x64"', {
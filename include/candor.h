@@ -47,7 +47,14 @@ class String;
 class Object;
 class Array;
 class CData;
+class Map;
+class Set;
+class Key;
 struct Error;
+struct GCStats;
+struct GCPause;
+struct PerfStats;
+struct HeapHistogram;
 
 class Isolate {
  public:
@@ -62,6 +69,37 @@ class Isolate {
 
   Array* StackTrace();
 
+  void GetGCStats(GCStats* stats);
+
+  // Copies up to `max` most recent collections into `pauses` (oldest first),
+  // returns total number of collections. Only the last 1024 collections are
+  // remembered.
+  uint32_t GetGCPauses(GCPause* pauses, uint32_t max);
+
+  // Walks both heap spaces page by page, that's cheaper than a snapshot but
+  // includes garbage which wasn't collected yet
+  void GetHeapHistogram(HeapHistogram* histogram);
+
+  // Hardware performance counters, both return false if counters are
+  // not supported by the platform or not permitted by the kernel
+  bool EnablePerfCounters();
+  bool GetPerfStats(PerfStats* stats);
+
+  // Counts calls of stubs and runtime functions (and, optionally, CPU cycles
+  // spent in the latter). Should be called before creating an isolate.
+  static void EnableRuntimeStats(bool cycles = false);
+
+  // Prints table of counters sorted by number of calls to stderr
+  void PrintRuntimeStats();
+
+  // Counts hits, misses and state changes of every property access inline
+  // cache (optimized code only). Should be called before compiling code.
+  static void EnableICStats();
+
+  // Prints inline cache sites (with their source positions) sorted by
+  // number of misses to stderr
+  void PrintICStats();
+
   static void EnableFullgenLogging();
   static void DisableFullgenLogging();
   static void EnableHIRLogging();
@@ -86,6 +124,9 @@ class Isolate {
   friend class Object;
   friend class Array;
   friend class CData;
+  friend class Map;
+  friend class Set;
+  friend class Key;
 
   template <class T>
   friend class Handle;
@@ -102,6 +143,87 @@ struct Error {
   uint32_t length;
 };
 
+// Pauses are in microseconds
+struct GCStats {
+  uint32_t new_space_count;
+  uint32_t old_space_count;
+
+  int64_t new_space_pause;
+  int64_t old_space_pause;
+  int64_t max_pause;
+};
+
+struct GCPause {
+  bool old_space;
+
+  // In microseconds
+  int64_t pause;
+
+  // Bytes freed by collection
+  int64_t reclaimed;
+};
+
+struct HeapHistogramEntry {
+  uint32_t count;
+  uint64_t bytes;
+};
+
+struct HeapHistogram {
+  enum Type {
+    kContext,
+    kBoolean,
+    kNumber,
+    kString,
+    kObject,
+    kArray,
+    kFunction,
+    kCData,
+    kHashMap,
+    kHashSet,
+    kMap,
+    kTypeCount
+  };
+
+  // Map with 2^i slots falls into bucket i, last bucket holds bigger ones
+  static const int kMapBucketCount = 16;
+
+  // Number of collections survived, last one holds tenured objects
+  static const int kGenerationCount = 6;
+
+  HeapHistogramEntry new_space;
+  HeapHistogramEntry old_space;
+
+  HeapHistogramEntry types[kTypeCount];
+  HeapHistogramEntry flat_strings;
+  HeapHistogramEntry cons_strings;
+  HeapHistogramEntry maps[kMapBucketCount];
+  HeapHistogramEntry generations[kGenerationCount];
+
+  // Bytes left unused at the ends of pages
+  uint64_t page_end_free;
+
+  // Map slots (key and value) holding neither
+  HeapHistogramEntry empty_map_slots;
+};
+
+// Counter is -1 if it is unavailable
+struct PerfCounterValues {
+  int64_t cycles;
+  int64_t instructions;
+  int64_t branch_misses;
+  int64_t l1d_misses;
+  int64_t llc_misses;
+  int64_t dtlb_misses;
+};
+
+// Totals are counted since EnablePerfCounters(), gc and compile are parts of
+// it spent in the garbage collector and in the compiler
+struct PerfStats {
+  PerfCounterValues total;
+  PerfCounterValues gc;
+  PerfCounterValues compile;
+};
+
 class Value {
  public:
   enum ValueType {
@@ -113,7 +235,9 @@ class Value {
     kFunction,
     kObject,
     kArray,
-    kCData
+    kCData,
+    kMap,
+    kSet
   };
 
   typedef void (*WeakCallback)(Value* value);
@@ -150,12 +274,23 @@ class Function : public Value {
  public:
   typedef Value* (*BindingCallback)(uint32_t argc, Value* argv[]);
 
+  // Typed counterparts of bindings, called with unboxed arguments
+  // when all of them are numbers (BindingCallback is called otherwise)
+  typedef double (*DoubleCallback)(double arg);
+  typedef double (*DoubleCallback2)(double lhs, double rhs);
+  typedef int64_t (*IntegralCallback)(int64_t arg);
+  typedef int64_t (*IntegralCallback2)(int64_t lhs, int64_t rhs);
+
   static Function* New(const char* filename,
                        const char* source,
                        uint32_t length);
   static Function* New(const char* filename, const char* source);
   static Function* New(const char* source);
   static Function* New(BindingCallback callback);
+  static Function* New(BindingCallback callback, DoubleCallback fast);
+  static Function* New(BindingCallback callback, DoubleCallback2 fast);
+  static Function* New(BindingCallback callback, IntegralCallback fast);
+  static Function* New(BindingCallback callback, IntegralCallback2 fast);
 
   Object* GetContext();
   void SetContext(Object* context);
@@ -165,6 +300,12 @@ class Function : public Value {
   Value* Call(uint32_t argc, Value* argv[]);
 
   static const ValueType tag = kFunction;
+
+ protected:
+  static Function* NewFast(BindingCallback callback,
+                           char* fast,
+                           int type,
+                           uint32_t argc);
 };
 
 class Nil : public Value {
@@ -214,12 +355,20 @@ class Object : public Value {
  public:
   static Object* New();
 
+  // `math` module: floor, ceil, round, sqrt, abs, min, max, pow, exp, log,
+  // sin, cos, tan. Put it into context as `math` to get calls like
+  // `global.math.floor(x)` compiled inline.
+  static Object* NewMath();
+
   void Set(Value* key, Value* value);
   void Set(const char* key, Value* value);
   Value* Get(Value* key);
   Value* Get(const char* key);
+  void Set(Key* key, Value* value);
+  Value* Get(Key* key);
   void Delete(Value* key);
   void Delete(const char* key);
+  void Delete(Key* key);
 
   Array* Keys();
   Object* Clone();
@@ -231,10 +380,26 @@ class Array : public Value {
  public:
   static Array* New();
 
+  // Reserves space for `length` elements, array's length stays zero
+  static Array* New(int64_t length);
+
   void Set(int64_t key, Value* value);
   Value* Get(int64_t key);
   void Delete(int64_t key);
 
+  void SetRange(int64_t start, int64_t count, Value* values[]);
+  void SetRange(int64_t start, int64_t count, const double* values);
+  void SetRange(int64_t start, int64_t count, const int64_t* values);
+  void GetRange(int64_t start, int64_t count, Value* values[]);
+  void GetRange(int64_t start, int64_t count, double* values);
+  void GetRange(int64_t start, int64_t count, int64_t* values);
+
+  // Numbers and strings are sorted in ascending order (as `<` compares them),
+  // other values go after them. Comparator returns negative number if its
+  // first argument should go before the second one.
+  void Sort();
+  void Sort(Function* comparator);
+
   int64_t Length();
 
   static const ValueType tag = kArray;
@@ -242,13 +407,81 @@ class Array : public Value {
 
 class CData : public Value {
  public:
+  // Typed views are indexable from script with `data[i]`
+  enum ElementType {
+    kRaw,
+    kInt8,
+    kUint8,
+    kInt16,
+    kUint16,
+    kInt32,
+    kUint32,
+    kInt64,
+    kUint64,
+    kFloat32,
+    kFloat64
+  };
+
   static CData* New(size_t size);
+  static CData* New(ElementType type, size_t length);
 
   void* GetContents();
+  ElementType GetElementType();
+
+  // Number of elements (bytes for raw data)
+  size_t Length();
+
+  // Bulk operations over typed views, float64 ones are vectorized.
+  // Elements are converted to and from doubles, operations over several
+  // views stop at the shortest one. Raw data is treated as an empty view.
+  double Sum();
+  bool Min(double* result);  // NaNs are ignored, false if view is empty
+  bool Max(double* result);
+  double Dot(CData* other);
+  int64_t IndexOf(double value);  // -1 if not found
+
+  void Fill(double value);
+  void Copy(CData* src);
+  void ScaleAdd(CData* src, double k);  // this[i] += src[i] * k
+  void Add(CData* lhs, CData* rhs);  // this[i] = lhs[i] + rhs[i]
+  void Sub(CData* lhs, CData* rhs);
+  void Mul(CData* lhs, CData* rhs);
+  void Div(CData* lhs, CData* rhs);
 
   static const ValueType tag = kCData;
 };
 
+// Hash map with arbitrary keys, iterated in insertion order
+// (nil keys are ignored)
+class Map : public Value {
+ public:
+  static Map* New();
+
+  void Set(Value* key, Value* value);
+  Value* Get(Value* key);
+  bool Has(Value* key);
+  void Delete(Value* key);
+
+  Array* Keys();
+  int64_t Size();
+
+  static const ValueType tag = kMap;
+};
+
+class Set : public Value {
+ public:
+  static Set* New();
+
+  void Add(Value* key);
+  bool Has(Value* key);
+  void Delete(Value* key);
+
+  Array* Keys();
+  int64_t Size();
+
+  static const ValueType tag = kSet;
+};
+
 template <class T>
 class Handle {
  public:
@@ -282,6 +515,26 @@ class Handle {
   internal::HValueReference* ref;
 };
 
+// Pre-hashed property name, interned once and reusable across lookups.
+// Remembers the slot where it was found last time, so repeated
+// `Object::Get`/`Object::Set` calls on similarly-shaped objects skip hashing.
+class Key {
+ public:
+  explicit Key(const char* value);
+  Key(const char* value, uint32_t len);
+
+  inline String* operator*() { return *str_; }
+
+ protected:
+  void Init(const char* value, uint32_t len);
+  char** Lookup(char* obj, int insert);
+
+  Handle<String> str_;
+  uint32_t hint_;
+
+  friend class Object;
+};
+
 class CWrapper {
  public:
   explicit CWrapper(const int* magic);
@@ -29,6 +29,10 @@
 #include "heap.h"
 #include "heap-inl.h"
 #include "code-space.h"
+#include "gc.h"
+#include "perf-counters.h"
+#include "pic.h"
+#include "runtime-stats.h"
 #include "fullgen.h"
 #include "fullgen-inl.h"
 #include "hir.h"
@@ -36,6 +40,8 @@
 #include "lir.h"
 #include "lir-inl.h"
 #include "runtime.h"
+#include "simd.h"
+#include "sort.h"
 #include "utils.h"
 
 namespace candor {
@@ -52,7 +58,9 @@ using namespace internal;
     V(Function)\
     V(Object)\
     V(Array)\
-    V(CData)
+    V(CData)\
+    V(Map)\
+    V(Set)
 
 #define METHODS_ENUM(V)\
     template V* Value::As<V>();\
@@ -86,6 +94,8 @@ Isolate::Isolate() {
 
 
 Isolate::~Isolate() {
+  delete heap->perf_counters();
+  delete heap->runtime_stats();
   delete heap;
   delete space;
 }
@@ -132,6 +142,172 @@ Array* Isolate::StackTrace() {
 }
 
 
+void Isolate::GetGCStats(GCStats* stats) {
+  GC* gc = heap->gc();
+
+  stats->new_space_count = gc->count(GC::kNewSpace);
+  stats->old_space_count = gc->count(GC::kOldSpace);
+  stats->new_space_pause = gc->total_pause(GC::kNewSpace);
+  stats->old_space_pause = gc->total_pause(GC::kOldSpace);
+  stats->max_pause = gc->max_pause(GC::kNewSpace);
+  if (gc->max_pause(GC::kOldSpace) > stats->max_pause) {
+    stats->max_pause = gc->max_pause(GC::kOldSpace);
+  }
+}
+
+
+uint32_t Isolate::GetGCPauses(GCPause* pauses, uint32_t max) {
+  GC* gc = heap->gc();
+
+  // Copy the most recent ones
+  uint32_t count = gc->pause_count();
+  uint32_t start = count > max ? count - max : 0;
+  for (uint32_t i = start; i < count; i++) {
+    GC::Pause* p = gc->pause_at(i);
+
+    pauses[i - start].old_space = p->type() == GC::kOldSpace;
+    pauses[i - start].pause = p->pause();
+    pauses[i - start].reclaimed = p->reclaimed();
+  }
+
+  return gc->pause_total();
+}
+
+
+class HistogramVisitor : public HeapVisitor {
+ public:
+  HistogramVisitor(HeapHistogram* histogram, HeapHistogramEntry* space) :
+      histogram_(histogram), space_(space) {
+  }
+
+  void VisitValue(HValue* value, uint32_t size) {
+    Add(space_, size);
+
+    // HeapHistogram::Type follows order of heap tags
+    Heap::HeapTag tag = value->tag();
+    Add(&histogram_->types[tag - Heap::kTagContext], size);
+
+    uint8_t generation = value->Generation();
+    if (generation >= HeapHistogram::kGenerationCount) {
+      generation = HeapHistogram::kGenerationCount - 1;
+    }
+    Add(&histogram_->generations[generation], size);
+
+    if (tag == Heap::kTagString) {
+      if (HValue::GetRepresentation<HString::Representation>(value->addr()) ==
+          HString::kCons) {
+        Add(&histogram_->cons_strings, size);
+      } else {
+        Add(&histogram_->flat_strings, size);
+      }
+    } else if (tag == Heap::kTagMap) {
+      VisitMap(value->As<HMap>(), size);
+    }
+  }
+
+  void VisitPageEnd(uint32_t free) {
+    histogram_->page_end_free += free;
+  }
+
+ private:
+  void VisitMap(HMap* map, uint32_t size) {
+    uint32_t slots = map->size();
+    int bucket = 0;
+    while (bucket < HeapHistogram::kMapBucketCount - 1 &&
+           (1U << bucket) < slots) {
+      bucket++;
+    }
+    Add(&histogram_->maps[bucket], size);
+
+    char** keys = reinterpret_cast<char**>(map->space());
+    char** values = keys + slots;
+    for (uint32_t i = 0; i < slots; i++) {
+      if (keys[i] != HNil::New() || values[i] != HNil::New()) continue;
+      Add(&histogram_->empty_map_slots, 2 * HValue::kPointerSize);
+    }
+  }
+
+  static inline void Add(HeapHistogramEntry* entry, uint32_t size) {
+    entry->count++;
+    entry->bytes += size;
+  }
+
+  HeapHistogram* histogram_;
+  HeapHistogramEntry* space_;
+};
+
+
+void Isolate::GetHeapHistogram(HeapHistogram* histogram) {
+  memset(histogram, 0, sizeof(*histogram));
+
+  HistogramVisitor new_visitor(histogram, &histogram->new_space);
+  heap->new_space()->Visit(&new_visitor);
+
+  HistogramVisitor old_visitor(histogram, &histogram->old_space);
+  heap->old_space()->Visit(&old_visitor);
+}
+
+
+static void ToCounterValues(int64_t* values, PerfCounterValues* result) {
+  result->cycles = values[PerfCounters::kCycles];
+  result->instructions = values[PerfCounters::kInstructions];
+  result->branch_misses = values[PerfCounters::kBranchMisses];
+  result->l1d_misses = values[PerfCounters::kL1DMisses];
+  result->llc_misses = values[PerfCounters::kLLCMisses];
+  result->dtlb_misses = values[PerfCounters::kDTLBMisses];
+}
+
+
+bool Isolate::EnablePerfCounters() {
+  if (heap->perf_counters() != NULL) return true;
+
+  PerfCounters* counters = new PerfCounters();
+  if (!counters->Open()) {
+    delete counters;
+    return false;
+  }
+  heap->perf_counters(counters);
+
+  return true;
+}
+
+
+bool Isolate::GetPerfStats(PerfStats* stats) {
+  PerfCounters* counters = heap->perf_counters();
+  if (counters == NULL) return false;
+
+  int64_t total[PerfCounters::kCounterCount];
+  counters->ReadTotal(total);
+
+  ToCounterValues(total, &stats->total);
+  ToCounterValues(counters->phase(PerfCounters::kGC), &stats->gc);
+  ToCounterValues(counters->phase(PerfCounters::kCompile), &stats->compile);
+
+  return true;
+}
+
+
+void Isolate::EnableRuntimeStats(bool cycles) {
+  RuntimeStats::Enable(cycles);
+}
+
+
+void Isolate::PrintRuntimeStats() {
+  if (heap->runtime_stats() == NULL) return;
+  heap->runtime_stats()->Print();
+}
+
+
+void Isolate::EnableICStats() {
+  PIC::EnableStats();
+}
+
+
+void Isolate::PrintICStats() {
+  PIC::PrintStats(heap->code_space());
+}
+
+
 void Isolate::EnableFullgenLogging() {
   Fullgen::EnableLogging();
 }
@@ -267,6 +443,8 @@ bool Value::Is() {
     case kObject: tag = Heap::kTagObject; break;
     case kArray: tag = Heap::kTagArray; break;
     case kCData: tag = Heap::kTagCData; break;
+    case kMap: tag = Heap::kTagHashMap; break;
+    case kSet: tag = Heap::kTagHashSet; break;
     default: return false;
   }
 
@@ -289,6 +467,8 @@ Value::ValueType Value::Type() {
     case Heap::kTagObject: return kObject;
     case Heap::kTagArray: return kArray;
     case Heap::kTagCData: return kCData;
+    case Heap::kTagHashMap: return kMap;
+    case Heap::kTagHashSet: return kSet;
     default: return kNone;
   }
 }
@@ -321,6 +501,84 @@ void Value::ClearWeak() {
 
 
 
+#define MATH_FUNCTIONS(V)\
+    V(Floor, "floor")\
+    V(Ceil, "ceil")\
+    V(Round, "round")\
+    V(Sqrt, "sqrt")\
+    V(Abs, "abs")\
+    V(Min, "min")\
+    V(Max, "max")\
+    V(Pow, "pow")\
+    V(Exp, "exp")\
+    V(Log, "log")\
+    V(Sin, "sin")\
+    V(Cos, "cos")\
+    V(Tan, "tan")
+
+template <MathOp::MathOpType type>
+static double MathFast(double arg) {
+  return RuntimeMathValue(type, arg, 0);
+}
+
+
+template <MathOp::MathOpType type>
+static double MathFast2(double lhs, double rhs) {
+  return RuntimeMathValue(type, lhs, rhs);
+}
+
+
+template <MathOp::MathOpType type>
+static Value* MathBinding(uint32_t argc, Value* argv[]) {
+  double lhs = argc > 0 ? argv[0]->ToNumber()->Value() : 0;
+  double rhs = argc > 1 ? argv[1]->ToNumber()->Value() : 0;
+
+  return Number::NewDouble(RuntimeMathValue(type, lhs, rhs));
+}
+
+
+template <MathOp::MathOpType type>
+static Function* NewMathFunction() {
+  if (MathOp::argc(type) == 2) {
+    return Function::New(MathBinding<type>, MathFast2<type>);
+  } else {
+    return Function::New(MathBinding<type>, MathFast<type>);
+  }
+}
+
+
+// Direct calls like `global.math.floor(x)` are compiled as intrinsics
+// when the called function is one of these bindings.
+Object* Object::NewMath() {
+  Object* math = Object::New();
+
+#define MATH_SET(type, name)\
+    math->Set(name, NewMathFunction<MathOp::k##type>());
+  MATH_FUNCTIONS(MATH_SET)
+#undef MATH_SET
+
+  return math;
+}
+
+
+char* MathOp::BindingCode(MathOpType type) {
+  Function::BindingCallback code = NULL;
+
+  switch (type) {
+#define MATH_CODE(type, name)\
+    case MathOp::k##type: code = MathBinding<MathOp::k##type>; break;
+    MATH_FUNCTIONS(MATH_CODE)
+#undef MATH_CODE
+   default:
+    UNEXPECTED
+  }
+
+  return *reinterpret_cast<char**>(&code);
+}
+
+#undef MATH_FUNCTIONS
+
+
 Function* Function::New(const char* filename,
                         const char* source,
                         uint32_t length) {
@@ -368,6 +626,53 @@ Function* Function::New(BindingCallback callback) {
 }
 
 
+Function* Function::NewFast(BindingCallback callback,
+                            char* fast,
+                            int type,
+                            uint32_t argc) {
+  char* obj = HFunction::NewFastBinding(
+      ISOLATE->heap,
+      *reinterpret_cast<char**>(&callback),
+      fast,
+      static_cast<HFunction::FastBindingType>(type),
+      argc);
+
+  return Cast<Function>(obj);
+}
+
+
+Function* Function::New(BindingCallback callback, DoubleCallback fast) {
+  return NewFast(callback,
+                 *reinterpret_cast<char**>(&fast),
+                 HFunction::kFastDouble,
+                 1);
+}
+
+
+Function* Function::New(BindingCallback callback, DoubleCallback2 fast) {
+  return NewFast(callback,
+                 *reinterpret_cast<char**>(&fast),
+                 HFunction::kFastDouble,
+                 2);
+}
+
+
+Function* Function::New(BindingCallback callback, IntegralCallback fast) {
+  return NewFast(callback,
+                 *reinterpret_cast<char**>(&fast),
+                 HFunction::kFastIntegral,
+                 1);
+}
+
+
+Function* Function::New(BindingCallback callback, IntegralCallback2 fast) {
+  return NewFast(callback,
+                 *reinterpret_cast<char**>(&fast),
+                 HFunction::kFastIntegral,
+                 2);
+}
+
+
 Object* Function::GetContext() {
   return Cast<Object>(HFunction::GetContext(addr()));
 }
@@ -425,6 +730,10 @@ Number* Number::NewDouble(double value) {
 
 
 Number* Number::NewIntegral(int64_t value) {
+  // Values out of unboxed range are stored as doubles
+  if (HNumber::Untag(HNumber::Tag(value)) != value) {
+    return NewDouble(value);
+  }
   return Cast<Number>(HNumber::New(ISOLATE->heap, value));
 }
 
@@ -508,6 +817,21 @@ void Object::Delete(const char* key) {
 }
 
 
+void Object::Set(Key* key, Value* value) {
+  *key->Lookup(addr(), 1) = value->addr();
+}
+
+
+Value* Object::Get(Key* key) {
+  return Value::New(*key->Lookup(addr(), 0));
+}
+
+
+void Object::Delete(Key* key) {
+  return Delete(**key);
+}
+
+
 Array* Object::Keys() {
   return Cast<Array>(RuntimeKeysof(ISOLATE->heap, addr()));
 }
@@ -524,11 +848,20 @@ Array* Array::New() {
 }
 
 
+Array* Array::New(int64_t length) {
+  char* arr = HArray::NewEmpty(ISOLATE->heap);
+  HArray::Reserve(ISOLATE->heap, arr, length);
+
+  return Cast<Array>(arr);
+}
+
+
 void Array::Set(int64_t key, Value* value) {
+  int insert = value->Is<Nil>() ? 1 : HArray::kInsertNonNil;
   char** slot = HObject::LookupProperty(ISOLATE->heap,
                                         addr(),
                                         HNumber::ToPointer(key),
-                                        1);
+                                        insert);
   *slot = value->addr();
 }
 
@@ -537,7 +870,7 @@ Value* Array::Get(int64_t key) {
   return Value::New(*HObject::LookupProperty(ISOLATE->heap,
                                              addr(),
                                              HNumber::ToPointer(key),
-                                             1));
+                                             0));
 }
 
 
@@ -551,16 +884,370 @@ int64_t Array::Length() {
 }
 
 
+void Array::Sort() {
+  ArraySort::Sort(ISOLATE->heap, addr());
+}
+
+
+void Array::Sort(Function* comparator) {
+  ArraySort::Sort(ISOLATE->space, addr(), comparator->addr());
+}
+
+
+// Slot of array's element, goes into runtime only if map needs to grow
+static char** ArraySlot(Heap* heap, char* arr, int64_t index, int insert) {
+  char** slot = HArray::ElementSlot(arr, index, insert != 0);
+  if (slot != NULL || !insert) return slot;
+
+  return HObject::LookupProperty(heap, arr, HNumber::ToPointer(index), insert);
+}
+
+
+// Prepare array for storing `count` elements at `start`, map is grown once
+// so elements could be stored without rehashing
+static void ArrayReserveRange(Heap* heap,
+                              char* arr,
+                              int64_t start,
+                              int64_t count,
+                              bool last_nil) {
+  assert(start >= 0 && count >= 0);
+  if (count == 0) return;
+
+  HArray::Reserve(heap, arr, start + count);
+  if (HArray::Length(arr, false) <= start + count) {
+    HArray::SetLength(arr, start + count);
+    if (last_nil) {
+      HArray::InvalidateLength(arr);
+    } else {
+      HArray::ValidateLength(arr);
+    }
+  }
+}
+
+
+void Array::SetRange(int64_t start, int64_t count, Value* values[]) {
+  Heap* heap = ISOLATE->heap;
+  ArrayReserveRange(heap,
+                    addr(),
+                    start,
+                    count,
+                    count > 0 && values[count - 1]->Is<Nil>());
+
+  for (int64_t i = 0; i < count; i++) {
+    *ArraySlot(heap, addr(), start + i, 1) = values[i]->addr();
+  }
+}
+
+
+void Array::SetRange(int64_t start, int64_t count, const double* values) {
+  Heap* heap = ISOLATE->heap;
+  ArrayReserveRange(heap, addr(), start, count, false);
+
+  for (int64_t i = 0; i < count; i++) {
+    *ArraySlot(heap, addr(), start + i, 1) =
+        HNumber::FromDouble(heap, Heap::kTenureNew, values[i]);
+  }
+}
+
+
+void Array::SetRange(int64_t start, int64_t count, const int64_t* values) {
+  Heap* heap = ISOLATE->heap;
+  ArrayReserveRange(heap, addr(), start, count, false);
+
+  for (int64_t i = 0; i < count; i++) {
+    // Values out of unboxed range are stored as doubles
+    char* value = HNumber::Untag(HNumber::Tag(values[i])) == values[i] ?
+        HNumber::New(heap, values[i]) :
+        HNumber::New(heap, Heap::kTenureNew, static_cast<double>(values[i]));
+    *ArraySlot(heap, addr(), start + i, 1) = value;
+  }
+}
+
+
+void Array::GetRange(int64_t start, int64_t count, Value* values[]) {
+  Heap* heap = ISOLATE->heap;
+
+  for (int64_t i = 0; i < count; i++) {
+    char** slot = ArraySlot(heap, addr(), start + i, 0);
+    values[i] = Value::New(slot == NULL ? HNil::New() : *slot);
+  }
+}
+
+
+void Array::GetRange(int64_t start, int64_t count, double* values) {
+  Heap* heap = ISOLATE->heap;
+
+  for (int64_t i = 0; i < count; i++) {
+    char** slot = ArraySlot(heap, addr(), start + i, 0);
+    char* value = slot == NULL ? HNil::New() : *slot;
+
+    if (HValue::GetTag(value) != Heap::kTagNumber) {
+      value = RuntimeToNumber(heap, value);
+    }
+    values[i] = HNumber::DoubleValue(value);
+  }
+}
+
+
+void Array::GetRange(int64_t start, int64_t count, int64_t* values) {
+  Heap* heap = ISOLATE->heap;
+
+  for (int64_t i = 0; i < count; i++) {
+    char** slot = ArraySlot(heap, addr(), start + i, 0);
+    char* value = slot == NULL ? HNil::New() : *slot;
+
+    if (HValue::GetTag(value) != Heap::kTagNumber) {
+      value = RuntimeToNumber(heap, value);
+    }
+    values[i] = HNumber::IntegralValue(value);
+  }
+}
+
+
 CData* CData::New(size_t size) {
   return Cast<CData>(HCData::New(ISOLATE->heap, size));
 }
 
 
+CData* CData::New(ElementType type, size_t length) {
+  // Element types mirror HCData::Representation
+  return Cast<CData>(HCData::New(
+        ISOLATE->heap,
+        static_cast<HCData::Representation>(type),
+        length));
+}
+
+
 void* CData::GetContents() {
   return HCData::Data(addr());
 }
 
 
+CData::ElementType CData::GetElementType() {
+  return static_cast<ElementType>(HCData::ElementType(addr()));
+}
+
+
+size_t CData::Length() {
+  return HCData::Length(addr());
+}
+
+
+// Simd works only with typed views
+static inline bool IsTyped(CData* data) {
+  return data->GetElementType() != CData::kRaw;
+}
+
+
+double CData::Sum() {
+  if (!IsTyped(this)) return 0;
+  return Simd::Sum(addr());
+}
+
+
+bool CData::Min(double* result) {
+  if (!IsTyped(this)) return false;
+  return Simd::Min(addr(), result);
+}
+
+
+bool CData::Max(double* result) {
+  if (!IsTyped(this)) return false;
+  return Simd::Max(addr(), result);
+}
+
+
+double CData::Dot(CData* other) {
+  if (!IsTyped(this) || !IsTyped(other)) return 0;
+  return Simd::Dot(addr(), other->addr());
+}
+
+
+int64_t CData::IndexOf(double value) {
+  if (!IsTyped(this)) return -1;
+  return Simd::IndexOf(addr(), value);
+}
+
+
+void CData::Fill(double value) {
+  if (!IsTyped(this)) return;
+  Simd::Fill(addr(), value);
+}
+
+
+void CData::Copy(CData* src) {
+  if (!IsTyped(this) || !IsTyped(src)) return;
+  Simd::Copy(addr(), src->addr());
+}
+
+
+void CData::ScaleAdd(CData* src, double k) {
+  if (!IsTyped(this) || !IsTyped(src)) return;
+  Simd::ScaleAdd(addr(), src->addr(), k);
+}
+
+
+#define CDATA_ARITHMETIC(name, type)\
+    void CData::name(CData* lhs, CData* rhs) {\
+      if (!IsTyped(this) || !IsTyped(lhs) || !IsTyped(rhs)) return;\
+      Simd::Arithmetic(Simd::type, addr(), lhs->addr(), rhs->addr());\
+    }
+
+CDATA_ARITHMETIC(Add, kAdd)
+CDATA_ARITHMETIC(Sub, kSub)
+CDATA_ARITHMETIC(Mul, kMul)
+CDATA_ARITHMETIC(Div, kDiv)
+
+#undef CDATA_ARITHMETIC
+
+
+Map* Map::New() {
+  return Cast<Map>(HHashTable::New(ISOLATE->heap, Heap::kTagHashMap));
+}
+
+
+void Map::Set(Value* key, Value* value) {
+  char** slot = HObject::LookupProperty(ISOLATE->heap,
+                                        addr(),
+                                        key->addr(),
+                                        1);
+  *slot = value->addr();
+}
+
+
+Value* Map::Get(Value* key) {
+  return Value::New(*HObject::LookupProperty(ISOLATE->heap,
+                                             addr(),
+                                             key->addr(),
+                                             0));
+}
+
+
+bool Map::Has(Value* key) {
+  return HHashTable::Lookup(ISOLATE->heap, addr(), key->addr(), false) !=
+         Heap::kTagNil;
+}
+
+
+void Map::Delete(Value* key) {
+  HHashTable::Delete(ISOLATE->heap, addr(), key->addr());
+}
+
+
+Array* Map::Keys() {
+  return Cast<Array>(HHashTable::Keys(ISOLATE->heap, addr()));
+}
+
+
+int64_t Map::Size() {
+  return HHashTable::Size(addr());
+}
+
+
+Set* Set::New() {
+  return Cast<Set>(HHashTable::New(ISOLATE->heap, Heap::kTagHashSet));
+}
+
+
+void Set::Add(Value* key) {
+  HHashTable::Lookup(ISOLATE->heap, addr(), key->addr(), true);
+}
+
+
+bool Set::Has(Value* key) {
+  return HHashTable::Lookup(ISOLATE->heap, addr(), key->addr(), false) !=
+         Heap::kTagNil;
+}
+
+
+void Set::Delete(Value* key) {
+  HHashTable::Delete(ISOLATE->heap, addr(), key->addr());
+}
+
+
+Array* Set::Keys() {
+  return Cast<Array>(HHashTable::Keys(ISOLATE->heap, addr()));
+}
+
+
+int64_t Set::Size() {
+  return HHashTable::Size(addr());
+}
+
+
+Key::Key(const char* value) : hint_(0) {
+  Init(value, strlen(value));
+}
+
+
+Key::Key(const char* value, uint32_t len) : hint_(0) {
+  Init(value, len);
+}
+
+
+void Key::Init(const char* value, uint32_t len) {
+  // Intern string, compiled code uses the same pointers for property names
+  char* str = ISOLATE->heap->CreateString(value, len);
+
+  // Compute and cache hash
+  HString::Hash(ISOLATE->heap, str);
+
+  str_.Wrap(Value::Cast<String>(str));
+}
+
+
+// Objects may store property name as another string with the same contents
+// (e.g. set by `Object::Set(const char*, ...)` or with computed name)
+static inline bool IsSameKey(Heap* heap, char* slot_key, char* key) {
+  if (slot_key == key) return true;
+  if (slot_key == HNil::New() ||
+      HValue::IsUnboxed(slot_key) ||
+      HValue::GetTag(slot_key) != Heap::kTagString) {
+    return false;
+  }
+
+  return HString::Hash(heap, slot_key) == HString::Hash(heap, key) &&
+         RuntimeStringCompare(heap, slot_key, key) == 0;
+}
+
+
+char** Key::Lookup(char* obj, int insert) {
+  char* key = str_->addr();
+
+  // Arrays are using numeric keys
+  if (HValue::GetTag(obj) != Heap::kTagObject) {
+    return HObject::LookupProperty(ISOLATE->heap, obj, key, insert);
+  }
+
+  // Hinted slot is written by caller, don't let it hit a map shared by clone
+  if (insert && HObject::IsShared(obj)) HObject::Unshare(ISOLATE->heap, obj);
+
+  char* map = HObject::Map(obj);
+  uint32_t mask = HObject::Mask(obj);
+
+  // Fast case: key is still in the slot where it was seen last time
+  if (hint_ <= mask &&
+      IsSameKey(ISOLATE->heap,
+                *reinterpret_cast<char**>(map + HMap::kSpaceOffset + hint_),
+                key)) {
+    return reinterpret_cast<char**>(
+        map + HMap::kSpaceOffset + hint_ + mask + HValue::kPointerSize);
+  }
+
+  intptr_t offset = RuntimeLookupProperty(ISOLATE->heap, obj, key, insert);
+  if (offset == Heap::kTagNil) {
+    return HObject::LookupProperty(ISOLATE->heap, obj, key, insert);
+  }
+
+  // Map may be changed after insertion
+  map = HObject::Map(obj);
+  mask = HObject::Mask(obj);
+  hint_ = offset - HMap::kSpaceOffset - mask - HValue::kPointerSize;
+
+  return reinterpret_cast<char**>(map + offset);
+}
+
+
 CWrapper::CWrapper(const int* magic) : isolate(ISOLATE), magic_(magic) {
   CData* data = CData::New(sizeof(this));
 
@@ -37,6 +37,7 @@ namespace internal {
 class ScopeSlot;
 class AstNode;
 class AstValue;
+class FunctionLiteral;
 class Label;
 
 // Just to simplify future use cases
@@ -347,6 +348,80 @@ class BinOp : public AstNode {
 #undef TYPE_MAPPING_BINOP
 
 
+#define TYPE_MAPPING_MATH(V)\
+    V(kFloor, "floor")\
+    V(kCeil, "ceil")\
+    V(kRound, "round")\
+    V(kSqrt, "sqrt")\
+    V(kAbs, "abs")\
+    V(kMin, "min")\
+    V(kMax, "max")\
+    V(kPow, "pow")\
+    V(kExp, "exp")\
+    V(kLog, "log")\
+    V(kSin, "sin")\
+    V(kCos, "cos")\
+    V(kTan, "tan")
+
+// Math intrinsics, called as `__$floor(x)` or `global.math.floor(x)`
+class MathOp {
+ public:
+  enum MathOpType {
+#define MAP_DF(x, name) x,
+    TYPE_MAPPING_MATH(MAP_DF)
+#undef MAP_DF
+    kNone
+  };
+
+  // Converts name of called variable to intrinsic type if possible
+  static inline MathOpType ConvertName(AstNode* name, const char* prefix) {
+    uint32_t plen = strlen(prefix);
+    if (name->length() < plen || strncmp(name->value(), prefix, plen) != 0) {
+      return kNone;
+    }
+
+#define MAP_DF(x, name_str)\
+    if (name->length() - plen == sizeof(name_str) - 1 &&\
+        strncmp(name->value() + plen, name_str, sizeof(name_str) - 1) == 0) {\
+      return x;\
+    }
+    TYPE_MAPPING_MATH(MAP_DF)
+#undef MAP_DF
+
+    return kNone;
+  }
+
+  // Converts `__$name(...)` call to intrinsic type if possible
+  // (see definitions below)
+  static inline MathOpType ConvertCall(FunctionLiteral* fn);
+
+  // Converts `global.math.name(...)` call to intrinsic type if possible,
+  // generated code should check at runtime that the called function is
+  // the one from library (see BindingCode)
+  static inline MathOpType ConvertModuleCall(FunctionLiteral* fn);
+
+  // Code address of `math` module's binding for `type` (see api.cc)
+  static char* BindingCode(MathOpType type);
+
+  static inline int argc(MathOpType type) {
+    return (type == kMin || type == kMax || type == kPow) ? 2 : 1;
+  }
+
+  // Functions that are always computed by libm
+  static inline bool is_transcendental(MathOpType type) {
+    return type == kPow || type == kExp || type == kLog ||
+           type == kSin || type == kCos || type == kTan;
+  }
+
+  // Functions that always return one of their arguments
+  static inline bool is_selection(MathOpType type) {
+    return type == kMin || type == kMax;
+  }
+};
+
+#undef TYPE_MAPPING_MATH
+
+
 #define TYPE_MAPPING_UNOP(V)\
     V(kPreInc)\
     V(kPreDec)\
@@ -534,6 +609,14 @@ class FunctionLiteral : public AstNode {
            p->Print("]");
   }
 
+  inline bool has_vararg() {
+    AstList::Item* head;
+    for (head = args_.head(); head != NULL; head = head->next()) {
+      if (head->value()->is(kVarArg)) return true;
+    }
+    return false;
+  }
+
   inline AstNode* variable() { return variable_; }
   inline void variable(AstNode* variable) { variable_ = variable; }
   inline AstList* args() { return &args_; }
@@ -607,6 +690,52 @@ class AstValue : public AstNode {
   AstNode* name_;
 };
 
+
+inline MathOp::MathOpType MathOp::ConvertCall(FunctionLiteral* fn) {
+  if (fn->has_vararg() || !fn->variable()->is(AstNode::kValue)) return kNone;
+
+  return ConvertName(AstValue::Cast(fn->variable())->name(), "__$");
+}
+
+
+// `global.math` is installed by the library (see api.cc), but user may
+// replace it or its functions at any time.
+inline MathOp::MathOpType MathOp::ConvertModuleCall(FunctionLiteral* fn) {
+  if (fn->has_vararg()) return kNone;
+
+  // global.math:name(...) passes module as `self`
+  if (fn->args()->length() > 0 &&
+      fn->args()->head()->value()->is(AstNode::kSelf)) {
+    return kNone;
+  }
+
+  // global.math.name
+  AstNode* callee = fn->variable();
+  if (!callee->is(AstNode::kMember) ||
+      !callee->rhs()->is(AstNode::kProperty) ||
+      !callee->lhs()->is(AstNode::kMember)) {
+    return kNone;
+  }
+
+  AstNode* module = callee->lhs();
+  AstNode* name = module->rhs();
+  if (!module->lhs()->is(AstNode::kValue) ||
+      !name->is(AstNode::kProperty) ||
+      name->length() != 4 ||
+      strncmp(name->value(), "math", 4) != 0) {
+    return kNone;
+  }
+
+  AstValue* global = AstValue::Cast(module->lhs());
+  if (!global->is_slot() ||
+      !global->slot()->is_context() ||
+      global->slot()->depth() != -1) {
+    return kNone;
+  }
+
+  return ConvertName(callee->rhs(), "");
+}
+
 }  // namespace internal
 }  // namespace candor
 
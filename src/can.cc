@@ -126,12 +126,238 @@ candor::Value* APIToString(uint32_t argc, candor::Value* argv[]) {
 }
 
 
+// Missing arguments are zeroes
+double ArgToDouble(uint32_t argc, candor::Value* argv[], uint32_t index) {
+  if (index >= argc) return 0;
+  return argv[index]->ToNumber()->Value();
+}
+
+
+// Typed arrays module, element access on them is inlined by compiler
+#define TYPED_ARRAYS(V)\
+    V(int8, kInt8)\
+    V(uint8, kUint8)\
+    V(int16, kInt16)\
+    V(uint16, kUint16)\
+    V(int32, kInt32)\
+    V(uint32, kUint32)\
+    V(int64, kInt64)\
+    V(uint64, kUint64)\
+    V(float32, kFloat32)\
+    V(float64, kFloat64)
+
+#define TYPED_ARRAY_BINDING(name, type)\
+    candor::Value* APITyped_##name(uint32_t argc, candor::Value* argv[]) {\
+      int64_t length = 0;\
+      if (argc >= 1) length = argv[0]->ToNumber()->IntegralValue();\
+      if (length < 0) length = 0;\
+      return candor::CData::New(candor::CData::type, length);\
+    }
+
+TYPED_ARRAYS(TYPED_ARRAY_BINDING)
+
+#undef TYPED_ARRAY_BINDING
+
+
+// Bulk operations over typed arrays, they return nil if any of
+// arguments isn't a typed array
+#define TYPED_OPERATIONS(V)\
+    V(sum)\
+    V(min)\
+    V(max)\
+    V(dot)\
+    V(fill)\
+    V(copy)\
+    V(scaleAdd)\
+    V(add)\
+    V(sub)\
+    V(mul)\
+    V(div)\
+    V(indexOf)
+
+candor::CData* TypedArg(uint32_t argc, candor::Value* argv[], uint32_t index) {
+  if (index >= argc || !argv[index]->Is<candor::CData>()) return NULL;
+
+  candor::CData* data = argv[index]->As<candor::CData>();
+  if (data->GetElementType() == candor::CData::kRaw) return NULL;
+
+  return data;
+}
+
+
+candor::Value* APITyped_sum(uint32_t argc, candor::Value* argv[]) {
+  candor::CData* a = TypedArg(argc, argv, 0);
+  if (a == NULL) return candor::Nil::New();
+
+  return candor::Number::NewDouble(a->Sum());
+}
+
+
+#define TYPED_REDUCE_BINDING(name, method)\
+    candor::Value* APITyped_##name(uint32_t argc, candor::Value* argv[]) {\
+      candor::CData* a = TypedArg(argc, argv, 0);\
+      double result;\
+      if (a == NULL || !a->method(&result)) return candor::Nil::New();\
+      return candor::Number::NewDouble(result);\
+    }
+
+TYPED_REDUCE_BINDING(min, Min)
+TYPED_REDUCE_BINDING(max, Max)
+
+#undef TYPED_REDUCE_BINDING
+
+
+candor::Value* APITyped_dot(uint32_t argc, candor::Value* argv[]) {
+  candor::CData* a = TypedArg(argc, argv, 0);
+  candor::CData* b = TypedArg(argc, argv, 1);
+  if (a == NULL || b == NULL) return candor::Nil::New();
+
+  return candor::Number::NewDouble(a->Dot(b));
+}
+
+
+candor::Value* APITyped_fill(uint32_t argc, candor::Value* argv[]) {
+  candor::CData* dst = TypedArg(argc, argv, 0);
+  if (dst == NULL) return candor::Nil::New();
+
+  dst->Fill(ArgToDouble(argc, argv, 1));
+  return argv[0];
+}
+
+
+candor::Value* APITyped_copy(uint32_t argc, candor::Value* argv[]) {
+  candor::CData* dst = TypedArg(argc, argv, 0);
+  candor::CData* src = TypedArg(argc, argv, 1);
+  if (dst == NULL || src == NULL) return candor::Nil::New();
+
+  dst->Copy(src);
+  return argv[0];
+}
+
+
+candor::Value* APITyped_scaleAdd(uint32_t argc, candor::Value* argv[]) {
+  candor::CData* dst = TypedArg(argc, argv, 0);
+  candor::CData* src = TypedArg(argc, argv, 1);
+  if (dst == NULL || src == NULL) return candor::Nil::New();
+
+  dst->ScaleAdd(src, ArgToDouble(argc, argv, 2));
+  return argv[0];
+}
+
+
+#define TYPED_ARITHMETIC_BINDING(name, method)\
+    candor::Value* APITyped_##name(uint32_t argc, candor::Value* argv[]) {\
+      candor::CData* dst = TypedArg(argc, argv, 0);\
+      candor::CData* lhs = TypedArg(argc, argv, 1);\
+      candor::CData* rhs = TypedArg(argc, argv, 2);\
+      if (dst == NULL || lhs == NULL || rhs == NULL) {\
+        return candor::Nil::New();\
+      }\
+      dst->method(lhs, rhs);\
+      return argv[0];\
+    }
+
+TYPED_ARITHMETIC_BINDING(add, Add)
+TYPED_ARITHMETIC_BINDING(sub, Sub)
+TYPED_ARITHMETIC_BINDING(mul, Mul)
+TYPED_ARITHMETIC_BINDING(div, Div)
+
+#undef TYPED_ARITHMETIC_BINDING
+
+
+candor::Value* APITyped_indexOf(uint32_t argc, candor::Value* argv[]) {
+  candor::CData* a = TypedArg(argc, argv, 0);
+  if (a == NULL) return candor::Nil::New();
+
+  return candor::Number::NewIntegral(a->IndexOf(ArgToDouble(argc, argv, 1)));
+}
+
+
+candor::Object* CreateTyped() {
+  candor::Object* obj = candor::Object::New();
+
+#define TYPED_ARRAY_SET(name, type)\
+    obj->Set(#name, candor::Function::New(APITyped_##name));
+  TYPED_ARRAYS(TYPED_ARRAY_SET)
+#undef TYPED_ARRAY_SET
+
+#define TYPED_OPERATION_SET(name)\
+    obj->Set(#name, candor::Function::New(APITyped_##name));
+  TYPED_OPERATIONS(TYPED_OPERATION_SET)
+#undef TYPED_OPERATION_SET
+
+  return obj;
+}
+
+#undef TYPED_ARRAYS
+#undef TYPED_OPERATIONS
+
+
+// Maps and sets, `c[key]`, `delete c[key]`, `sizeof c` and `keysof c` are
+// compiled, `has` tells absent keys from ones with nil values
+candor::Value* APIMap(uint32_t argc, candor::Value* argv[]) {
+  return candor::Map::New();
+}
+
+
+candor::Value* APISet(uint32_t argc, candor::Value* argv[]) {
+  candor::Set* set = candor::Set::New();
+
+  // Set may be filled with elements of array
+  if (argc >= 1 && argv[0]->Is<candor::Array>()) {
+    candor::Array* members = argv[0]->As<candor::Array>();
+    int64_t length = members->Length();
+    for (int64_t i = 0; i < length; i++) {
+      set->Add(members->Get(i));
+    }
+  }
+
+  return set;
+}
+
+
+candor::Value* APIHas(uint32_t argc, candor::Value* argv[]) {
+  if (argc < 2) return candor::Boolean::False();
+
+  if (argv[0]->Is<candor::Map>()) {
+    return candor::Boolean::New(argv[0]->As<candor::Map>()->Has(argv[1]));
+  } else if (argv[0]->Is<candor::Set>()) {
+    return candor::Boolean::New(argv[0]->As<candor::Set>()->Has(argv[1]));
+  }
+
+  return candor::Boolean::False();
+}
+
+
+// sort(array[, comparator]) sorts array in place and returns it
+candor::Value* APISort(uint32_t argc, candor::Value* argv[]) {
+  if (argc < 1 || !argv[0]->Is<candor::Array>()) return candor::Nil::New();
+
+  candor::Array* arr = argv[0]->As<candor::Array>();
+  if (argc >= 2 && argv[1]->Is<candor::Function>()) {
+    // Comparator may trigger GC, keep array's handle
+    candor::Handle<candor::Array> handle(arr);
+    arr->Sort(argv[1]->As<candor::Function>());
+    return *handle;
+  }
+
+  arr->Sort();
+  return arr;
+}
+
+
 candor::Object* CreateGlobal() {
   candor::Object* obj = candor::Object::New();
 
   obj->Set("assert", candor::Function::New(APIAssert));
   obj->Set("print", candor::Function::New(APIPrint));
   obj->Set("getValue", candor::Function::New(APIToString));
+  obj->Set("math", candor::Object::NewMath());
+  obj->Set("typed", CreateTyped());
+  obj->Set("map", candor::Function::New(APIMap));
+  obj->Set("set", candor::Function::New(APISet));
+  obj->Set("has", candor::Function::New(APIHas));
+  obj->Set("sort", candor::Function::New(APISort));
 
   return obj;
 }
@@ -223,7 +449,25 @@ void StartRepl() {
 
 
 int main(int argc, char** argv) {
-  if (argc < 2) {
+  bool runtime_stats = false;
+  bool ic_stats = false;
+  int arg = 1;
+  for (; arg < argc; arg++) {
+    if (strcmp(argv[arg], "--runtime-stats") == 0) {
+      candor::Isolate::EnableRuntimeStats(false);
+      runtime_stats = true;
+    } else if (strcmp(argv[arg], "--runtime-stats-cycles") == 0) {
+      candor::Isolate::EnableRuntimeStats(true);
+      runtime_stats = true;
+    } else if (strcmp(argv[arg], "--ic-stats") == 0) {
+      candor::Isolate::EnableICStats();
+      ic_stats = true;
+    } else {
+      break;
+    }
+  }
+
+  if (arg >= argc) {
     // Start repl
     StartRepl();
   } else {
@@ -231,9 +475,9 @@ int main(int argc, char** argv) {
 
     // Load script and run
     off_t size = 0;
-    const char* script = ReadContents(argv[1], &size);
+    const char* script = ReadContents(argv[arg], &size);
 
-    candor::Function* code = candor::Function::New(argv[1], script, size);
+    candor::Function* code = candor::Function::New(argv[arg], script, size);
     delete script;
 
     if (isolate.HasError()) {
@@ -245,6 +489,8 @@ int main(int argc, char** argv) {
 
     int ret = code->Call(0, NULL)->ToNumber()->IntegralValue();
     fflush(stdout);
+    if (runtime_stats) isolate.PrintRuntimeStats();
+    if (ic_stats) isolate.PrintICStats();
     return ret;
   }
 }
@@ -42,12 +42,16 @@
 #include "source-map.h"  // SourceMap
 #include "stubs.h"  // EntryStub
 #include "pic.h"  // PIC
+#include "perf-counters.h"  // PerfScope
 #include "utils.h"  // GetPageSize
 
 namespace candor {
 namespace internal {
 
-CodeSpace::CodeSpace(Heap* heap) : heap_(heap) {
+CodeSpace::Tier CodeSpace::tier_ = CodeSpace::kTierAuto;
+
+
+CodeSpace::CodeSpace(Heap* heap) : heap_(heap), code_size_(0) {
   stubs_ = new Stubs(this);
   entry_ = stubs()->GetEntryStub();
   heap->code_space(this);
@@ -136,6 +140,7 @@ void CodeSpace::Put(CodeChunk* chunk, Masm* masm) {
   }
 
   // Copy code into executable memory
+  code_size_ += length;
   chunk->page_ = p;
   chunk->addr_ = p->Allocate(length);
   memcpy(chunk->addr_, code, length);
@@ -153,6 +158,7 @@ char* CodeSpace::Compile(const char* filename,
                          uint32_t length,
                          char** root,
                          Error** error) {
+  PerfScope perf(heap()->perf_counters(), PerfCounters::kCompile);
   Zone zone;
 
   CodeChunk* chunk = CreateChunk(filename, source, length);
@@ -176,7 +182,11 @@ char* CodeSpace::Compile(const char* filename,
     FunctionLiteral* current = it.Value();
 
     int len = current->own_length();
-    if (len < HIRGen::kMaxOptimizableSize) {
+    bool optimize = tier() == kTierAuto ?
+        len < HIRGen::kMaxOptimizableSize
+        :
+        tier() == kTierOptimizing;
+    if (optimize) {
       // Generate CFG with SSA
       HIRGen hir(heap(), &r, chunk->filename());
 
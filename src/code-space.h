@@ -49,6 +49,13 @@ class CodeSpace {
  public:
   typedef Value* (*Code)(char*, uint32_t, Value* []);
 
+  // By default functions are optimized unless they're too big
+  enum Tier {
+    kTierAuto,
+    kTierFullgen,
+    kTierOptimizing
+  };
+
   explicit CodeSpace(Heap* heap);
   ~CodeSpace();
 
@@ -73,6 +80,14 @@ class CodeSpace {
   inline Heap* heap() { return heap_; }
   inline Stubs* stubs() { return stubs_; }
 
+  inline List<PIC*, EmptyClass>* pics() { return &pics_; }
+
+  // Total size of machine code put into code space (including stubs)
+  inline uint32_t code_size() { return code_size_; }
+
+  static inline Tier tier() { return tier_; }
+  static inline void tier(Tier tier) { tier_ = tier; }
+
  private:
   Heap* heap_;
   Stubs* stubs_;
@@ -80,6 +95,9 @@ class CodeSpace {
   CodePageList pages_;
   List<PIC*, EmptyClass> pics_;
   CodeChunkList chunks_;
+  uint32_t code_size_;
+
+  static Tier tier_;
 };
 
 class CodePage {
@@ -38,24 +38,57 @@ CPU::CPUFeatures CPU::cpu_features_;
 bool CPU::probed_ = false;
 
 
-typedef char* (*CPUProbeCallback)();
+typedef void (*CPUProbeCallback)(intptr_t leaf, uint32_t* regs);
+typedef intptr_t (*CPUProbeXCRCallback)();
 
-void CPU::Probe() {
-  Zone z;
+// Generates code with given Masm method and returns a pointer to it
+static char* GenerateProbe(CodePage* page, void (Masm::*generate)()) {
   Assembler a;
 
   // XXX: I don't like that cast, though it seems to be correct solution
-  reinterpret_cast<Masm*>(&a)->ProbeCPU();
+  (reinterpret_cast<Masm*>(&a)->*generate)();
 
-  CodePage page(a.length());
-  char* code = page.Allocate(a.length());
+  char* code = page->Allocate(a.length());
   memcpy(code, a.buffer(), a.length());
   a.Relocate(NULL, code);
 
-  int32_t features = reinterpret_cast<intptr_t>(
-      reinterpret_cast<CPUProbeCallback>(code)());
+  return code;
+}
+
+
+void CPU::Probe() {
+  Zone z;
+  CodePage page(1024);
+
+  CPUProbeCallback cpuid = reinterpret_cast<CPUProbeCallback>(
+      GenerateProbe(&page, &Masm::ProbeCPU));
+
+  // eax, ebx, ecx, edx
+  uint32_t regs[4];
+
+  cpuid(0, regs);
+  uint32_t max_leaf = regs[0];
+
+  cpuid(1, regs);
+  cpu_features_.SSE2 = (regs[3] & (1 << 26)) != 0;
+  cpu_features_.SSE4_1 = (regs[2] & (1 << 19)) != 0;
+
+  // ymm registers are usable only if OS saves them (XCR0 bits 1 and 2)
+  bool osxsave = (regs[2] & (1 << 27)) != 0;
+  bool avx = (regs[2] & (1 << 28)) != 0;
+  bool ymm_state = false;
+  if (osxsave && avx) {
+    CPUProbeXCRCallback xgetbv = reinterpret_cast<CPUProbeXCRCallback>(
+        GenerateProbe(&page, &Masm::ProbeXCR));
+    ymm_state = (xgetbv() & 0x06) == 0x06;
+  }
+
+  cpu_features_.AVX2 = false;
+  if (ymm_state && max_leaf >= 7) {
+    cpuid(7, regs);
+    cpu_features_.AVX2 = (regs[1] & (1 << 5)) != 0;
+  }
 
-  cpu_features_.SSE4_1 = (features & (1 << 19)) != 0;
   probed_ = true;
 }
 }  // internal
@@ -29,17 +29,30 @@ namespace internal {
 class CPU {
  public:
   struct CPUFeatures {
+    bool SSE2;
     bool SSE4_1;
+    bool AVX2;
   };
 
   static CPUFeatures cpu_features_;
   static bool probed_;
 
   static void Probe();
+  static inline bool HasSSE2() {
+    if (!probed_) Probe();
+    return cpu_features_.SSE2;
+  }
+
   static inline bool HasSSE4_1() {
     if (!probed_) Probe();
     return cpu_features_.SSE4_1;
   }
+
+  // AVX2 instructions and OS support for saving ymm registers
+  static inline bool HasAVX2() {
+    if (!probed_) Probe();
+    return cpu_features_.AVX2;
+  }
 };
 
 }  // namespace internal
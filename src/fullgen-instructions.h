@@ -58,6 +58,8 @@ typedef ZoneList<FInstruction*> FInstructionList;
     V(DeleteProperty) \
     V(AllocateObject) \
     V(AllocateArray) \
+    V(CloneLiteral) \
+    V(Math) \
     V(Clone) \
     V(Typeof) \
     V(Sizeof) \
@@ -217,6 +219,18 @@ class FBinOp : public FInstruction {
   BinOp::BinOpType sub_type_;
 };
 
+class FMath : public FInstruction {
+ public:
+  explicit FMath(MathOp::MathOpType sub_type) : FInstruction(kMath),
+                                                sub_type_(sub_type) {
+  }
+
+  FULLGEN_DEFAULT_METHODS(Math)
+
+ protected:
+  MathOp::MathOpType sub_type_;
+};
+
 class FNot : public FInstruction {
  public:
   FNot() : FInstruction(kNot) {
@@ -285,7 +299,7 @@ class FAllocateObject : public FInstruction {
  public:
   explicit FAllocateObject(int size)
       : FInstruction(kAllocateObject),
-        size_(RoundUp(PowerOfTwo(size + 1), 64)) {
+        size_(HObject::LiteralSize(size)) {
   }
 
   FULLGEN_DEFAULT_METHODS(AllocateObject)
@@ -298,7 +312,7 @@ class FAllocateArray : public FInstruction {
  public:
   explicit FAllocateArray(int size)
       : FInstruction(kAllocateArray),
-        size_(RoundUp(PowerOfTwo(size + 1), 64)) {
+        size_(HArray::LiteralSize(size)) {
   }
 
   FULLGEN_DEFAULT_METHODS(AllocateArray)
@@ -323,6 +337,14 @@ class FClone : public FInstruction {
   FULLGEN_DEFAULT_METHODS(Clone)
 };
 
+class FCloneLiteral : public FInstruction {
+ public:
+  FCloneLiteral() : FInstruction(kCloneLiteral) {
+  }
+
+  FULLGEN_DEFAULT_METHODS(CloneLiteral)
+};
+
 class FSizeof : public FInstruction {
  public:
   FSizeof() : FInstruction(kSizeof) {
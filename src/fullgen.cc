@@ -366,12 +366,21 @@ FInstruction* Fullgen::VisitDelete(AstNode* node) {
 FInstruction* Fullgen::VisitObjectLiteral(AstNode* node) {
   ObjectLiteral* obj = ObjectLiteral::Cast(node);
   FScopedSlot slot(this);
-  FInstruction* res = Add(new FAllocateObject(obj->keys()->length()));
-  res->SetResult(&slot);
+  ScopeSlot* boilerplate = root_->PutBoilerplate(node);
+  if (boilerplate == NULL) {
+    Add(new FAllocateObject(obj->keys()->length()))->SetResult(&slot);
+  } else {
+    FScopedSlot literal(this);
+    Add(new FLiteral(node->type(), boilerplate))->SetResult(&literal);
+    Add(new FCloneLiteral())->AddArg(&literal)->SetResult(&slot);
+  }
 
   AstList::Item* khead = obj->keys()->head();
   AstList::Item* vhead = obj->values()->head();
   for (; khead != NULL; khead = khead->next(), vhead = vhead->next()) {
+    // Constant values are already in the boilerplate
+    if (boilerplate != NULL && Root::IsConstant(vhead->value())) continue;
+
     FScopedSlot value(this);
     FScopedSlot key(this);
     Visit(vhead->value())->SetResult(&value);
@@ -389,11 +398,20 @@ FInstruction* Fullgen::VisitObjectLiteral(AstNode* node) {
 
 FInstruction* Fullgen::VisitArrayLiteral(AstNode* node) {
   FScopedSlot slot(this);
-  FInstruction* res = Add(new FAllocateArray(node->children()->length()));
-  res->SetResult(&slot);
+  ScopeSlot* boilerplate = root_->PutBoilerplate(node);
+  if (boilerplate == NULL) {
+    Add(new FAllocateArray(node->children()->length()))->SetResult(&slot);
+  } else {
+    FScopedSlot literal(this);
+    Add(new FLiteral(node->type(), boilerplate))->SetResult(&literal);
+    Add(new FCloneLiteral())->AddArg(&literal)->SetResult(&slot);
+  }
 
   AstList::Item* head = node->children()->head();
   for (uint64_t i = 0; head != NULL; head = head->next(), i++) {
+    // Constant values are already in the boilerplate
+    if (boilerplate != NULL && Root::IsConstant(head->value())) continue;
+
     FScopedSlot key(this);
     FScopedSlot value(this);
     GetNumber(i)->SetResult(&key);
@@ -484,6 +502,32 @@ FInstruction* Fullgen::VisitContinue(AstNode* node) {
 }
 
 
+FInstruction* Fullgen::VisitMath(MathOp::MathOpType type,
+                                 FunctionLiteral* fn) {
+  FScopedSlot lhs(this);
+  FScopedSlot rhs(this);
+  FOperand* slots[] = { &lhs, &rhs };
+  FInstruction* res = new FMath(type);
+
+  // Missing arguments are nil
+  AstList::Item* item = fn->args()->head();
+  for (int i = 0; i < MathOp::argc(type); i++) {
+    if (item != NULL) {
+      Visit(item->value())->SetResult(slots[i]);
+      item = item->next();
+    } else {
+      Add(new FNil())->SetResult(slots[i]);
+    }
+    res->AddArg(slots[i]);
+  }
+
+  // Extra arguments are evaluated only for side effects
+  for (; item != NULL; item = item->next()) Visit(item->value());
+
+  return Add(res);
+}
+
+
 FInstruction* Fullgen::VisitCall(AstNode* stmt) {
   FunctionLiteral* fn = FunctionLiteral::Cast(stmt);
 
@@ -499,6 +543,10 @@ FInstruction* Fullgen::VisitCall(AstNode* stmt) {
     }
   }
 
+  // Math intrinsics
+  MathOp::MathOpType math = MathOp::ConvertCall(fn);
+  if (math != MathOp::kNone) return VisitMath(math, fn);
+
   // Generate all arg's values and populate list of stores
   FInstruction* vararg = NULL;
   FOperandList arg_slots;
@@ -115,6 +115,7 @@ class Fullgen : public Visitor<FInstruction> {
   void LoadArguments(FunctionLiteral* fn);
   FInstruction* VisitFunction(AstNode* stmt);
   FInstruction* VisitCall(AstNode* stmt);
+  FInstruction* VisitMath(MathOp::MathOpType type, FunctionLiteral* fn);
   FInstruction* VisitAssign(AstNode* stmt);
 
   FInstruction* VisitValue(AstNode* node);
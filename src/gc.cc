@@ -46,6 +46,10 @@ void GC::CollectGarbage(char* stack_top) {
   assert(grey_items()->length() == 0);
   assert(black_items()->length() == 0);
 
+  int64_t start = GetTimeMicros();
+  int64_t used_before = heap()->new_space()->Used() +
+                        heap()->old_space()->Used();
+
   // __$gc() isn't setting needs_gc() attribute
   if (heap()->needs_gc() == Heap::kGCNone) {
     heap()->needs_gc(Heap::kGCNewSpace);
@@ -89,6 +93,10 @@ void GC::CollectGarbage(char* stack_top) {
   space->Swap(tmp_space());
   delete tmp_space();
 
+  int64_t used_after = heap()->new_space()->Used() +
+                       heap()->old_space()->Used();
+  RecordPause(gc_type(), GetTimeMicros() - start, used_before - used_after);
+
   if (gc_type() != kNewSpace || heap()->needs_gc() == Heap::kGCNewSpace) {
     // Reset GC flag
     heap()->needs_gc(Heap::kGCNone);
@@ -99,6 +107,15 @@ void GC::CollectGarbage(char* stack_top) {
 }
 
 
+void GC::RecordPause(GCType type, int64_t pause, int64_t reclaimed) {
+  pauses_[pause_total_ % kPauseHistory].Init(type, pause, reclaimed);
+  pause_total_++;
+  count_[type]++;
+  total_pause_[type] += pause;
+  if (pause > max_pause_[type]) max_pause_[type] = pause;
+}
+
+
 void GC::ColourPersistentHandles() {
   HValueRefMap::Item* item = heap()->references()->head();
   for (; item != NULL; item = item->next_scalar()) {
@@ -267,6 +284,9 @@ void GC::VisitValue(HValue* value) {
       return VisitArray(value->As<HArray>());
     case Heap::kTagMap:
       return VisitMap(value->As<HMap>());
+    case Heap::kTagHashMap:
+    case Heap::kTagHashSet:
+      return VisitHashTable(value);
 
       // non-cons strings and numbers ain't referencing anyone
     case Heap::kTagString:
@@ -346,5 +366,17 @@ void GC::VisitString(HValue* value) {
             HString::RightConsSlot(value->addr()));
 }
 
+
+void GC::VisitHashTable(HValue* table) {
+  char** entries = HHashTable::EntriesSlot(table->addr());
+  char** index = HHashTable::IndexSlot(table->addr());
+  push_grey(HValue::Cast(*entries), entries);
+  push_grey(HValue::Cast(*index), index);
+
+  // Keys hashed by address may be moved
+  intptr_t* flags = HHashTable::FlagsSlot(table->addr());
+  if (*flags & HHashTable::kPointerKeys) *flags |= HHashTable::kStaleIndex;
+}
+
 }  // namespace internal
 }  // namespace candor
@@ -63,7 +63,34 @@ class GC {
 
   typedef ZoneList<GCValue*> GCList;
 
-  explicit GC(Heap* heap) : heap_(heap), gc_type_(kNone) {
+  // Last kPauseHistory collections are kept in a ring buffer for pause
+  // distribution analysis
+  class Pause {
+   public:
+    inline void Init(GCType type, int64_t pause, int64_t bytes) {
+      type_ = type;
+      pause_ = pause;
+      reclaimed_ = bytes;
+    }
+
+    inline GCType type() { return type_; }
+    inline int64_t pause() { return pause_; }
+    inline int64_t reclaimed() { return reclaimed_; }
+
+   protected:
+    GCType type_;
+    int64_t pause_;
+    int64_t reclaimed_;
+  };
+
+  static const uint32_t kPauseHistory = 1024;
+
+  explicit GC(Heap* heap) : heap_(heap), gc_type_(kNone), pause_total_(0) {
+    for (int i = 0; i <= kNewSpace; i++) {
+      count_[i] = 0;
+      total_pause_[i] = 0;
+      max_pause_[i] = 0;
+    }
   }
 
   void CollectGarbage(char* stack_top);
@@ -83,9 +110,27 @@ class GC {
   void VisitArray(HArray* arr);
   void VisitMap(HMap* map);
   void VisitString(HValue* value);
+  void VisitHashTable(HValue* table);
 
   bool IsInCurrentSpace(HValue* value);
 
+  // Statistics (pauses are in microseconds, reclaimed space in bytes)
+  void RecordPause(GCType type, int64_t pause, int64_t reclaimed);
+
+  inline uint32_t count(GCType type) { return count_[type]; }
+  inline int64_t total_pause(GCType type) { return total_pause_[type]; }
+  inline int64_t max_pause(GCType type) { return max_pause_[type]; }
+
+  // Number of collections recorded so far (only the last kPauseHistory
+  // of them are kept), and i-th of the kept ones (oldest first)
+  inline uint32_t pause_total() { return pause_total_; }
+  inline uint32_t pause_count() {
+    return pause_total_ < kPauseHistory ? pause_total_ : kPauseHistory;
+  }
+  inline Pause* pause_at(uint32_t i) {
+    return &pauses_[(pause_total_ - pause_count() + i) % kPauseHistory];
+  }
+
   inline void push_grey(HValue* value, char** reference) {
     grey_items()->Push(new GCValue(value, reference));
   }
@@ -112,6 +157,12 @@ class GC {
   Space* tmp_space_;
 
   GCType gc_type_;
+
+  uint32_t count_[kNewSpace + 1];
+  int64_t total_pause_[kNewSpace + 1];
+  int64_t max_pause_[kNewSpace + 1];
+  Pause pauses_[kPauseHistory];
+  uint32_t pause_total_;
 };
 
 }  // namespace internal
@@ -155,17 +155,73 @@ inline bool HNumber::IsIntegral(char* addr) {
 }
 
 
+inline int64_t HNumber::Truncate(double value) {
+  if (value >= -9223372036854775808.0 && value < 9223372036854775808.0) {
+    return static_cast<int64_t>(value);
+  }
+  return static_cast<int64_t>(0x8000000000000000ULL);
+}
+
+
 inline void HArray::SetLength(char* obj, int64_t length) {
   *reinterpret_cast<intptr_t*>(obj + kLengthOffset) = length;
 }
 
 
+inline void HArray::InvalidateLength(char* obj) {
+  SetRepresentation<Representation>(obj, kDirtyLength);
+}
+
+
+inline void HArray::ValidateLength(char* obj) {
+  SetRepresentation<Representation>(obj, kExactLength);
+}
+
+
 inline bool HArray::IsDense(char* obj) {
   int size = HValue::As<HMap>(Map(obj))->size();
   return size <= kDenseLengthMax;
 }
 
 
+inline HObjectIterator::HObjectIterator(char* obj)
+    : map_(HValue::As<HMap>(HObject::Map(obj))),
+      index_(0),
+      size_(map_->size()) {
+  dense_ = HValue::GetTag(obj) == Heap::kTagArray && HArray::IsDense(obj);
+  SkipEmpty();
+}
+
+
+inline bool HObjectIterator::IsEnded() {
+  return index_ >= size_;
+}
+
+
+inline void HObjectIterator::Advance() {
+  index_++;
+  SkipEmpty();
+}
+
+
+inline char* HObjectIterator::Key() {
+  if (dense_) return HNumber::ToPointer(index_);
+  return *map_->GetSlotAddress(index_);
+}
+
+
+inline char* HObjectIterator::Value() {
+  if (dense_) return *map_->GetSlotAddress(index_);
+  return *map_->GetSlotAddress(index_ + size_);
+}
+
+
+inline void HObjectIterator::SkipEmpty() {
+  // Dense arrays store values in key slots, so it works for both cases
+  while (index_ < size_ && map_->IsEmptySlot(index_)) index_++;
+}
+
+
 inline bool HMap::IsEmptySlot(uint32_t index) {
   return *GetSlotAddress(index) == HNil::New();
 }
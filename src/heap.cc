@@ -24,12 +24,14 @@
 
 #include <stdint.h>  // uint32_t, intptr_t
 #include <stdlib.h>  // NULL
-#include <string.h>  // memcpy
+#include <string.h>  // memcpy, memset
+#include <math.h>  // signbit
 #include <zone.h>  // Zone::Allocate
 #include <assert.h>  // assert
 
 #include "heap-inl.h"
 #include "runtime.h"  // RuntimeLookupProperty
+#include "runtime-stats.h"  // RuntimeStats
 
 namespace candor {
 namespace internal {
@@ -112,6 +114,43 @@ void Space::Swap(Space* space) {
 }
 
 
+uint32_t Space::Used() {
+  uint32_t used = 0;
+  List<Page*, EmptyClass>::Item* item = pages_.head();
+  for (; item != NULL; item = item->next()) {
+    // Page's data starts at odd offset
+    used += item->value()->top_ - item->value()->data_ - 1;
+  }
+
+  return used;
+}
+
+
+void Space::Visit(HeapVisitor* visitor) {
+  List<Page*, EmptyClass>::Item* item = pages_.head();
+  for (; item != NULL; item = item->next()) {
+    Page* page = item->value();
+
+    // Objects are laid out one after another starting at odd offset,
+    // allocations are rounded up to even size (see Space::Allocate)
+    char* current = page->data_ + 1;
+    while (current < page->top_) {
+      HValue* value = HValue::Cast(current);
+      uint32_t size = value->Size();
+      size += size & 0x01;
+
+      visitor->VisitValue(value, size);
+      current += size;
+    }
+
+    // Allocations are contiguous, every reserved byte belongs to an object
+    assert(current == page->top_);
+
+    visitor->VisitPageEnd(page->limit_ - page->top_);
+  }
+}
+
+
 void Space::Clear() {
   size_ = 0;
   while (pages_.length() != 0) {
@@ -127,10 +166,17 @@ Heap::Heap(uint32_t page_size) : new_space_(this, page_size),
                                  pending_exception_(NULL),
                                  needs_gc_(kGCNone),
                                  gc_(this),
-                                 code_space_(NULL) {
+                                 code_space_(NULL),
+                                 perf_counters_(NULL),
+                                 runtime_stats_(NULL) {
+  if (RuntimeStats::is_enabled()) runtime_stats_ = new RuntimeStats();
   current_ = this;
   factory_ = HValue::Cast(HObject::NewEmpty(this, kMinFactorySize));
   Reference(Heap::kRefPersistent, &factory_, factory_);
+
+  // Shared with the root context (factory returns the same value)
+  true_value_ = HValue::Cast(CreateBoolean(true));
+  Reference(Heap::kRefPersistent, &true_value_, true_value_);
 }
 
 
@@ -181,7 +227,7 @@ const char* Heap::ErrorToString(Error err) {
 
 
 char* Heap::AllocateTagged(HeapTag tag, TenureType tenure, uint32_t bytes) {
-  char* result = space(tenure)->Allocate(bytes + 8);
+  char* result = space(tenure)->Allocate(bytes + HValue::kPointerSize);
   intptr_t qtag = tag;
   if (tenure == kTenureOld) {
     int bit_offset = (HValue::kGenerationOffset -
@@ -220,9 +266,7 @@ void Heap::RemoveWeak(HValue* value) {
 }
 
 
-HValue* HValue::CopyTo(Space* old_space, Space* new_space) {
-  assert(!IsUnboxed(addr()));
-
+uint32_t HValue::Size() {
   uint32_t size = kPointerSize;
   switch (tag()) {
     case Heap::kTagContext:
@@ -248,7 +292,7 @@ HValue* HValue::CopyTo(Space* old_space, Space* new_space) {
           size += As<HString>()->length();
           break;
         case HString::kCons:
-          // + lhs + rhs + scratch_slot (for traversing)
+          // + lhs + rhs
           size += 2 * kPointerSize;
           break;
         default:
@@ -272,10 +316,24 @@ HValue* HValue::CopyTo(Space* old_space, Space* new_space) {
       // size + data
       size += kPointerSize + As<HCData>()->size();
       break;
+    case Heap::kTagHashMap:
+    case Heap::kTagHashSet:
+      // size + entries + index + mask + length + flags
+      size += 6 * kPointerSize;
+      break;
     default:
       UNEXPECTED
   }
 
+  return size;
+}
+
+
+HValue* HValue::CopyTo(Space* old_space, Space* new_space) {
+  assert(!IsUnboxed(addr()));
+
+  uint32_t size = Size();
+
   IncrementGeneration();
   char* result;
   if (Generation() >= Heap::kMinOldSpaceGeneration) {
@@ -325,6 +383,24 @@ char* HNumber::New(Heap* heap, Heap::TenureType tenure, double value) {
 }
 
 
+char* HNumber::FromDouble(Heap* heap, Heap::TenureType tenure, double value) {
+  // NaN and out of range values fail the comparison
+  if (value > -9.2e18 && value < 9.2e18) {
+    int64_t integral = static_cast<int64_t>(value);
+    intptr_t tagged = static_cast<intptr_t>(Tag(integral));
+
+    // -0 can't be represented by smi
+    if (integral == value &&
+        Untag(tagged) == integral &&
+        (integral != 0 || !signbit(value))) {
+      return reinterpret_cast<char*>(tagged);
+    }
+  }
+
+  return New(heap, tenure, value);
+}
+
+
 char* HBoolean::New(Heap* heap, Heap::TenureType tenure, bool value) {
   char* result = heap->AllocateTagged(Heap::kTagBoolean, tenure, kPointerSize);
   *reinterpret_cast<int8_t*>(result + kValueOffset) = value ? 1 : 0;
@@ -336,9 +412,10 @@ char* HBoolean::New(Heap* heap, Heap::TenureType tenure, bool value) {
 char* HString::New(Heap* heap,
                    Heap::TenureType tenure,
                    uint32_t length) {
+  // hash + length + bytes
   char* result = heap->AllocateTagged(Heap::kTagString,
                                       tenure,
-                                      length + 3 * kPointerSize);
+                                      length + 2 * kPointerSize);
 
   // Zero hash
   *reinterpret_cast<intptr_t*>(result + kHashOffset) = 0;
@@ -485,16 +562,44 @@ void HObject::Init(Heap* heap, char* obj, uint32_t size) {
 
 char** HObject::LookupProperty(Heap* heap, char* addr, char* key, int insert) {
   intptr_t offset = RuntimeLookupProperty(heap, addr, key, insert);
+
+  // There's no slot for a key (i.e. full map without insertion),
+  // return slot that is reset to nil on every such lookup
+  if (offset == Heap::kTagNil) {
+    static char* nil_slot;
+    nil_slot = HNil::New();
+    return &nil_slot;
+  }
+
   return reinterpret_cast<char**>(HObject::Map(addr) + offset);
 }
 
 
-char* HArray::NewEmpty(Heap* heap) {
+void HObject::Unshare(Heap* heap, char* addr) {
+  HMap* source = HValue::As<HMap>(Map(addr));
+  uint32_t size = source->size();
+
+  char* map = heap->AllocateTagged(Heap::kTagMap,
+                                   Heap::kTenureNew,
+                                   ((size << 1) + 1) * kPointerSize);
+
+  // NOTE: Allocation doesn't move objects, source's map is still valid here
+  *reinterpret_cast<intptr_t*>(map + HMap::kSizeOffset) = size;
+  memcpy(map + HMap::kSpaceOffset,
+         source->space(),
+         (size << 1) * kPointerSize);
+
+  *MapSlot(addr) = map;
+  SetRepresentation<Representation>(addr, kOwnMap);
+}
+
+
+char* HArray::NewEmpty(Heap* heap, uint32_t size) {
   char* obj = heap->AllocateTagged(Heap::kTagArray,
                                    Heap::kTenureNew,
                                    4 * kPointerSize);
 
-  HObject::Init(heap, obj, 16);
+  HObject::Init(heap, obj, size);
 
   // Set length
   SetLength(obj, 0);
@@ -503,10 +608,61 @@ char* HArray::NewEmpty(Heap* heap) {
 }
 
 
+void HArray::Reserve(Heap* heap, char* obj, int64_t length) {
+  uint32_t size = HValue::As<HMap>(HObject::Map(obj))->size();
+
+  // Non-dense arrays are hashmaps, leave some free space in them to keep
+  // collision chains short
+  int64_t min_size = length;
+  if (length > kDenseLengthMax) min_size = length << 1;
+
+  if (min_size <= size) return;
+  RuntimeGrowObject(heap, obj, min_size);
+}
+
+
+char** HArray::ElementSlot(char* obj, int64_t index, bool insert) {
+  char* space = HValue::As<HMap>(Map(obj))->space();
+  uint32_t mask = Mask(obj);
+
+  if (index < 0) return NULL;
+
+  if (IsDense(obj)) {
+    if (index * kPointerSize > mask) return NULL;
+    return reinterpret_cast<char**>(space + index * kPointerSize);
+  }
+
+  // Same probing as in RuntimeLookupProperty, keys are unboxed numbers
+  // and can be compared by pointer
+  char* key = HNumber::ToPointer(index);
+  uint32_t start = ComputeHash(index) & mask;
+  uint32_t offset = start;
+  do {
+    char** key_slot = reinterpret_cast<char**>(space + offset);
+    char** value_slot = reinterpret_cast<char**>(
+        space + offset + mask + kPointerSize);
+
+    if (*key_slot == key) return value_slot;
+    if (*key_slot == HNil::New()) {
+      if (!insert) return NULL;
+
+      // Reset proto, IC could not work with this object anymore
+      DisableIC(obj);
+      *key_slot = key;
+      return value_slot;
+    }
+
+    offset = (offset + kPointerSize) & mask;
+  } while (offset != start);
+
+  return NULL;
+}
+
+
 int64_t HArray::Length(char* obj, bool shrink) {
   int64_t result = *reinterpret_cast<intptr_t*>(obj + kLengthOffset);
 
-  if (shrink) {
+  if (shrink && GetRepresentation<Representation>(obj) == kDirtyLength) {
     // Lookup property at [length - 1]
     // Shrink if it's nil
     //
@@ -527,6 +683,7 @@ int64_t HArray::Length(char* obj, bool shrink) {
       result = shrinked + 1;
       SetLength(obj, result);
     }
+    ValidateLength(obj);
   }
 
   return result;
@@ -581,6 +738,27 @@ char* HFunction::NewBinding(Heap* heap, char* addr, char* root) {
 }
 
 
+char* HFunction::NewFastBinding(Heap* heap,
+                                char* addr,
+                                char* fast,
+                                FastBindingType type,
+                                uint32_t argc) {
+  assert(argc <= kMaxFastArgc);
+
+  char* desc = HCData::New(heap, 3 * kPointerSize);
+  *reinterpret_cast<char**>(desc + kFastCodeOffset) = fast;
+  *reinterpret_cast<intptr_t*>(desc + kFastTypeOffset) = type;
+  *reinterpret_cast<intptr_t*>(desc + kFastArgcOffset) = HNumber::Tag(argc);
+
+  char* fn = NewBinding(heap, addr, desc);
+
+  // Set argc
+  *reinterpret_cast<intptr_t*>(fn + kArgcOffset) = HNumber::Tag(argc);
+
+  return fn;
+}
+
+
 char* HCData::New(Heap* heap, size_t size) {
   char* d = heap->AllocateTagged(Heap::kTagCData,
                                  Heap::kTenureNew,
@@ -591,5 +769,249 @@ char* HCData::New(Heap* heap, size_t size) {
   return d;
 }
 
+
+char* HCData::New(Heap* heap, Representation type, size_t length) {
+  size_t size = length << ElementShift(type);
+  char* d = New(heap, size);
+
+  // Typed views are zero-filled
+  memset(Data(d), 0, size);
+  SetRepresentation(d, type);
+
+  return d;
+}
+
+
+char* HHashTable::New(Heap* heap, Heap::HeapTag tag) {
+  char* table = heap->AllocateTagged(tag,
+                                     Heap::kTenureNew,
+                                     6 * kPointerSize);
+
+  *reinterpret_cast<intptr_t*>(table + kSizeOffset) = 0;
+  *reinterpret_cast<intptr_t*>(table + kLengthOffset) = 0;
+  *EntriesSlot(table) = HNil::New();
+  *IndexSlot(table) = HNil::New();
+  Rebuild(heap, table, kMinCapacity);
+
+  return table;
+}
+
+
+// Bucket word layout
+static inline uint64_t BucketWord(uint32_t hash, uint32_t entry) {
+  return (static_cast<uint64_t>(hash) << 32) | (entry + 1);
+}
+
+
+static inline uint64_t* Buckets(char* addr) {
+  return reinterpret_cast<uint64_t*>(
+      HCData::Data(*HHashTable::IndexSlot(addr)));
+}
+
+
+static inline uint32_t BucketMask(char* addr) {
+  return *reinterpret_cast<intptr_t*>(addr + HHashTable::kMaskOffset) /
+         sizeof(uint64_t);
+}
+
+
+static inline char** EntrySlots(char* addr) {
+  return reinterpret_cast<char**>(*HHashTable::EntriesSlot(addr) +
+                                  HMap::kSpaceOffset);
+}
+
+
+static inline intptr_t* LengthSlot(char* addr) {
+  return reinterpret_cast<intptr_t*>(addr + HHashTable::kLengthOffset);
+}
+
+
+uint32_t HHashTable::Hash(Heap* heap, char* key, bool* is_pointer) {
+  switch (GetTag(key)) {
+    case Heap::kTagString:
+      return HString::Hash(heap, key);
+    case Heap::kTagNumber:
+    case Heap::kTagBoolean:
+      return RuntimeGetHash(heap, key);
+    default:
+      // Everything else is compared by identity
+      *is_pointer = true;
+      return ComputeHash(reinterpret_cast<intptr_t>(key));
+  }
+}
+
+
+int64_t HHashTable::Find(Heap* heap,
+                         char* addr,
+                         char* key,
+                         uint32_t hash,
+                         uint32_t* bucket) {
+  uint64_t* buckets = Buckets(addr);
+  char** slots = EntrySlots(addr);
+  uint32_t mask = BucketMask(addr);
+
+  // There is always an empty bucket, as index has twice more buckets than
+  // entries' map has room for
+  uint32_t index = hash & mask;
+  for (; buckets[index] != 0; index = (index + 1) & mask) {
+    uint64_t word = buckets[index];
+    if (static_cast<uint32_t>(word >> 32) != hash) continue;
+
+    uint32_t entry = static_cast<uint32_t>(word) - 1;
+    char* entry_key = slots[entry << 1];
+
+    // Deleted entries are tombstones
+    if (entry_key == HNil::New()) continue;
+    if (entry_key == key || RuntimeStrictCompare(heap, entry_key, key) == 0) {
+      *bucket = index;
+      return entry;
+    }
+  }
+
+  *bucket = index;
+  return -1;
+}
+
+
+intptr_t HHashTable::Lookup(Heap* heap, char* addr, char* key, bool insert) {
+  if (key == HNil::New()) return Heap::kTagNil;
+
+  bool is_pointer = false;
+  uint32_t hash = Hash(heap, key, &is_pointer);
+
+  // Only buckets of keys hashed by address may be stale
+  if (is_pointer && (*FlagsSlot(addr) & kStaleIndex)) Reindex(heap, addr);
+
+  uint32_t bucket;
+  int64_t entry = Find(heap, addr, key, hash, &bucket);
+  bool is_set = GetTag(addr) == Heap::kTagHashSet;
+
+  if (entry == -1) {
+    if (!insert) return Heap::kTagNil;
+
+    intptr_t length = *LengthSlot(addr);
+    uint32_t capacity = As<HMap>(*EntriesSlot(addr))->size();
+    if (length == capacity) {
+      // Drop tombstones if there're enough of them, grow otherwise
+      if (Size(addr) * 4 >= capacity * 3) capacity <<= 1;
+      Rebuild(heap, addr, capacity);
+
+      return Lookup(heap, addr, key, insert);
+    }
+
+    entry = length;
+    char** slots = EntrySlots(addr);
+    slots[entry << 1] = key;
+    if (is_set) {
+      slots[(entry << 1) + 1] = heap->true_value();
+    }
+
+    Buckets(addr)[bucket] = BucketWord(hash, entry);
+    *LengthSlot(addr) = length + 1;
+    *reinterpret_cast<intptr_t*>(addr + kSizeOffset) = Size(addr) + 1;
+    if (is_pointer) *FlagsSlot(addr) |= kPointerKeys;
+  }
+
+  // Set's values are always `true`, stores only add the key
+  if (is_set && insert) return Heap::kTagNil;
+
+  return HMap::kSpaceOffset + ((entry << 1) + 1) * kPointerSize;
+}
+
+
+bool HHashTable::Delete(Heap* heap, char* addr, char* key) {
+  if (key == HNil::New()) return false;
+
+  bool is_pointer = false;
+  uint32_t hash = Hash(heap, key, &is_pointer);
+  if (is_pointer && (*FlagsSlot(addr) & kStaleIndex)) Reindex(heap, addr);
+
+  uint32_t bucket;
+  int64_t entry = Find(heap, addr, key, hash, &bucket);
+  if (entry == -1) return false;
+
+  // Bucket stays occupied until the next rebuild
+  char** slots = EntrySlots(addr);
+  slots[entry << 1] = HNil::New();
+  slots[(entry << 1) + 1] = HNil::New();
+  *reinterpret_cast<intptr_t*>(addr + kSizeOffset) = Size(addr) - 1;
+
+  return true;
+}
+
+
+char* HHashTable::Keys(Heap* heap, char* addr) {
+  int64_t count = Size(addr);
+  char* result = HArray::NewEmpty(heap, HArray::LiteralSize(count));
+
+  // NOTE: Allocation doesn't move objects, entries are still valid here
+  char** slots = EntrySlots(addr);
+  intptr_t length = *LengthSlot(addr);
+  int64_t index = 0;
+  for (intptr_t i = 0; i < length; i++) {
+    char* key = slots[i << 1];
+    if (key == HNil::New()) continue;
+
+    char** slot = HObject::LookupProperty(heap,
+                                          result,
+                                          HNumber::ToPointer(index++),
+                                          1);
+    *slot = key;
+  }
+
+  return result;
+}
+
+
+void HHashTable::Rebuild(Heap* heap, char* addr, uint32_t capacity) {
+  char* entries = HMap::NewEmpty(heap, capacity);
+  char* index = HCData::New(heap, HCData::kUint64, capacity << 1);
+
+  // Copy live entries preserving their order
+  intptr_t length = 0;
+  if (*EntriesSlot(addr) != HNil::New()) {
+    char** from = EntrySlots(addr);
+    char** to = reinterpret_cast<char**>(entries + HMap::kSpaceOffset);
+    intptr_t old_length = *LengthSlot(addr);
+    for (intptr_t i = 0; i < old_length; i++) {
+      if (from[i << 1] == HNil::New()) continue;
+
+      to[length << 1] = from[i << 1];
+      to[(length << 1) + 1] = from[(i << 1) + 1];
+      length++;
+    }
+  }
+
+  *EntriesSlot(addr) = entries;
+  *IndexSlot(addr) = index;
+  *reinterpret_cast<intptr_t*>(addr + kMaskOffset) =
+      ((capacity << 1) - 1) * sizeof(uint64_t);
+  *LengthSlot(addr) = length;
+
+  Reindex(heap, addr);
+}
+
+
+void HHashTable::Reindex(Heap* heap, char* addr) {
+  uint64_t* buckets = Buckets(addr);
+  char** slots = EntrySlots(addr);
+  uint32_t mask = BucketMask(addr);
+  memset(buckets, 0, (mask + 1) * sizeof(*buckets));
+
+  bool has_pointers = false;
+  intptr_t length = *LengthSlot(addr);
+  for (intptr_t i = 0; i < length; i++) {
+    char* key = slots[i << 1];
+    if (key == HNil::New()) continue;
+
+    uint32_t hash = Hash(heap, key, &has_pointers);
+    uint32_t index = hash & mask;
+    while (buckets[index] != 0) index = (index + 1) & mask;
+    buckets[index] = BucketWord(hash, i);
+  }
+
+  *FlagsSlot(addr) = has_pointers ? kPointerKeys : kNone;
+}
+
 }  // namespace internal
 }  // namespace candor
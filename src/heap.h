@@ -46,9 +46,24 @@ namespace internal {
 
 // Forward declarations
 class Heap;
+class HValue;
 class HValueReference;
 class HValueWeakRef;
 class CodeSpace;
+class PerfCounters;
+class RuntimeStats;
+
+// Receives every object of space, see Space::Visit()
+class HeapVisitor {
+ public:
+  virtual ~HeapVisitor() {}
+
+  // `size` includes tag and alignment
+  virtual void VisitValue(HValue* value, uint32_t size) = 0;
+
+  // Called once per page with number of bytes left after its last object
+  virtual void VisitPageEnd(uint32_t free) = 0;
+};
 
 class Space {
  public:
@@ -85,6 +100,12 @@ class Space {
   // Remove all pages
   void Clear();
 
+  // Bytes allocated in all pages
+  uint32_t Used();
+
+  // Walks all pages object by object (should not be called during GC)
+  void Visit(HeapVisitor* visitor);
+
   inline Heap* heap() { return heap_; }
 
   // Both top and limit are always pointing to current page's
@@ -138,6 +159,8 @@ class Heap {
     kTagArray,
     kTagFunction,
     kTagCData,
+    kTagHashMap,
+    kTagHashSet,
 
     kTagMap
   };
@@ -173,7 +196,9 @@ class Heap {
     kRootObjectTypeIndex   = 7,
     kRootArrayTypeIndex    = 8,
     kRootFunctionTypeIndex = 9,
-    kRootCDataTypeIndex    = 10
+    kRootCDataTypeIndex    = 10,
+    kRootHashMapTypeIndex  = 11,
+    kRootHashSetTypeIndex  = 12
   };
 
   enum ReferenceType {
@@ -238,11 +263,23 @@ class Heap {
   inline void code_space(CodeSpace* code_space) { code_space_ = code_space; }
   inline SourceMap* source_map() { return &source_map_; }
 
+  // NULL unless enabled through the API
+  inline PerfCounters* perf_counters() { return perf_counters_; }
+  inline void perf_counters(PerfCounters* perf_counters) {
+    perf_counters_ = perf_counters;
+  }
+
+  // NULL unless RuntimeStats::Enable() was called before creating heap
+  inline RuntimeStats* runtime_stats() { return runtime_stats_; }
+
   // Factory methods
   char* CreateString(const char* key, uint32_t size);
   char* CreateNumber(double num);
   char* CreateBoolean(bool value);
 
+  // Same object as the one at kRootTrueIndex
+  inline char* true_value() { return reinterpret_cast<char*>(true_value_); }
+
  private:
   char* ToFactory(char* key);
 
@@ -260,10 +297,13 @@ class Heap {
   HValueRefMap references_;
   HValueWeakRefMap weak_references_;
   HValue* factory_;
+  HValue* true_value_;
 
   GC gc_;
   CodeSpace* code_space_;
   SourceMap source_map_;
+  PerfCounters* perf_counters_;
+  RuntimeStats* runtime_stats_;
 
   static Heap* current_;
 };
@@ -293,6 +333,9 @@ class HValue {
 
   HValue* CopyTo(Space* old_space, Space* new_space);
 
+  // Size of object in bytes (including tag)
+  uint32_t Size();
+
   inline bool IsGCMarked();
   inline char* GetGCMark();
   inline void SetGCMark(char* new_addr);
@@ -424,6 +467,10 @@ class HNumber : public HValue {
   static char* New(Heap* heap, int64_t value);
   static char* New(Heap* heap, Heap::TenureType tenure, double value);
 
+  // Unboxed number if value is integral and fits into smi,
+  // heap number otherwise
+  static char* FromDouble(Heap* heap, Heap::TenureType tenure, double value);
+
   static inline int64_t Untag(int64_t value);
   static inline int64_t Tag(int64_t value);
 
@@ -435,6 +482,10 @@ class HNumber : public HValue {
 
   static inline bool IsIntegral(char* addr);
 
+  // Truncates towards zero like cvttsd2si, NaN and values out of
+  // int64 range become INT64_MIN
+  static inline int64_t Truncate(double value);
+
   static const int kDoubleSize = 8;
 
   static const int kValueOffset = HINTERIOR_OFFSET(1);
@@ -516,9 +567,22 @@ class HString : public HValue {
 
 class HObject : public HValue {
  public:
-  static char* NewEmpty(Heap* heap, uint32_t size = 16);
+  // Clone shares source's map until the first store into any of them
+  enum Representation {
+    kOwnMap    = 0x00,
+    kSharedMap = 0x01
+  };
+
+  static char* NewEmpty(Heap* heap, uint32_t size = 4);
   static void Init(Heap* heap, char* obj, uint32_t size);
 
+  // Size of map for literal with `count` properties, keep it at most half
+  // full so most keys stay in their home slots (the only ones checked by
+  // generated code)
+  static inline uint32_t LiteralSize(uint32_t count) {
+    return PowerOfTwo(count << 1);
+  }
+
   inline char* map() { return *map_slot(); }
   inline char** map_slot() { return MapSlot(addr()); }
   inline uint32_t mask() { return *mask_slot(); }
@@ -539,8 +603,25 @@ class HObject : public HValue {
   }
   static inline char* Proto(char* addr) { return *ProtoSlot(addr); }
 
+  // Proto of objects that IC can't work with, sign-extended like the
+  // immediate stored by generated code
+  static inline char* ICDisabledProto() {
+    return reinterpret_cast<char*>(
+        static_cast<intptr_t>(static_cast<int32_t>(Heap::kICDisabledValue)));
+  }
+  static inline void DisableIC(char* addr) {
+    *ProtoSlot(addr) = ICDisabledProto();
+  }
+
   static char** LookupProperty(Heap* heap, char* addr, char* key, int insert);
 
+  static inline bool IsShared(char* addr) {
+    return GetRepresentation<Representation>(addr) == kSharedMap;
+  }
+
+  // Give object a private copy of its shared map (must precede any write)
+  static void Unshare(Heap* heap, char* addr);
+
   static const int kMaskOffset = HINTERIOR_OFFSET(1);
   static const int kMapOffset = HINTERIOR_OFFSET(2);
   static const int kProtoOffset = HINTERIOR_OFFSET(3);
@@ -551,10 +632,41 @@ class HObject : public HValue {
 
 class HArray : public HObject {
  public:
-  static char* NewEmpty(Heap* heap);
+  // Length is a high-water mark of stored indexes, trailing elements may be
+  // nil after nil stores and deletes near it (until next `Length(obj, true)`)
+  // NOTE: Bits shouldn't overlap with HObject's ones
+  enum Representation {
+    kExactLength = 0x00,
+    kDirtyLength = 0x02
+  };
+
+  // Value of `insert` argument of property lookups for stores of values
+  // that are known to be non-nil, length of array stays exact after them
+  // (`insert` = 1 means that any value may be stored)
+  static const int kInsertNonNil = 2;
+
+  static char* NewEmpty(Heap* heap, uint32_t size = 4);
+
+  // Dense arrays are indexed directly and need no spare slots
+  static inline uint32_t LiteralSize(uint32_t count) {
+    if (count > static_cast<uint32_t>(kDenseLengthMax)) {
+      return HObject::LiteralSize(count);
+    }
+    return PowerOfTwo(count);
+  }
+
+  // Grow array's map (if needed) to fit `length` elements
+  static void Reserve(Heap* heap, char* obj, int64_t length);
+
+  // Slot of element at `index` without allocating or calling into runtime.
+  // Returns NULL if element is absent (and `insert` is false) or if map has
+  // no room for it (use `Reserve` ahead of bulk inserts).
+  static char** ElementSlot(char* obj, int64_t index, bool insert);
 
   static int64_t Length(char* obj, bool shrink);
   static inline void SetLength(char* obj, int64_t length);
+  static inline void InvalidateLength(char* obj);
+  static inline void ValidateLength(char* obj);
 
   static inline bool IsDense(char* obj);
 
@@ -586,11 +698,45 @@ class HMap : public HValue {
 };
 
 
+// Walks over keys of object or array without allocating anything
+// (dense arrays yield indexes of their non-nil elements)
+class HObjectIterator {
+ public:
+  explicit inline HObjectIterator(char* obj);
+
+  inline bool IsEnded();
+  inline void Advance();
+  inline char* Key();
+  inline char* Value();
+
+ private:
+  inline void SkipEmpty();
+
+  HMap* map_;
+  uint32_t index_;
+  uint32_t size_;
+  bool dense_;
+};
+
+
 class HFunction : public HValue {
  public:
   static char* New(Heap* heap, char* parent, char* addr, char* root);
   static char* NewBinding(Heap* heap, char* addr, char* root);
 
+  enum FastBindingType {
+    kFastDouble,
+    kFastIntegral
+  };
+
+  // Binding with a native typed counterpart that could be called with
+  // unboxed arguments (see CallBindingStub)
+  static char* NewFastBinding(Heap* heap,
+                              char* addr,
+                              char* fast,
+                              FastBindingType type,
+                              uint32_t argc);
+
   static inline char* Root(char* addr) {
     return *reinterpret_cast<char**>(addr + kRootOffset);
   }
@@ -625,13 +771,54 @@ class HFunction : public HValue {
   static const int kRootOffset = HINTERIOR_OFFSET(3);
   static const int kArgcOffset = HINTERIOR_OFFSET(4);
 
+  // Fast binding's descriptor is a CData stored in the root slot
+  static const int kFastCodeOffset = HINTERIOR_OFFSET(2);
+  static const int kFastTypeOffset = HINTERIOR_OFFSET(3);
+  static const int kFastArgcOffset = HINTERIOR_OFFSET(4);
+  static const uint32_t kMaxFastArgc = 2;
+
   static const Heap::HeapTag class_tag = Heap::kTagFunction;
 };
 
 
 class HCData : public HValue {
  public:
+  // Typed views interpret contents as an array of elements
+  enum Representation {
+    kRaw     = 0x00,
+    kInt8    = 0x01,
+    kUint8   = 0x02,
+    kInt16   = 0x03,
+    kUint16  = 0x04,
+    kInt32   = 0x05,
+    kUint32  = 0x06,
+    kInt64   = 0x07,
+    kUint64  = 0x08,
+    kFloat32 = 0x09,
+    kFloat64 = 0x0A
+  };
+
   static char* New(Heap* heap, size_t size);
+  static char* New(Heap* heap, Representation type, size_t length);
+
+  static inline Representation ElementType(char* addr) {
+    return GetRepresentation<Representation>(addr);
+  }
+
+  // log2 of element's size
+  static inline int ElementShift(Representation type) {
+    switch (type) {
+      case kInt16: case kUint16: return 1;
+      case kInt32: case kUint32: case kFloat32: return 2;
+      case kInt64: case kUint64: case kFloat64: return 3;
+      default: return 0;
+    }
+  }
+
+  // Number of elements in typed view (bytes for raw data)
+  static inline uint32_t Length(char* addr) {
+    return Size(addr) >> ElementShift(ElementType(addr));
+  }
 
   static inline uint32_t Size(char* addr) {
     return *reinterpret_cast<uint32_t*>(addr + kSizeOffset);
@@ -643,6 +830,7 @@ class HCData : public HValue {
 
   inline uint32_t size() { return Size(addr()); }
   inline void* data() { return Data(addr()); }
+  inline Representation element_type() { return ElementType(addr()); }
 
   static const int kSizeOffset = HINTERIOR_OFFSET(1);
   static const int kDataOffset = HINTERIOR_OFFSET(2);
@@ -650,6 +838,77 @@ class HCData : public HValue {
   static const Heap::HeapTag class_tag = Heap::kTagCData;
 };
 
+
+// Insertion-ordered hash table behind script maps and sets.
+// Entries are appended as key/value pairs to an HMap, stored at the same
+// offset as object's map, so property loads and stores can use slot offsets
+// returned by `Lookup` as they do for objects. Deleted entries are left with
+// nil key until the next rebuild. Index is an open-addressed table of
+// `hash << 32 | (entry + 1)` words, zero marks an empty bucket.
+class HHashTable : public HValue {
+ public:
+  enum Flags {
+    kNone        = 0x00,
+    // Some keys are hashed by address and move during GC
+    kPointerKeys = 0x01,
+    // Set by GC, buckets of pointer keys should be recomputed
+    kStaleIndex  = 0x02
+  };
+
+  static char* New(Heap* heap, Heap::HeapTag tag);
+
+  // Returns offset of entry's value slot in entries' map or kTagNil if key
+  // isn't present (or is nil), sets insert missing keys
+  static intptr_t Lookup(Heap* heap, char* addr, char* key, bool insert);
+  static bool Delete(Heap* heap, char* addr, char* key);
+
+  // Array of keys in insertion order
+  static char* Keys(Heap* heap, char* addr);
+
+  static inline bool IsHashTable(char* addr) {
+    Heap::HeapTag tag = GetTag(addr);
+    return tag == Heap::kTagHashMap || tag == Heap::kTagHashSet;
+  }
+
+  static inline int64_t Size(char* addr) {
+    return *reinterpret_cast<intptr_t*>(addr + kSizeOffset);
+  }
+  static inline char** EntriesSlot(char* addr) {
+    return reinterpret_cast<char**>(addr + kEntriesOffset);
+  }
+  static inline char** IndexSlot(char* addr) {
+    return reinterpret_cast<char**>(addr + kIndexOffset);
+  }
+  static inline intptr_t* FlagsSlot(char* addr) {
+    return reinterpret_cast<intptr_t*>(addr + kFlagsOffset);
+  }
+
+  static const int kSizeOffset = HINTERIOR_OFFSET(1);
+  static const int kEntriesOffset = HINTERIOR_OFFSET(2);
+  static const int kIndexOffset = HINTERIOR_OFFSET(3);
+  static const int kMaskOffset = HINTERIOR_OFFSET(4);
+  static const int kLengthOffset = HINTERIOR_OFFSET(5);
+  static const int kFlagsOffset = HINTERIOR_OFFSET(6);
+
+  static const uint32_t kMinCapacity = 8;
+
+ private:
+  static uint32_t Hash(Heap* heap, char* key, bool* is_pointer);
+
+  // Returns entry's index or -1, `bucket` receives the last probed bucket
+  static int64_t Find(Heap* heap,
+                      char* addr,
+                      char* key,
+                      uint32_t hash,
+                      uint32_t* bucket);
+
+  // Moves live entries into storage of given capacity
+  static void Rebuild(Heap* heap, char* addr, uint32_t capacity);
+
+  // Recomputes hashes and buckets in place
+  static void Reindex(Heap* heap, char* addr);
+};
+
 #undef HINTERIOR_OFFSET
 
 }  // namespace internal
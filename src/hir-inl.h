@@ -243,6 +243,13 @@ inline HIRInstruction* HIRGen::Assign(ScopeSlot* slot, HIRInstruction* value) {
 }
 
 
+inline void HIRGen::ClearLogicSlot() {
+  HIREnvironment* env = current_block()->env();
+  env->Set(env->logic_slot(), NULL);
+  env->SetPhi(env->logic_slot(), NULL);
+}
+
+
 inline HIRInstruction* HIRGen::GetNumber(uint64_t i) {
   AstNode* index = new AstNode(AstNode::kNumber);
 
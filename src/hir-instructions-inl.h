@@ -270,11 +270,31 @@ inline int HIREntry::context_slots() {
 }
 
 
+inline Heap::HeapTag HIRTypeCheck::tag() {
+  return tag_;
+}
+
+
+inline bool HIRTypeCheck::negate() {
+  return negate_;
+}
+
+
 inline BinOp::BinOpType HIRBinOp::binop_type() {
   return binop_type_;
 }
 
 
+inline MathOp::MathOpType HIRMath::math_type() {
+  return math_type_;
+}
+
+
+inline MathOp::MathOpType HIRMathCheck::math_type() {
+  return math_type_;
+}
+
+
 inline ScopeSlot* HIRLoadContext::context_slot() {
   return context_slot_;
 }
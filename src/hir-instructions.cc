@@ -453,6 +453,37 @@ bool HIRBinOp::IsGVNEqual(HIRInstruction* to) {
 }
 
 
+HIRMath::HIRMath(MathOp::MathOpType type) : HIRInstruction(kMath),
+                                            math_type_(type) {
+}
+
+
+void HIRMath::CalculateRepresentation() {
+  representation_ = kNumberRepresentation;
+}
+
+
+bool HIRMath::IsGVNEqual(HIRInstruction* to) {
+  return math_type_ == HIRMath::Cast(to)->math_type_;
+}
+
+
+HIRMathCheck::HIRMathCheck(MathOp::MathOpType type)
+    : HIRInstruction(kMathCheck),
+      math_type_(type) {
+}
+
+
+void HIRMathCheck::CalculateRepresentation() {
+  representation_ = kBooleanRepresentation;
+}
+
+
+bool HIRMathCheck::IsGVNEqual(HIRInstruction* to) {
+  return math_type_ == HIRMathCheck::Cast(to)->math_type_;
+}
+
+
 HIRLoadContext::HIRLoadContext(ScopeSlot* slot)
     : HIRInstruction(kLoadContext),
       context_slot_(slot) {
@@ -533,7 +564,7 @@ bool HIRDeleteProperty::Effects(HIRInstruction* instr) {
 
 HIRAllocateObject::HIRAllocateObject(int size)
     : HIRInstruction(kAllocateObject),
-      size_(RoundUp(PowerOfTwo(size + 1), 64)) {
+      size_(HObject::LiteralSize(size)) {
 }
 
 
@@ -549,7 +580,7 @@ void HIRAllocateObject::CalculateRepresentation() {
 
 HIRAllocateArray::HIRAllocateArray(int size)
     : HIRInstruction(kAllocateArray),
-      size_(RoundUp(PowerOfTwo(size + 1), 16)) {
+      size_(HArray::LiteralSize(size)) {
 }
 
 
@@ -563,6 +594,22 @@ void HIRAllocateArray::CalculateRepresentation() {
 }
 
 
+HIRCloneLiteral::HIRCloneLiteral(bool is_array)
+    : HIRInstruction(kCloneLiteral),
+      is_array_(is_array) {
+}
+
+
+bool HIRCloneLiteral::HasGVNSideEffects() {
+  return true;
+}
+
+
+void HIRCloneLiteral::CalculateRepresentation() {
+  representation_ = is_array_ ? kArrayRepresentation : kObjectRepresentation;
+}
+
+
 HIRLoadArg::HIRLoadArg() : HIRInstruction(kLoadArg) {
 }
 
@@ -659,6 +706,56 @@ void HIRTypeof::CalculateRepresentation() {
 }
 
 
+HIRTypeCheck::HIRTypeCheck(Heap::HeapTag tag, bool negate)
+    : HIRInstruction(kTypeCheck),
+      tag_(tag),
+      negate_(negate) {
+}
+
+
+void HIRTypeCheck::CalculateRepresentation() {
+  representation_ = kBooleanRepresentation;
+}
+
+
+bool HIRTypeCheck::IsGVNEqual(HIRInstruction* to) {
+  HIRTypeCheck* check = HIRTypeCheck::Cast(to);
+  return tag_ == check->tag_ && negate_ == check->negate_;
+}
+
+
+void HIRTypeCheck::Print(PrintBuffer* p) {
+  p->Print("i%d = TypeCheck[%s%d](i%d)\n",
+           id,
+           negate_ ? "!" : "",
+           tag_,
+           left()->id);
+}
+
+
+int HIRTypeCheck::KnownTag() {
+  // NOTE: nil representation isn't used here, `nil + nil` has it too
+  switch (left()->representation()) {
+    case kNumberRepresentation:
+    case kSmiRepresentation:
+    case kHeapNumberRepresentation:
+      return Heap::kTagNumber;
+    case kStringRepresentation:
+      return Heap::kTagString;
+    case kBooleanRepresentation:
+      return Heap::kTagBoolean;
+    case kObjectRepresentation:
+      return Heap::kTagObject;
+    case kArrayRepresentation:
+      return Heap::kTagArray;
+    case kFunctionRepresentation:
+      return Heap::kTagFunction;
+    default:
+      return 0;
+  }
+}
+
+
 HIRClone::HIRClone() : HIRInstruction(kClone) {
 }
 
@@ -24,6 +24,7 @@
 #define _SRC_HIR_INSTRUCTIONS_H_
 
 #include "ast.h"  // AstNode
+#include "heap.h"  // Heap
 #include "scope.h"  // ScopeSlot
 #include "zone.h"  // Zone, ZoneList
 #include "utils.h"  // PrintBuffer
@@ -64,6 +65,7 @@ typedef ZoneList<HIRPhi*> HIRPhiList;
     V(Not) \
     V(BinOp) \
     V(Typeof) \
+    V(TypeCheck) \
     V(Sizeof) \
     V(Keysof) \
     V(Clone) \
@@ -72,6 +74,9 @@ typedef ZoneList<HIRPhi*> HIRPhiList;
     V(GetStackTrace) \
     V(AllocateObject) \
     V(AllocateArray) \
+    V(CloneLiteral) \
+    V(Math) \
+    V(MathCheck) \
     V(Phi)
 
 #define HIR_INSTRUCTION_ENUM(I) \
@@ -353,6 +358,37 @@ class HIRBinOp : public HIRInstruction {
   BinOp::BinOpType binop_type_;
 };
 
+class HIRMath : public HIRInstruction {
+ public:
+  explicit HIRMath(MathOp::MathOpType type);
+
+  void CalculateRepresentation();
+  inline MathOp::MathOpType math_type();
+
+  HIR_DEFAULT_METHODS(Math)
+
+ protected:
+  bool IsGVNEqual(HIRInstruction* to);
+
+  MathOp::MathOpType math_type_;
+};
+
+// True if value is `math` module's function for `type` (see BindingCode)
+class HIRMathCheck : public HIRInstruction {
+ public:
+  explicit HIRMathCheck(MathOp::MathOpType type);
+
+  void CalculateRepresentation();
+  inline MathOp::MathOpType math_type();
+
+  HIR_DEFAULT_METHODS(MathCheck)
+
+ protected:
+  bool IsGVNEqual(HIRInstruction* to);
+
+  MathOp::MathOpType math_type_;
+};
+
 class HIRLoadContext : public HIRInstruction {
  public:
   explicit HIRLoadContext(ScopeSlot* slot);
@@ -443,6 +479,20 @@ class HIRAllocateArray : public HIRInstruction {
   int size_;
 };
 
+// Copy of literal's boilerplate (object or array)
+class HIRCloneLiteral : public HIRInstruction {
+ public:
+  explicit HIRCloneLiteral(bool is_array);
+
+  bool HasGVNSideEffects();
+  void CalculateRepresentation();
+
+  HIR_DEFAULT_METHODS(CloneLiteral)
+
+ private:
+  bool is_array_;
+};
+
 class HIRLoadArg : public HIRInstruction {
  public:
   HIRLoadArg();
@@ -544,6 +594,28 @@ class HIRTypeof : public HIRInstruction {
  private:
 };
 
+// Fused `typeof value == "type"` (or `!=` if `negate`)
+class HIRTypeCheck : public HIRInstruction {
+ public:
+  HIRTypeCheck(Heap::HeapTag tag, bool negate);
+
+  void CalculateRepresentation();
+  bool IsGVNEqual(HIRInstruction* to);
+  void Print(PrintBuffer* p);
+
+  // Tag of input if it is known from it's representation, or zero
+  int KnownTag();
+
+  inline Heap::HeapTag tag();
+  inline bool negate();
+
+  HIR_DEFAULT_METHODS(TypeCheck)
+
+ private:
+  Heap::HeapTag tag_;
+  bool negate_;
+};
+
 class HIRClone : public HIRInstruction {
  public:
   HIRClone();
@@ -622,6 +622,10 @@ void HIRGen::ScheduleLate(HIRInstruction* instr) {
     if (lca->loop_depth < best->loop_depth) best = lca;
   }
 
+  // Property loads can't be moved down: stores in blocks between them and
+  // their uses may be to the same object (through another value)
+  if (instr->Is(HIRInstruction::kLoadProperty)) best = instr->block();
+
   instr->block(best);
 }
 
@@ -983,10 +987,77 @@ HIRInstruction* HIRGen::VisitUnOp(AstNode* stmt) {
 }
 
 
+// Maps result of `typeof` to a heap tag (or zero if string isn't a type name)
+static int TypeofTag(AstNode* str) {
+  static const struct {
+    const char* name;
+    Heap::HeapTag tag;
+  } types[] = {
+    { "nil", Heap::kTagNil },
+    { "boolean", Heap::kTagBoolean },
+    { "number", Heap::kTagNumber },
+    { "string", Heap::kTagString },
+    { "object", Heap::kTagObject },
+    { "array", Heap::kTagArray },
+    { "function", Heap::kTagFunction },
+    { "cdata", Heap::kTagCData },
+    { "map", Heap::kTagHashMap },
+    { "set", Heap::kTagHashSet }
+  };
+
+  for (size_t i = 0; i < sizeof(types) / sizeof(types[0]); i++) {
+    if (strlen(types[i].name) == str->length() &&
+        strncmp(types[i].name, str->value(), str->length()) == 0) {
+      return types[i].tag;
+    }
+  }
+
+  return 0;
+}
+
+
+HIRInstruction* HIRGen::FuseTypeof(BinOp* op) {
+  bool negate;
+  switch (op->subtype()) {
+    case BinOp::kEq:
+    case BinOp::kStrictEq:
+      negate = false;
+      break;
+    case BinOp::kNe:
+    case BinOp::kStrictNe:
+      negate = true;
+      break;
+    default:
+      return NULL;
+  }
+
+  AstNode* type = op->lhs();
+  AstNode* str = op->rhs();
+  if (!type->is(AstNode::kTypeof)) {
+    type = op->rhs();
+    str = op->lhs();
+  }
+  if (!type->is(AstNode::kTypeof) || !str->is(AstNode::kString)) return NULL;
+
+  int tag = TypeofTag(str);
+  if (tag == 0) return NULL;
+
+  HIRInstruction* value = Visit(type->lhs());
+  return Add(new HIRTypeCheck(static_cast<Heap::HeapTag>(tag), negate))
+      ->Unpin()
+      ->AddArg(value);
+}
+
+
 HIRInstruction* HIRGen::VisitBinOp(AstNode* stmt) {
   BinOp* op = BinOp::Cast(stmt);
   HIRInstruction* res;
 
+  if ((res = FuseTypeof(op)) != NULL) {
+    res->ast(stmt);
+    return res;
+  }
+
   if (!BinOp::is_bool_logic(op->subtype())) {
     HIRInstruction* lhs = Visit(op->lhs());
     HIRInstruction* rhs = Visit(op->rhs());
@@ -1023,6 +1094,7 @@ HIRInstruction* HIRGen::VisitBinOp(AstNode* stmt) {
     set_current_block(Join(t, f));
     HIRPhi* phi =  current_block()->env()->PhiAt(slot);
     assert(phi != NULL);
+    ClearLogicSlot();
 
     return phi;
   }
@@ -1034,11 +1106,21 @@ HIRInstruction* HIRGen::VisitBinOp(AstNode* stmt) {
 
 HIRInstruction* HIRGen::VisitObjectLiteral(AstNode* stmt) {
   ObjectLiteral* obj = ObjectLiteral::Cast(stmt);
-  HIRInstruction* res = Add(new HIRAllocateObject(obj->keys()->length()));
+  ScopeSlot* boilerplate = root_->PutBoilerplate(stmt);
+  HIRInstruction* res;
+  if (boilerplate == NULL) {
+    res = Add(new HIRAllocateObject(obj->keys()->length()));
+  } else {
+    HIRInstruction* literal = Add(new HIRLiteral(stmt->type(), boilerplate));
+    res = Add(new HIRCloneLiteral(false))->AddArg(literal);
+  }
 
   AstList::Item* khead = obj->keys()->head();
   AstList::Item* vhead = obj->values()->head();
   for (; khead != NULL; khead = khead->next(), vhead = vhead->next()) {
+    // Constant values are already in the boilerplate
+    if (boilerplate != NULL && Root::IsConstant(vhead->value())) continue;
+
     HIRInstruction* value = Visit(vhead->value());
     HIRInstruction* key = Visit(khead->value());
 
@@ -1053,10 +1135,20 @@ HIRInstruction* HIRGen::VisitObjectLiteral(AstNode* stmt) {
 
 
 HIRInstruction* HIRGen::VisitArrayLiteral(AstNode* stmt) {
-  HIRInstruction* res = Add(new HIRAllocateArray(stmt->children()->length()));
+  ScopeSlot* boilerplate = root_->PutBoilerplate(stmt);
+  HIRInstruction* res;
+  if (boilerplate == NULL) {
+    res = Add(new HIRAllocateArray(stmt->children()->length()));
+  } else {
+    HIRInstruction* literal = Add(new HIRLiteral(stmt->type(), boilerplate));
+    res = Add(new HIRCloneLiteral(true))->AddArg(literal);
+  }
 
   AstList::Item* head = stmt->children()->head();
   for (uint64_t i = 0; head != NULL; head = head->next(), i++) {
+    // Constant values are already in the boilerplate
+    if (boilerplate != NULL && Root::IsConstant(head->value())) continue;
+
     HIRInstruction* key = GetNumber(i);
     HIRInstruction* value = Visit(head->value());
 
@@ -1089,6 +1181,89 @@ HIRInstruction* HIRGen::VisitDelete(AstNode* stmt) {
 }
 
 
+HIRInstruction* HIRGen::VisitMath(MathOp::MathOpType type,
+                                  FunctionLiteral* fn) {
+  HIRInstruction* res = new HIRMath(type);
+
+  // Missing arguments are nil
+  AstList::Item* item = fn->args()->head();
+  for (int i = 0; i < MathOp::argc(type); i++) {
+    if (item != NULL) {
+      res->AddArg(Visit(item->value()));
+      item = item->next();
+    } else {
+      res->AddArg(Add(new HIRNil()));
+    }
+  }
+
+  // Extra arguments are evaluated only for side effects
+  for (; item != NULL; item = item->next()) Visit(item->value());
+
+  return Add(res)->Unpin();
+}
+
+
+HIRInstruction* HIRGen::VisitModuleMath(MathOp::MathOpType type,
+                                        FunctionLiteral* fn) {
+  // Arguments are evaluated before callee, like in any other call
+  HIRInstructionList args;
+  AstList::Item* item = fn->args()->head();
+  for (; item != NULL; item = item->next()) args.Push(Visit(item->value()));
+
+  HIRInstruction* var = Visit(fn->variable());
+  HIRInstruction* check = Add(new HIRMathCheck(type))->Unpin()->AddArg(var);
+
+  ScopeSlot* slot = current_block()->env()->logic_slot();
+  HIRBlock* branch = CreateBlock();
+  Goto(branch);
+  set_current_block(branch);
+
+  HIRBlock* t = CreateBlock();
+  HIRBlock* f = CreateBlock();
+  Branch(new HIRIf(), t, f)->AddArg(check);
+
+  // Library's function is inlined, missing arguments are nil
+  set_current_block(t);
+  HIRInstruction* res = new HIRMath(type);
+  HIRInstructionList::Item* ahead = args.head();
+  for (int i = 0; i < MathOp::argc(type); i++) {
+    if (ahead != NULL) {
+      res->AddArg(ahead->value());
+      ahead = ahead->next();
+    } else {
+      res->AddArg(Add(new HIRNil()));
+    }
+  }
+  Assign(slot, Add(res)->Unpin());
+  t = current_block();
+
+  // Anything else is called
+  set_current_block(f);
+  HIRInstruction* hargc = GetNumber(args.length());
+  HIRInstructionList stores;
+  HIRInstructionList::Item* atail = args.tail();
+  for (int i = args.length() - 1; atail != NULL; atail = atail->prev(), i--) {
+    HIRInstruction* store = new HIRStoreArg();
+    store->AddArg(atail->value())->AddArg(GetNumber(i));
+    stores.Push(store);
+  }
+
+  Add(new HIRAlignStack())->AddArg(hargc);
+  HIRInstructionList::Item* shead = stores.head();
+  for (; shead != NULL; shead = shead->next()) Add(shead->value());
+
+  Assign(slot, Add(new HIRCall())->AddArg(var)->AddArg(hargc));
+  f = current_block();
+
+  set_current_block(Join(t, f));
+  HIRPhi* phi = current_block()->env()->PhiAt(slot);
+  assert(phi != NULL);
+  ClearLogicSlot();
+
+  return phi;
+}
+
+
 HIRInstruction* HIRGen::VisitCall(AstNode* stmt) {
   FunctionLiteral* fn = FunctionLiteral::Cast(stmt);
 
@@ -1104,6 +1279,12 @@ HIRInstruction* HIRGen::VisitCall(AstNode* stmt) {
     }
   }
 
+  // Math intrinsics
+  MathOp::MathOpType math = MathOp::ConvertCall(fn);
+  if (math != MathOp::kNone) return VisitMath(math, fn);
+  math = MathOp::ConvertModuleCall(fn);
+  if (math != MathOp::kNone) return VisitModuleMath(math, fn);
+
   // Generate all arg's values and populate list of stores
   HIRInstruction* vararg = NULL;
   HIRInstructionList stores_;
@@ -207,6 +207,18 @@ class HIRGen : public Visitor<HIRInstruction> {
 
   void Replace(HIRInstruction* o, HIRInstruction* n);
 
+  // Lowers `typeof value == "type"` to HIRTypeCheck,
+  // returns NULL if binop doesn't look like that
+  HIRInstruction* FuseTypeof(BinOp* op);
+
+  // Lowers `__$floor(x)` and other math intrinsics to HIRMath
+  HIRInstruction* VisitMath(MathOp::MathOpType type, FunctionLiteral* fn);
+
+  // Lowers `global.math.floor(x)` to HIRMath guarded by HIRMathCheck,
+  // calls the function if it isn't library's one
+  HIRInstruction* VisitModuleMath(MathOp::MathOpType type,
+                                  FunctionLiteral* fn);
+
   HIRInstruction* Visit(AstNode* stmt);
   HIRInstruction* VisitFunction(AstNode* stmt);
   HIRInstruction* VisitAssign(AstNode* stmt);
@@ -258,6 +270,10 @@ class HIRGen : public Visitor<HIRInstruction> {
   inline HIRInstruction* Assign(ScopeSlot* slot, HIRInstruction* value);
   inline HIRInstruction* GetNumber(uint64_t i);
 
+  // Value in logic slot is used only by the phi of expression's join,
+  // it shouldn't be merged into phis of enclosing loops
+  inline void ClearLogicSlot();
+
   inline HIRBlock* CreateBlock(int stack_slots);
   inline HIRBlock* CreateBlock();
 
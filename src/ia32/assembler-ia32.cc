@@ -97,6 +97,13 @@ void Assembler::cpuid() {
 }
 
 
+void Assembler::xgetbv() {
+  emitb(0x0F);
+  emitb(0x01);
+  emitb(0xD0);
+}
+
+
 void Assembler::push(Register src) {
   emitb(0x50 | src.low());
 }
@@ -535,6 +542,14 @@ void Assembler::divld(DoubleRegister dst, DoubleRegister src) {
 }
 
 
+void Assembler::sqrtld(DoubleRegister dst, DoubleRegister src) {
+  emitb(0xF2);
+  emitb(0x0F);
+  emitb(0x51);
+  emit_modrm(dst, src);
+}
+
+
 void Assembler::xorld(DoubleRegister dst, DoubleRegister src) {
   emitb(0x66);
   emitb(0x0F);
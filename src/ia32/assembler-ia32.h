@@ -281,6 +281,7 @@ class Assembler {
   // Instructions
   void nop();
   void cpuid();
+  void xgetbv();
 
   void push(Register src);
   void push(const Operand& src);
@@ -356,6 +357,7 @@ class Assembler {
   void subld(DoubleRegister dst, DoubleRegister src);
   void mulld(DoubleRegister dst, DoubleRegister src);
   void divld(DoubleRegister dst, DoubleRegister src);
+  void sqrtld(DoubleRegister dst, DoubleRegister src);
   void xorld(DoubleRegister dst, DoubleRegister src);
   void cvtsi2sd(DoubleRegister dst, Register src);
   void cvtsd2si(Register dst, DoubleRegister src);
@@ -69,7 +69,8 @@ void FEntry::Generate(Masm* masm) {
   __ mov(argc, eax);
 
   // Allocate context slots
-  __ AllocateContext(context_slots_);
+  // (functions without them are running in their parent's context)
+  if (context_slots_ != 0) __ AllocateContext(context_slots_);
 }
 
 
@@ -177,14 +178,25 @@ void FLoadContext::Generate(Masm* masm) {
 
 
 void FStoreProperty::Generate(Masm* masm) {
-  Label done;
+  Label miss, done;
   __ mov(eax, *inputs[0]->ToOperand());
   __ mov(ebx, *inputs[1]->ToOperand());
 
   // eax <- object
   // ebx <- propery
-  // ecx <- value
-  __ mov(ecx, Immediate(1));
+  // ecx <- change flag, stores of non-nil values keep array's length exact
+  __ mov(ecx, *inputs[2]->ToOperand());
+  {
+    Label store_nil, flag_set;
+
+    __ IsNil(ecx, NULL, &store_nil);
+    __ mov(ecx, Immediate(HArray::kInsertNonNil));
+    __ jmp(&flag_set);
+    __ bind(&store_nil);
+    __ mov(ecx, Immediate(1));
+    __ bind(&flag_set);
+  }
+
   __ Call(masm->stubs()->GetLookupPropertyStub());
 
   // Make eax look like unboxed number to GC
@@ -192,7 +204,7 @@ void FStoreProperty::Generate(Masm* masm) {
   __ CheckGC();
   __ inc(eax);
 
-  __ IsNil(eax, NULL, &done);
+  __ IsNil(eax, NULL, &miss);
   __ mov(ebx, *inputs[0]->ToOperand());
   __ mov(ecx, *inputs[2]->ToOperand());
   Operand qmap(ebx, HObject::kMapOffset);
@@ -201,13 +213,24 @@ void FStoreProperty::Generate(Masm* masm) {
 
   Operand slot(eax, 0);
   __ mov(slot, ecx);
+  __ jmp(&done);
+
+  // Typed cdata has no map, lookup returns nil for it
+  __ bind(&miss);
+  __ mov(eax, *inputs[0]->ToOperand());
+  __ IsUnboxed(eax, NULL, &done);
+  __ IsNil(eax, NULL, &done);
+  __ IsHeapObject(Heap::kTagCData, eax, &done, NULL);
+  __ mov(ebx, *inputs[1]->ToOperand());
+  __ mov(ecx, *inputs[2]->ToOperand());
+  __ Call(masm->stubs()->GetStoreElementStub());
 
   __ bind(&done);
 }
 
 
 void FLoadProperty::Generate(Masm* masm) {
-  Label done;
+  Label miss, done;
   __ mov(eax, *inputs[0]->ToOperand());
   __ mov(ebx, *inputs[1]->ToOperand());
 
@@ -216,7 +239,7 @@ void FLoadProperty::Generate(Masm* masm) {
   __ mov(ecx, Immediate(0));
   __ Call(masm->stubs()->GetLookupPropertyStub());
 
-  __ IsNil(eax, NULL, &done);
+  __ IsNil(eax, NULL, &miss);
   __ mov(ebx, *inputs[0]->ToOperand());
   Operand qmap(ebx, HObject::kMapOffset);
   __ mov(ebx, qmap);
@@ -224,6 +247,17 @@ void FLoadProperty::Generate(Masm* masm) {
 
   Operand slot(eax, 0);
   __ mov(eax, slot);
+  __ jmp(&done);
+
+  // Typed cdata has no map, lookup returns nil for it
+  __ bind(&miss);
+  __ mov(ebx, *inputs[0]->ToOperand());
+  __ IsUnboxed(ebx, NULL, &done);
+  __ IsNil(ebx, NULL, &done);
+  __ IsHeapObject(Heap::kTagCData, ebx, &done, NULL);
+  __ mov(eax, ebx);
+  __ mov(ebx, *inputs[1]->ToOperand());
+  __ Call(masm->stubs()->GetLoadElementStub());
 
   __ bind(&done);
   __ mov(*result->ToOperand(), eax);
@@ -372,6 +406,17 @@ void FBinOp::Generate(Masm* masm) {
 #undef BINARY_SUB_TYPES
 #undef BINARY_SUB_ENUM
 
+void FMath::Generate(Masm* masm) {
+  // eax <- lhs
+  // ebx <- rhs
+  __ mov(eax, *inputs[0]->ToOperand());
+  if (input_count_ > 1) __ mov(ebx, *inputs[1]->ToOperand());
+  __ Call(masm->stubs()->GetMathStub(sub_type_));
+  // result -> eax
+  __ mov(*result->ToOperand(), eax);
+}
+
+
 void FFunction::Generate(Masm* masm) {
   // Get function's body address from relocation info
   __ mov(scratch, Immediate(0));
@@ -398,6 +443,13 @@ void FClone::Generate(Masm* masm) {
 }
 
 
+void FCloneLiteral::Generate(Masm* masm) {
+  __ mov(eax, *inputs[0]->ToOperand());
+  __ Call(masm->stubs()->GetCloneLiteralStub());
+  __ mov(*result->ToOperand(), eax);
+}
+
+
 void FSizeof::Generate(Masm* masm) {
   __ mov(eax, *inputs[0]->ToOperand());
   __ Call(masm->stubs()->GetSizeofStub());
@@ -74,6 +74,16 @@ void LGen::VisitAllocateArray(HIRInstruction* instr) {
 }
 
 
+void LGen::VisitCloneLiteral(HIRInstruction* instr) {
+  LInterval* boilerplate = ToFixed(instr->left(), eax);
+  LInstruction* op = Bind(new LCloneLiteral())
+      ->MarkHasCall()
+      ->AddArg(boilerplate, LUse::kRegister);
+
+  ResultFromFixed(op, eax);
+}
+
+
 void LGen::VisitFunction(HIRInstruction* instr) {
   HIRFunction* fn = HIRFunction::Cast(instr);
 
@@ -119,6 +129,27 @@ void LGen::VisitBinOp(HIRInstruction* instr) {
 }
 
 
+void LGen::VisitMath(HIRInstruction* instr) {
+  bool binary = MathOp::argc(HIRMath::Cast(instr)->math_type()) == 2;
+  LInterval* lhs = ToFixed(instr->left(), eax);
+  LInterval* rhs = binary ? ToFixed(instr->right(), ebx) : NULL;
+  LInstruction* op = Bind(new LMath())
+      ->MarkHasCall()
+      ->AddArg(lhs, LUse::kRegister);
+  if (binary) op->AddArg(rhs, LUse::kRegister);
+
+  ResultFromFixed(op, eax);
+}
+
+
+void LGen::VisitMathCheck(HIRInstruction* instr) {
+  Bind(new LMathCheck())
+      ->AddScratch(CreateVirtual())
+      ->AddArg(instr->left(), LUse::kRegister)
+      ->SetResult(CreateVirtual(), LUse::kRegister);
+}
+
+
 void LGen::VisitSizeof(HIRInstruction* instr) {
   LInterval* lhs = ToFixed(instr->left(), eax);
   LInstruction* op = Bind(new LSizeof())
@@ -139,6 +170,20 @@ void LGen::VisitTypeof(HIRInstruction* instr) {
 }
 
 
+void LGen::VisitTypeCheck(HIRInstruction* instr) {
+  // Result is known at compile time, input isn't needed
+  if (HIRTypeCheck::Cast(instr)->KnownTag() != 0) {
+    Bind(new LTypeCheck())
+        ->SetResult(CreateVirtual(), LUse::kRegister);
+    return;
+  }
+
+  Bind(new LTypeCheck())
+      ->AddArg(instr->left(), LUse::kRegister)
+      ->SetResult(CreateVirtual(), LUse::kRegister);
+}
+
+
 void LGen::VisitKeysof(HIRInstruction* instr) {
   LInterval* lhs = ToFixed(instr->left(), eax);
   LInstruction* op = Bind(new LKeysof())
@@ -188,6 +233,8 @@ void LGen::VisitLoadProperty(HIRInstruction* instr) {
     load->SetMonomorphicProperty();
   }
 
+  if (!instr->right()->IsString()) load->SetElementAccess();
+
   ResultFromFixed(load, eax);
 }
 
@@ -205,6 +252,8 @@ void LGen::VisitStoreProperty(HIRInstruction* instr) {
   if (instr->right()->Is(HIRInstruction::kLiteral)) {
     store->SetMonomorphicProperty();
   }
+
+  if (!instr->right()->IsString()) store->SetElementAccess();
 }
 
 
@@ -296,6 +345,13 @@ void LGen::VisitIf(HIRInstruction* instr) {
     return;
   }
 
+  if (instr->left()->representation() ==
+      HIRInstruction::kBooleanRepresentation) {
+    Bind(new LBranchBoolean())
+        ->AddArg(instr->left(), LUse::kRegister);
+    return;
+  }
+
   LInterval* lhs = ToFixed(instr->left(), eax);
   assert(instr->block()->succ_count() == 2);
   Bind(new LBranch())
@@ -66,7 +66,8 @@ void LEntry::Generate(Masm* masm) {
   __ mov(argc, eax);
 
   // Allocate context slots
-  __ AllocateContext(context_slots_);
+  // (functions without them are running in their parent's context)
+  if (context_slots_ != 0) __ AllocateContext(context_slots_);
 }
 
 
@@ -195,8 +196,32 @@ void LBranchNumber::Generate(Masm* masm) {
 
 
 
+void LBranchBoolean::Generate(Masm* masm) {
+  // Value is definitely a boolean, no need to coerce it
+  __ IsTrue(inputs[0]->ToRegister(), TargetAt(1)->label, NULL);
+}
+
+
 void LLoadProperty::Generate(Masm* masm) {
   Label done;
+
+  // Typed cdata elements are loaded inline, without a map lookup
+  if (HasElementAccess()) {
+    Label property, slow;
+
+    __ IsUnboxed(eax, NULL, &property);
+    __ IsNil(eax, NULL, &property);
+    __ IsHeapObject(Heap::kTagCData, eax, &property, NULL);
+    __ LoadElement(&slow);
+    __ jmp(&done);
+
+    __ bind(&slow);
+    __ Call(masm->stubs()->GetLoadElementStub());
+    __ jmp(&done);
+
+    __ bind(&property);
+  }
+
   Masm::Spill eax_s(masm, eax);
 
   // eax <- object
@@ -223,13 +248,41 @@ void LLoadProperty::Generate(Masm* masm) {
 
 void LStoreProperty::Generate(Masm* masm) {
   Label done;
+
+  // Typed cdata elements are stored inline, without a map lookup
+  if (HasElementAccess()) {
+    Label property, slow;
+
+    __ IsUnboxed(eax, NULL, &property);
+    __ IsNil(eax, NULL, &property);
+    __ IsHeapObject(Heap::kTagCData, eax, &property, NULL);
+    __ StoreElement(&slow);
+    __ jmp(&done);
+
+    __ bind(&slow);
+    __ Call(masm->stubs()->GetStoreElementStub());
+    __ jmp(&done);
+
+    __ bind(&property);
+  }
+
   Masm::Spill eax_s(masm, eax);
   Masm::Spill ecx_s(masm, ecx);
 
   // eax <- object
   // ebx <- propery
-  // ecx <- value
-  __ mov(ecx, Immediate(1));
+  // ecx <- change flag, stores of non-nil values keep array's length exact
+  {
+    Label store_nil, flag_set;
+
+    __ IsNil(ecx, NULL, &store_nil);
+    __ mov(ecx, Immediate(HArray::kInsertNonNil));
+    __ jmp(&flag_set);
+    __ bind(&store_nil);
+    __ mov(ecx, Immediate(1));
+    __ bind(&flag_set);
+  }
+
   if (HasMonomorphicProperty()) {
     __ Call(masm->space()->CreatePIC());
   } else {
@@ -304,6 +357,14 @@ void LBinOp::Generate(Masm* masm) {
 }
 
 
+void LMath::Generate(Masm* masm) {
+  // eax <- lhs
+  // ebx <- rhs
+  __ Call(masm->stubs()->GetMathStub(HIRMath::Cast(hir())->math_type()));
+  // result -> eax
+}
+
+
 void LBinOpNumber::Generate(Masm* masm) {
   BinOp::BinOpType type = HIRBinOp::Cast(hir())->binop_type();
 
@@ -355,6 +416,12 @@ void LBinOpNumber::Generate(Masm* masm) {
   __ bind(&done);
 }
 
+
+void LBinOpDouble::Generate(Masm* masm) {
+  // Binops aren't fused on ia32
+  UNEXPECTED
+}
+
 #undef BINARY_SUB_ENUM
 #undef BINARY_SUB_TYPES
 
@@ -596,13 +663,104 @@ void LNot::Generate(Masm* masm) {
 }
 
 
+void LMathCheck::Generate(Masm* masm) {
+  MathOp::MathOpType type = HIRMathCheck::Cast(hir())->math_type();
+  Register value = inputs[0]->ToRegister();
+  Register scratch = scratches[0]->ToRegister();
+  Register res = result->ToRegister();
+  Operand true_value(root_reg, HContext::GetIndexDisp(Heap::kRootTrueIndex));
+  Operand false_value(root_reg,
+                      HContext::GetIndexDisp(Heap::kRootFalseIndex));
+  Label mismatch, done;
+
+  __ IsNil(value, NULL, &mismatch);
+  __ IsUnboxed(value, NULL, &mismatch);
+  __ IsHeapObject(Heap::kTagFunction, value, &mismatch, NULL);
+
+  // Bindings of `math` module are the only functions with this code
+  Operand code(value, HFunction::kCodeOffset);
+  __ mov(scratch, Immediate(reinterpret_cast<intptr_t>(
+      MathOp::BindingCode(type))));
+  __ cmpl(scratch, code);
+  __ jmp(kNe, &mismatch);
+
+  __ mov(res, true_value);
+  __ jmp(&done);
+
+  __ bind(&mismatch);
+  __ mov(res, false_value);
+
+  __ bind(&done);
+}
+
+
 void LTypeof::Generate(Masm* masm) {
   __ Call(masm->stubs()->GetTypeofStub());
 }
 
 
+void LTypeCheck::Generate(Masm* masm) {
+  HIRTypeCheck* check = HIRTypeCheck::Cast(hir());
+  Register res = result->ToRegister();
+  Operand true_value(root_reg, HContext::GetIndexDisp(Heap::kRootTrueIndex));
+  Operand false_value(root_reg,
+                      HContext::GetIndexDisp(Heap::kRootFalseIndex));
+  Operand* match = check->negate() ? &false_value : &true_value;
+  Operand* mismatch = check->negate() ? &true_value : &false_value;
+
+  // Type is known from representation
+  if (input_count() == 0) {
+    __ mov(res, check->KnownTag() == check->tag() ? *match : *mismatch);
+    return;
+  }
+
+  Register value = inputs[0]->ToRegister();
+  Label is_match, is_mismatch, done;
+
+  __ IsNil(value, NULL, check->tag() == Heap::kTagNil ? &is_match :
+                                                        &is_mismatch);
+  if (check->tag() != Heap::kTagNil) {
+    // Unboxed values are numbers
+    __ IsUnboxed(value,
+                 NULL,
+                 check->tag() == Heap::kTagNumber ? &is_match : &is_mismatch);
+    __ IsHeapObject(check->tag(), value, &is_mismatch, NULL);
+  } else {
+    __ jmp(&is_mismatch);
+  }
+
+  __ bind(&is_match);
+  __ mov(res, *match);
+  __ jmp(&done);
+
+  __ bind(&is_mismatch);
+  __ mov(res, *mismatch);
+
+  __ bind(&done);
+}
+
+
 void LSizeof::Generate(Masm* masm) {
+  Label call_stub, done;
+
+  // Fast case: length of array without trailing nils is a field load
+  __ IsUnboxed(eax, NULL, &call_stub);
+  __ IsNil(eax, NULL, &call_stub);
+  __ IsHeapObject(Heap::kTagArray, eax, &call_stub, NULL);
+
+  Operand qrepr(eax, HValue::kRepresentationOffset);
+  __ cmpb(qrepr, Immediate(HArray::kExactLength));
+  __ jmp(kNe, &call_stub);
+
+  Operand qlength(eax, HArray::kLengthOffset);
+  __ mov(eax, qlength);
+  __ TagNumber(eax);
+  __ jmp(&done);
+
+  __ bind(&call_stub);
   __ Call(masm->stubs()->GetSizeofStub());
+
+  __ bind(&done);
 }
 
 
@@ -616,6 +774,11 @@ void LClone::Generate(Masm* masm) {
 }
 
 
+void LCloneLiteral::Generate(Masm* masm) {
+  __ Call(masm->stubs()->GetCloneLiteralStub());
+}
+
+
 void LCollectGarbage::Generate(Masm* masm) {
   __ Call(masm->stubs()->GetCollectGarbageStub());
 }
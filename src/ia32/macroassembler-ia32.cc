@@ -242,13 +242,71 @@ void Masm::AllocateContext(uint32_t slots) {
 
 
 void Masm::AllocateNumber(DoubleRegister value, Register result) {
+  // Runtime allocation may clobber xmm registers, keep value on stack
+  // (GC can't happen inside allocation, so it won't see raw bits there)
+  Operand spill(scratch, 0);
+  sublb(esp, Immediate(16));
+  mov(scratch, esp);
+  movd(spill, value);
+
   Allocate(Heap::kTagNumber, reg_nil, HNumber::kDoubleSize, result);
 
+  mov(scratch, esp);
+  movd(value, spill);
+  xorl(scratch, scratch);
+  addlb(esp, Immediate(16));
+
   Operand qvalue(result, HNumber::kValueOffset);
   movd(qvalue, value);
 }
 
 
+void Masm::NumberFromDouble(DoubleRegister value,
+                            DoubleRegister tmp,
+                            Register result) {
+  Label box, done;
+
+  cvttsd2si(result, value);
+  xorld(tmp, tmp);
+  cvtsi2sd(tmp, result);
+  ucomisd(value, tmp);
+  jmp(kNe, &box);
+
+  // NaN and infinities are truncated to INT32_MIN and fail this check too
+  mov(scratch, result);
+  TagNumber(scratch);
+  Untag(scratch);
+  cmpl(scratch, result);
+  jmp(kNe, &box);
+
+  // Zero may be -0, which can't be represented by smi
+  cmpl(result, Immediate(0));
+  jmp(kEq, &box);
+
+  TagNumber(result);
+  jmp(&done);
+
+  bind(&box);
+  // Scratch is saved by Pushad, don't let GC see junk in it
+  xorl(scratch, scratch);
+  xorl(result, result);
+  AllocateNumber(value, result);
+
+  bind(&done);
+}
+
+
+// Typed elements are always accessed by runtime on ia32
+void Masm::LoadElement(Label* slow) {
+  jmp(slow);
+}
+
+
+void Masm::StoreElement(Label* slow) {
+  jmp(slow);
+}
+
+
 void Masm::AllocateObjectLiteral(Heap::HeapTag tag,
                                  Register tag_reg,
                                  Register size,
@@ -688,11 +746,25 @@ void Masm::ProbeCPU() {
   push(ebx);
   push(ecx);
   push(edx);
+  push(esi);
 
-  mov(eax, Immediate(0x01));
+  Operand leaf(ebp, 8);
+  Operand regs(ebp, 12);
+  mov(eax, leaf);
+  mov(esi, regs);
+  xorl(ecx, ecx);
   cpuid();
-  mov(eax, ecx);
 
+  Operand reax(esi, 0);
+  Operand rebx(esi, 4);
+  Operand recx(esi, 8);
+  Operand redx(esi, 12);
+  mov(reax, eax);
+  mov(rebx, ebx);
+  mov(recx, ecx);
+  mov(redx, edx);
+
+  pop(esi);
   pop(edx);
   pop(ecx);
   pop(ebx);
@@ -702,5 +774,24 @@ void Masm::ProbeCPU() {
   ret(0);
 }
 
+
+void Masm::ProbeXCR() {
+  push(ebp);
+  mov(ebp, esp);
+
+  push(ecx);
+  push(edx);
+
+  xorl(ecx, ecx);
+  xgetbv();
+
+  pop(edx);
+  pop(ecx);
+
+  mov(esp, ebp);
+  pop(ebp);
+  ret(0);
+}
+
 }  // namespace internal
 }  // namespace candor
@@ -59,6 +59,15 @@ void PIC::Generate(Masm* masm) {
     __ mov(edx, proto_op);
     __ cmpl(edx, Immediate(Heap::kICDisabledValue));
     __ jmp(kEq, &miss);
+
+    // Stores into shared map should go through runtime (it'll copy map)
+    Label own_map;
+    Operand repr_op(eax, HValue::kRepresentationOffset);
+    __ cmpl(ecx, Immediate(0));
+    __ jmp(kEq, &own_map);
+    __ cmpb(repr_op, Immediate(HObject::kOwnMap));
+    __ jmp(kNe, &miss);
+    __ bind(&own_map);
   }
 
   for (int i = size_ - 1; i >= 0; i--) {
@@ -69,6 +78,13 @@ void PIC::Generate(Masm* masm) {
           masm->offset() - 4));
     __ cmpl(edx, ebx);
     __ jmp(kNe, &local_miss);
+    if (stats_enabled_) {
+      // Count hit (eax and ebx are overwritten below)
+      __ mov(eax, Immediate(reinterpret_cast<uint32_t>(&hits_)));
+      __ mov(ebx, Operand(eax, 0));
+      __ inc(ebx);
+      __ mov(Operand(eax, 0), ebx);
+    }
     __ mov(eax, Immediate(results_[i]));
     __ xorl(ebx, ebx);
     __ mov(esp, ebp);
@@ -27,6 +27,7 @@
 #include "macroassembler.h"  // Masm
 #include "runtime.h"
 #include "pic.h"
+#include "runtime-stats.h"  // RuntimeStats
 
 namespace candor {
 namespace internal {
@@ -42,6 +43,21 @@ BaseStub::BaseStub(CodeSpace* space, StubType type) : space_(space),
 void BaseStub::GeneratePrologue() {
   __ push(ebp);
   __ mov(ebp, esp);
+
+  // Count invocations, preserving all registers
+  RuntimeStats* stats = space()->heap()->runtime_stats();
+  if (stats != NULL) {
+    intptr_t* counter = stats->stub_count(type());
+    __ push(eax);
+    __ push(ebx);
+    __ mov(eax, Immediate(reinterpret_cast<uint32_t>(counter)));
+    __ mov(ebx, Operand(eax, 0));
+    __ inc(ebx);
+    __ mov(Operand(eax, 0), ebx);
+    __ pop(ebx);
+    __ pop(eax);
+  }
+
   __ AllocateSpills();
 }
 
@@ -225,10 +241,11 @@ void AllocateStub::Generate() {
     __ Pushad();
 
     __ mov(scratch, size);
+    __ Untag(scratch);
     __ push(scratch);
     __ push(scratch);
 
-    // Two arguments: heap, size
+    // Two arguments: heap, size (untagged)
     __ push(scratch);
     __ push(heapref);
     __ mov(scratch, Immediate(*reinterpret_cast<intptr_t*>(&allocate)));
@@ -490,10 +507,27 @@ void LookupPropertyStub::Generate() {
 
   // Or into non-object
   __ IsHeapObject(Heap::kTagObject, eax, NULL, &is_object);
-  __ IsHeapObject(Heap::kTagArray, eax, &non_object_error, &is_array);
+  __ IsHeapObject(Heap::kTagArray, eax, NULL, &is_array);
+
+  // Maps and sets are handled by runtime
+  __ IsHeapObject(Heap::kTagHashMap, eax, NULL, &slow_case);
+  __ IsHeapObject(Heap::kTagHashSet, eax, &non_object_error, &slow_case);
 
   __ bind(&is_object);
 
+  // Stores into map shared with clone should copy it first
+  {
+    Label own_map;
+    Operand qrepr(eax, HValue::kRepresentationOffset);
+
+    __ cmpl(ecx, Immediate(0));
+    __ jmp(kEq, &own_map);
+    __ cmpb(qrepr, Immediate(HObject::kOwnMap));
+    __ jmp(kNe, &slow_case);
+
+    __ bind(&own_map);
+  }
+
   // Fast case: object and a string key
   {
     __ IsUnboxed(ebx, NULL, &slow_case);
@@ -590,18 +624,25 @@ void LookupPropertyStub::Generate() {
     // Apply mask
     __ andl(esi, edx);
 
-    // Check if length was increased
+    // Stores at or past the last element update length, it stays exact
+    // only if stored value is known to be non-nil
     Label length_set;
 
     Operand qlength(eax, HArray::kLengthOffset);
+    Operand qrepr(eax, HValue::kRepresentationOffset);
     __ mov(edx, qlength);
     __ Untag(ebx);
     __ inc(ebx);
     __ cmpl(ebx, edx);
-    __ jmp(kLe, &length_set);
+    __ jmp(kLt, &length_set);
+    __ cmpl(ecx, Immediate(0));
+    __ jmp(kEq, &length_set);
 
-    // Update length
     __ mov(qlength, ebx);
+    __ movb(qrepr, Immediate(HArray::kDirtyLength));
+    __ cmpl(ecx, Immediate(HArray::kInsertNonNil));
+    __ jmp(kNe, &length_set);
+    __ movb(qrepr, Immediate(HArray::kExactLength));
 
     __ bind(&length_set);
     // ebx is untagged here - so nullify it
@@ -660,6 +701,63 @@ void LookupPropertyStub::Generate() {
 }
 
 
+void LoadElementStub::Generate() {
+  GeneratePrologue();
+
+  // eax <- typed cdata
+  // ebx <- key
+  RuntimeLoadElementCallback loadc = &RuntimeLoadElement;
+
+  __ Pushad();
+
+  // RuntimeLoadElement(heap, cdata, key)
+  __ mov(edi, Immediate(reinterpret_cast<intptr_t>(masm()->heap())));
+  __ mov(esi, eax);
+  __ mov(edx, ebx);
+  __ mov(eax, Immediate(*reinterpret_cast<intptr_t*>(&loadc)));
+
+  __ push(esi);
+  __ push(edx);
+  __ push(esi);
+  __ push(edi);
+  __ call(eax);
+  __ addlb(esp, Immediate(4 * 4));
+
+  __ Popad(eax);
+
+  GenerateEpilogue(0);
+}
+
+
+void StoreElementStub::Generate() {
+  GeneratePrologue();
+
+  // eax <- typed cdata
+  // ebx <- key
+  // ecx <- value
+  RuntimeStoreElementCallback storec = &RuntimeStoreElement;
+
+  __ Pushad();
+
+  // RuntimeStoreElement(heap, cdata, key, value)
+  __ mov(edi, Immediate(reinterpret_cast<intptr_t>(masm()->heap())));
+  __ mov(esi, eax);
+  __ mov(edx, ebx);
+  __ mov(eax, Immediate(*reinterpret_cast<intptr_t*>(&storec)));
+
+  __ push(ecx);
+  __ push(edx);
+  __ push(esi);
+  __ push(edi);
+  __ call(eax);
+  __ addlb(esp, Immediate(4 * 4));
+
+  __ Popad(reg_nil);
+
+  GenerateEpilogue(0);
+}
+
+
 void PICMissStub::Generate() {
   GeneratePrologue();
 
@@ -758,66 +856,119 @@ void CloneObjectStub::Generate() {
   __ IsNil(eax, NULL, &non_object);
   __ IsHeapObject(Heap::kTagObject, eax, &non_object, NULL);
 
-  // Get map
+  // Allocate new object without a map (mask + map + proto)
+  __ Allocate(Heap::kTagObject, reg_nil, 3 * HValue::kPointerSize, edx);
+
+  // Clone points to the source's map, the first store into any of them
+  // will copy it (see RuntimeLookupProperty)
+  Operand qmask(eax, HObject::kMaskOffset);
   Operand qmap(eax, HObject::kMapOffset);
-  __ mov(eax, qmap);
+  Operand qrepr(eax, HValue::kRepresentationOffset);
+  Operand qmask_edx(edx, HObject::kMaskOffset);
+  Operand qmap_edx(edx, HObject::kMapOffset);
+  Operand qproto_edx(edx, HObject::kProtoOffset);
+  Operand qrepr_edx(edx, HValue::kRepresentationOffset);
 
-  // Get size
-  Operand qsize(eax, HMap::kSizeOffset);
-  __ mov(ecx, qsize);
+  __ mov(scratch, qmask);
+  __ mov(qmask_edx, scratch);
+  __ mov(scratch, qmap);
+  __ mov(qmap_edx, scratch);
 
-  __ TagNumber(ecx);
+  // Set proto
+  __ mov(qproto_edx, scratch);
+  __ xorl(scratch, scratch);
+
+  __ movb(qrepr, Immediate(HObject::kSharedMap));
+  __ movb(qrepr_edx, Immediate(HObject::kSharedMap));
+
+  __ mov(eax, edx);
+  __ xorl(edx, edx);
+
+  __ jmp(&done);
+  __ bind(&non_object);
+
+  __ mov(ecx, Immediate(HNumber::Tag(16)));
 
   // Allocate new object
-  __ AllocateObjectLiteral(Heap::kTagObject, reg_nil, ecx, edx);
+  __ AllocateObjectLiteral(Heap::kTagObject, reg_nil, ecx, eax);
 
-  __ mov(ebx, edx);
+  __ bind(&done);
 
-  // Get new object's map
-  Operand qmap_ebx(ebx, HObject::kMapOffset);
-  __ mov(ebx, qmap_ebx);
+  GenerateEpilogue();
+}
 
-  // Set proto
-  Operand qproto(edx, HObject::kProtoOffset);
-  __ mov(qproto, eax);
+
+void CloneLiteralStub::Generate() {
+  GeneratePrologue();
+
+  // eax <- boilerplate (object or array)
+  Operand qtag(eax, HValue::kTagOffset);
+  Operand qrepr(eax, HValue::kRepresentationOffset);
+  Operand qmap(eax, HObject::kMapOffset);
+  Operand qlength(eax, HArray::kLengthOffset);
+  Operand qrepr_edx(edx, HValue::kRepresentationOffset);
+  Operand qmap_edx(edx, HObject::kMapOffset);
+  Operand qproto_edx(edx, HObject::kProtoOffset);
+  Operand qlength_edx(edx, HArray::kLengthOffset);
+  Operand qsize(ebx, HMap::kSizeOffset);
+
+  // Allocate object of the same type with a map of the same size
+  __ mov(ebx, qmap);
+  __ mov(ecx, qsize);
+  __ TagNumber(ecx);
+  __ movzxb(ebx, qtag);
+  __ TagNumber(ebx);
+
+  __ AllocateObjectLiteral(Heap::kTagNil, ebx, ecx, edx);
+
+  Label is_array, copy;
+
+  __ mov(ebx, qmap);
+  __ IsHeapObject(Heap::kTagArray, eax, NULL, &is_array);
+
+  // All copies of boilerplate share its layout
+  __ mov(qproto_edx, ebx);
+  __ jmp(&copy);
+
+  __ bind(&is_array);
+  __ mov(ecx, qlength);
+  __ mov(qlength_edx, ecx);
+  __ movzxb(ecx, qrepr);
+  __ movb(qrepr_edx, ecx);
+
+  __ bind(&copy);
+
+  // Copy both keys and values
+  __ mov(ecx, qmap_edx);
+  __ mov(eax, qsize);
+  __ shl(eax, Immediate(1));
 
   // Skip headers
-  __ addlb(eax, Immediate(HMap::kSpaceOffset));
   __ addlb(ebx, Immediate(HMap::kSpaceOffset));
+  __ addlb(ecx, Immediate(HMap::kSpaceOffset));
 
-  // NOTE: ecx is tagged here
-
-  // Copy all fields from it
-  Label loop_start, loop_cond;
-  __ jmp(&loop_cond);
-  __ bind(&loop_start);
+  Label loop;
+  __ bind(&loop);
 
-  Operand from(eax, 0), to(ebx, 0);
+  Operand from(ebx, 0), to(ecx, 0);
   __ mov(scratch, from);
   __ mov(to, scratch);
 
   // Move forward
-  __ addlb(eax, Immediate(4));
-  __ addlb(ebx, Immediate(4));
+  __ addlb(ebx, Immediate(HValue::kPointerSize));
+  __ addlb(ecx, Immediate(HValue::kPointerSize));
 
-  __ dec(ecx);
-
-  // Loop
-  __ bind(&loop_cond);
-  __ cmpl(ecx, Immediate(0));
-  __ jmp(kNe, &loop_start);
+  __ dec(eax);
+  __ cmpl(eax, Immediate(0));
+  __ jmp(kNe, &loop);
 
   __ mov(eax, edx);
 
-  __ jmp(&done);
-  __ bind(&non_object);
-
-  __ mov(ecx, Immediate(HNumber::Tag(16)));
-
-  // Allocate new object
-  __ AllocateObjectLiteral(Heap::kTagObject, reg_nil, ecx, eax);
-
-  __ bind(&done);
+  // Cleanup interior pointers
+  __ xorl(scratch, scratch);
+  __ xorl(ebx, ebx);
+  __ xorl(ecx, ecx);
+  __ xorl(edx, edx);
 
   GenerateEpilogue();
 }
@@ -1102,7 +1253,8 @@ void BinOpStub::Generate() {
      default: __ emitb(0xcc); break;
     }
 
-    __ AllocateNumber(xmm1, eax);
+    // Return integral results unboxed, if they fit into smi
+    __ NumberFromDouble(xmm1, xmm2, eax);
   } else if (BinOp::is_binary(type())) {
     // Truncate lhs and rhs first
     __ cvttsd2si(eax, xmm1);
@@ -1217,6 +1369,207 @@ void BinOpStub::Generate() {
 
 #undef BINARY_SUB_TYPES
 
+
+#define MATH_SUB_TYPES(V)\
+    V(Floor)\
+    V(Ceil)\
+    V(Round)\
+    V(Sqrt)\
+    V(Abs)\
+    V(Min)\
+    V(Max)\
+    V(Pow)\
+    V(Exp)\
+    V(Log)\
+    V(Sin)\
+    V(Cos)\
+    V(Tan)
+
+void MathStub::Generate() {
+  GeneratePrologue();
+
+  Label call_runtime, done;
+  bool binary = MathOp::argc(type()) == 2;
+
+  // eax <- lhs
+  // ebx <- rhs (only for binary functions)
+  if (!binary) __ xorl(ebx, ebx);
+
+  // libm is always called for transcendental functions
+  if (!MathOp::is_transcendental(type())) {
+    Label lhs_boxed, both_unboxed, lhs_loaded;
+
+    __ IsNil(eax, NULL, &call_runtime);
+    __ IsUnboxed(eax, &lhs_boxed, NULL);
+    if (binary) {
+      __ IsNil(ebx, NULL, &call_runtime);
+      __ IsUnboxed(ebx, &lhs_boxed, &both_unboxed);
+    } else {
+      __ jmp(&both_unboxed);
+    }
+
+    // Fast case: smi arguments
+    __ bind(&both_unboxed);
+    switch (type()) {
+     case MathOp::kFloor:
+     case MathOp::kCeil:
+     case MathOp::kRound:
+      __ jmp(&done);
+      break;
+     case MathOp::kAbs:
+      __ cmpl(eax, Immediate(0));
+      __ jmp(kGe, &done);
+      __ subl(ebx, eax);
+      __ jmp(kOverflow, &call_runtime);
+      __ mov(eax, ebx);
+      __ jmp(&done);
+      break;
+     case MathOp::kMin:
+     case MathOp::kMax:
+      __ cmpl(eax, ebx);
+      __ jmp(type() == MathOp::kMin ? kLe : kGe, &done);
+      __ mov(eax, ebx);
+      __ jmp(&done);
+      break;
+     default:
+      // Compute in doubles
+      break;
+    }
+
+    // Load arguments into xmm1 and xmm2
+    __ bind(&lhs_boxed);
+
+    Operand lvalue(eax, HNumber::kValueOffset);
+    Operand rvalue(ebx, HNumber::kValueOffset);
+    Label lhs_heap, rhs_heap, rhs_loaded;
+
+    __ IsUnboxed(eax, &lhs_heap, NULL);
+    __ mov(scratch, eax);
+    __ Untag(scratch);
+    __ xorld(xmm1, xmm1);
+    __ cvtsi2sd(xmm1, scratch);
+    __ xorl(scratch, scratch);
+    __ jmp(&lhs_loaded);
+
+    __ bind(&lhs_heap);
+    __ IsHeapObject(Heap::kTagNumber, eax, &call_runtime, NULL);
+    __ movd(xmm1, lvalue);
+
+    __ bind(&lhs_loaded);
+    if (binary) {
+      __ IsUnboxed(ebx, &rhs_heap, NULL);
+      __ mov(scratch, ebx);
+      __ Untag(scratch);
+      __ xorld(xmm2, xmm2);
+      __ cvtsi2sd(xmm2, scratch);
+      __ xorl(scratch, scratch);
+      __ jmp(&rhs_loaded);
+
+      __ bind(&rhs_heap);
+      __ IsNil(ebx, NULL, &call_runtime);
+      __ IsHeapObject(Heap::kTagNumber, ebx, &call_runtime, NULL);
+      __ movd(xmm2, rvalue);
+
+      __ bind(&rhs_loaded);
+    }
+
+    switch (type()) {
+     case MathOp::kFloor:
+     case MathOp::kCeil:
+      // roundsd is a part of SSE4.1
+      if (!CPU::HasSSE4_1()) {
+        __ jmp(&call_runtime);
+        break;
+      }
+
+      __ roundsd(xmm1,
+                 xmm1,
+                 type() == MathOp::kCeil ? kRoundUp : kRoundDown);
+      break;
+     case MathOp::kRound:
+     case MathOp::kAbs:
+      // No cheap way to load constants or masks into xmm here
+      __ jmp(&call_runtime);
+      break;
+     case MathOp::kSqrt:
+      __ sqrtld(xmm1, xmm1);
+      break;
+     case MathOp::kMin:
+     case MathOp::kMax:
+      {
+        // Return one of arguments, unordered comparison keeps lhs
+        Label select_rhs;
+        if (type() == MathOp::kMin) {
+          __ ucomisd(xmm1, xmm2);
+        } else {
+          __ ucomisd(xmm2, xmm1);
+        }
+        __ jmp(kAbove, &select_rhs);
+        __ jmp(&done);
+        __ bind(&select_rhs);
+        __ mov(eax, ebx);
+        __ jmp(&done);
+      }
+      break;
+     default:
+      UNEXPECTED
+      break;
+    }
+
+    if (!MathOp::is_selection(type())) {
+      __ xorl(ebx, ebx);
+      __ NumberFromDouble(xmm1, xmm2, eax);
+      __ jmp(&done);
+    }
+  }
+
+  __ bind(&call_runtime);
+
+  RuntimeMathCallback cb;
+
+#define MATH_ENUM_CASES(V)\
+    case MathOp::k##V: cb = &RuntimeMath<MathOp::k##V>; break;
+
+  switch (type()) {
+    MATH_SUB_TYPES(MATH_ENUM_CASES)
+    default:
+      UNEXPECTED
+      break;
+  }
+#undef MATH_ENUM_CASES
+
+  __ Pushad();
+
+  Immediate heapref(reinterpret_cast<intptr_t>(masm()->heap()));
+
+  // math(heap, lhs, rhs)
+  __ mov(edi, heapref);
+  __ mov(esi, eax);
+  __ mov(edx, ebx);
+
+  __ push(edx);
+  __ push(edx);
+  __ push(esi);
+  __ push(edi);
+  __ mov(scratch, Immediate(*reinterpret_cast<intptr_t*>(&cb)));
+  __ call(scratch);
+  __ addlb(esp, Immediate(4 * 4));
+
+  __ Popad(eax);
+
+  __ bind(&done);
+
+  // Cleanup
+  __ xorl(edx, edx);
+  __ xorl(ebx, ebx);
+
+  __ CheckGC();
+
+  GenerateEpilogue();
+}
+
+#undef MATH_SUB_TYPES
+
 void LoadVarArgStub::Generate() {
   __ mov(edx, ebp);
   GeneratePrologue();
@@ -1225,13 +1578,9 @@ void LoadVarArgStub::Generate() {
   Register offset = eax;
   Register rest = ebx;
   Register arr = ecx;
-  Masm::Spill ebp_s(masm(), edx);
   Operand argc(edx, -HValue::kPointerSize * 2);
-  Operand qmap(arr, HObject::kMapOffset);
-  Operand slot(scratch, 0);
-  Operand stack_slot(offset, 0);
 
-  Label loop, preloop, end;
+  Label end;
 
   // Calculate length of vararg array
   __ mov(scratch, offset);
@@ -1241,69 +1590,38 @@ void LoadVarArgStub::Generate() {
   __ cmpl(scratch, argc);
   __ jmp(kGe, &end);
 
-  // edx = argc - offset - rest
-  __ mov(edx, argc);
-  __ subl(edx, scratch);
-
-  // Array index
-  __ mov(ebx, Immediate(HNumber::Tag(0)));
-
-  Masm::Spill arr_s(masm(), arr), edx_s(masm());
-  Masm::Spill offset_s(masm(), offset), ebx_s(masm());
+  // ebx = argc - offset - rest
+  __ mov(ebx, argc);
+  __ subl(ebx, scratch);
 
-  __ bind(&loop);
+  // edx = address of the first argument that goes into array
+  __ addlb(offset, Immediate(HNumber::Tag(2)));
+  __ shl(offset, Immediate(1));
+  __ addl(edx, offset);
 
-  // while (edx > 0)
-  __ cmpl(edx, Immediate(HNumber::Tag(0)));
-  __ jmp(kEq, &end);
+  Masm::Spill arr_s(masm(), arr);
 
-  edx_s.SpillReg(edx);
-  ebx_s.SpillReg(ebx);
+  __ Pushad();
 
-  __ mov(eax, arr);
+  RuntimeLoadVarArgCallback load = &RuntimeLoadVarArg;
 
-  // eax <- object
-  // ebx <- property
-  __ mov(ecx, Immediate(1));
-  __ Call(masm()->stubs()->GetLookupPropertyStub());
+  // RuntimeLoadVarArg(heap, arr, args, count)
+  __ mov(eax, Immediate(*reinterpret_cast<intptr_t*>(&load)));
+  __ push(ebx);
+  __ push(edx);
+  __ push(ecx);
+  __ push(Immediate(reinterpret_cast<intptr_t>(masm()->heap())));
+  __ call(eax);
+  __ addlb(esp, Immediate(4 * 4));
 
-  arr_s.Unspill();
-  ebx_s.Unspill();
+  __ Popad(reg_nil);
 
-  // Make eax look like unboxed number to GC
-  __ dec(eax);
+  // Array might have grown, stack pointers shouldn't be visible to GC
+  __ xorl(eax, eax);
+  __ xorl(edx, edx);
   __ CheckGC();
-  __ inc(eax);
-
-  __ IsNil(eax, NULL, &preloop);
-
-  __ mov(arr, qmap);
-  __ addl(eax, arr);
-  __ mov(scratch, eax);
-
-  // Get stack offset
-  offset_s.Unspill();
-  __ addlb(offset, Immediate(HNumber::Tag(2)));
-  __ addl(offset, ebx);
-  __ shl(offset, Immediate(1));
-  __ addl(offset, *ebp_s.GetOperand());
-  __ mov(offset, stack_slot);
-
-  // Put argument in array
-  __ mov(slot, offset);
-
   arr_s.Unspill();
 
-  __ bind(&preloop);
-
-  // Increment array index
-  __ addlb(ebx, Immediate(HNumber::Tag(1)));
-
-  // edx --
-  edx_s.Unspill();
-  __ sublb(edx, Immediate(HNumber::Tag(1)));
-  __ jmp(&loop);
-
   __ bind(&end);
 
   // Cleanup?
@@ -1320,107 +1638,33 @@ void StoreVarArgStub::Generate() {
   GeneratePrologue();
 
   Register varg = eax;
-  Register index = ebx;
-  Register map = ecx;
   Register stack = edx;
-  Operand stack_slot(stack, 0);
 
   // eax <- varg
-  Label loop, not_array, odd_end, r1_nil, r2_nil;
-  Masm::Spill index_s(masm()), map_s(masm()), array_s(masm()), r1(masm());
-  Masm::Spill stack_s(masm(), stack);
-  Operand slot(eax, 0);
+  Label not_array;
 
   __ IsUnboxed(varg, NULL, &not_array);
   __ IsNil(varg, NULL, &not_array);
   __ IsHeapObject(Heap::kTagArray, varg, &not_array, NULL);
 
-  Operand qmap(varg, HObject::kMapOffset);
-  __ mov(map, qmap);
-  map_s.SpillReg(map);
-
-  // index = sizeof(array)
-  Operand qlength(varg, HArray::kLengthOffset);
-  __ mov(index, qlength);
-  __ TagNumber(index);
-
-  // while ...
-  __ bind(&loop);
-
-  array_s.SpillReg(varg);
-
-  // while ... (index != 0) {
-  __ cmpl(index, Immediate(HNumber::Tag(0)));
-  __ jmp(kEq, &not_array);
-
-  // index--;
-  __ sublb(index, Immediate(HNumber::Tag(1)));
-
-  index_s.SpillReg(index);
-
-  // odd case: array[index]
-  __ mov(ebx, index);
-  __ mov(ecx, Immediate(0));
-  __ Call(masm()->stubs()->GetLookupPropertyStub());
-
-  __ IsNil(eax, NULL, &r1_nil);
-  map_s.Unspill();
-  __ addl(eax, map);
-  __ mov(eax, slot);
-
-  __ bind(&r1_nil);
-  r1.SpillReg(eax);
-
-  index_s.Unspill();
-
-  // if (index == 0) goto odd_end;
-  __ cmpl(index, Immediate(HNumber::Tag(0)));
-  __ jmp(kEq, &odd_end);
-
-  // index--;
-  __ sublb(index, Immediate(HNumber::Tag(1)));
-
-  array_s.Unspill();
-  index_s.SpillReg(index);
-
-  // even case: array[index]
-  __ mov(ebx, index);
-  __ mov(ecx, Immediate(0));
-  __ Call(masm()->stubs()->GetLookupPropertyStub());
-
-  __ IsNil(eax, NULL, &r2_nil);
-  map_s.Unspill();
-  __ addl(eax, map);
-  __ mov(eax, slot);
-
-  __ bind(&r2_nil);
-
-  // Push two item at the same time (to preserve alignment)
-  r1.Unspill(index);
-  stack_s.Unspill();
-  __ mov(stack_slot, index);
-  __ sublb(stack, Immediate(4));
-  __ mov(stack_slot, eax);
-  __ sublb(stack, Immediate(4));
-  stack_s.SpillReg(stack);
-
-  index_s.Unspill();
-  array_s.Unspill();
+  __ Pushad();
 
-  __ jmp(&loop);
+  RuntimeStoreVarArgCallback store = &RuntimeStoreVarArg;
 
-  // }
-  __ bind(&odd_end);
+  // RuntimeStoreVarArg(heap, varg, stack)
+  __ mov(ecx, Immediate(*reinterpret_cast<intptr_t*>(&store)));
+  __ push(Immediate(0));  // alignment
+  __ push(edx);
+  __ push(eax);
+  __ push(Immediate(reinterpret_cast<intptr_t>(masm()->heap())));
+  __ call(ecx);
+  __ addlb(esp, Immediate(4 * 4));
 
-  r1.Unspill(eax);
-  stack_s.Unspill();
-  __ mov(stack_slot, eax);
-  __ sublb(stack, Immediate(4));
-  stack_s.SpillReg(stack);
+  __ Popad(reg_nil);
 
   __ bind(&not_array);
 
-  __ xorl(map, map);
+  __ xorl(stack, stack);
   GenerateEpilogue();
 }
 
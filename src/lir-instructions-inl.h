@@ -30,7 +30,7 @@ namespace internal {
 
 inline LInstruction* LInstruction::AddArg(LInterval* arg, LUse::Type use_type) {
   assert(arg != NULL);
-  assert(input_count_ < 2);
+  assert(input_count_ < 6);
   inputs[input_count_++] = arg->Use(use_type, this);
 
   return this;
@@ -141,7 +141,8 @@ inline LLabel* LControlInstruction::TargetAt(int i) {
 inline LControlInstruction* LControlInstruction::Cast(LInstruction* instr) {
   assert(instr->type() == kGoto ||
          instr->type() == kBranch ||
-         instr->type() == kBranchNumber);
+         instr->type() == kBranchNumber ||
+         instr->type() == kBranchBoolean);
   return reinterpret_cast<LControlInstruction*>(instr);
 }
 
@@ -155,6 +156,53 @@ inline bool LAccessProperty::HasMonomorphicProperty() {
   return monomorphic_prop_;
 }
 
+
+inline void LAccessProperty::SetElementAccess() {
+  element_access_ = true;
+}
+
+
+inline bool LAccessProperty::HasElementAccess() {
+  return element_access_;
+}
+
+
+inline void LBinOpDouble::AddLeaf(int input) {
+  assert(length_ < 2 * kMaxArgs - 1);
+  nodes_[length_++] = input;
+}
+
+
+inline void LBinOpDouble::AddOp(BinOp::BinOpType type) {
+  assert(length_ < 2 * kMaxArgs - 1);
+  nodes_[length_++] = kMaxArgs + type;
+}
+
+
+inline bool LBinOpDouble::IsLeafAt(int i) {
+  return nodes_[i] < kMaxArgs;
+}
+
+
+inline int LBinOpDouble::LeafAt(int i) {
+  assert(IsLeafAt(i));
+  return nodes_[i];
+}
+
+
+inline BinOp::BinOpType LBinOpDouble::OpAt(int i) {
+  assert(!IsLeafAt(i));
+  return static_cast<BinOp::BinOpType>(nodes_[i] - kMaxArgs);
+}
+
+
+inline bool LBinOpDouble::HasOp(BinOp::BinOpType type) {
+  for (int i = 0; i < length_; i++) {
+    if (!IsLeafAt(i) && OpAt(i) == type) return true;
+  }
+  return false;
+}
+
 }  // namespace internal
 }  // namespace candor
 
@@ -56,10 +56,14 @@ typedef ZoneList<LInstruction*> LInstructionList;
     V(Not) \
     V(BinOp) \
     V(BinOpNumber) \
+    V(Math) \
+    V(MathCheck) \
     V(Typeof) \
+    V(TypeCheck) \
     V(Sizeof) \
     V(Keysof) \
     V(Clone) \
+    V(CloneLiteral) \
     V(Call) \
     V(CollectGarbage) \
     V(GetStackTrace) \
@@ -73,10 +77,12 @@ typedef ZoneList<LInstruction*> LInstructionList;
     V(Literal) \
     V(Branch) \
     V(BranchNumber) \
+    V(BranchBoolean) \
     V(LoadProperty) \
     V(StoreProperty) \
     V(AllocateObject) \
     V(AllocateArray) \
+    V(BinOpDouble) \
     V(Goto) \
     LIR_INSTRUCTION_SIMPLE_TYPES(V)
 
@@ -101,6 +107,10 @@ class LInstruction : public ZoneObject {
                                      propagated_(NULL) {
     inputs[0] = NULL;
     inputs[1] = NULL;
+    inputs[2] = NULL;
+    inputs[3] = NULL;
+    inputs[4] = NULL;
+    inputs[5] = NULL;
     scratches[0] = NULL;
     scratches[1] = NULL;
 
@@ -148,7 +158,7 @@ class LInstruction : public ZoneObject {
   inline HIRInstruction* hir() { return hir_; }
   inline void hir(HIRInstruction* hir) { hir_ = hir; }
 
-  LUse* inputs[2];
+  LUse* inputs[6];
   LUse* scratches[2];
   LUse* result;
 
@@ -290,17 +300,31 @@ class LBranchNumber : public LControlInstruction {
   INSTRUCTION_METHODS(BranchNumber)
 };
 
+class LBranchBoolean : public LControlInstruction {
+ public:
+  LBranchBoolean() : LControlInstruction(kBranchBoolean) {
+  }
+
+  INSTRUCTION_METHODS(BranchBoolean)
+};
+
 class LAccessProperty : public LInstruction {
  public:
   explicit LAccessProperty(Type type) : LInstruction(type),
-                                        monomorphic_prop_(false) {
+                                        monomorphic_prop_(false),
+                                        element_access_(false) {
   }
 
   inline void SetMonomorphicProperty();
   inline bool HasMonomorphicProperty();
 
+  // Key may index typed cdata
+  inline void SetElementAccess();
+  inline bool HasElementAccess();
+
  protected:
   bool monomorphic_prop_;
+  bool element_access_;
   AbsoluteAddress proto_ic, value_offset_ic, invalidate_ic;
 };
 
@@ -372,6 +396,31 @@ class LAllocateArray : public LInstruction {
   int size_;
 };
 
+// Tree of fused arithmetic binops, computed on unboxed doubles
+class LBinOpDouble : public LInstruction {
+ public:
+  LBinOpDouble() : LInstruction(kBinOpDouble), length_(0) {
+  }
+
+  INSTRUCTION_METHODS(BinOpDouble)
+
+  // Tree is stored in postorder, leaves are instruction's inputs
+  inline void AddLeaf(int input);
+  inline void AddOp(BinOp::BinOpType type);
+
+  inline bool IsLeafAt(int i);
+  inline int LeafAt(int i);
+  inline BinOp::BinOpType OpAt(int i);
+  inline bool HasOp(BinOp::BinOpType type);
+  inline int length() { return length_; }
+
+  static const int kMaxArgs = 6;
+
+ private:
+  int nodes_[2 * kMaxArgs - 1];
+  int length_;
+};
+
 #define DEFAULT_INSTR_IMPLEMENTATION(V) \
   class L##V : public LInstruction { \
     public: \
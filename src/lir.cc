@@ -712,7 +712,8 @@ void LGen::ResolveDataFlow() {
       LInstruction* control = b->instructions()->tail()->value();
       assert(control->type() == LInstruction::kGoto ||
              control->type() == LInstruction::kBranch ||
-             control->type() == LInstruction::kBranchNumber);
+             control->type() == LInstruction::kBranchNumber ||
+             control->type() == LInstruction::kBranchBoolean);
 
       if (control->type() == LInstruction::kGoto &&
           bhead->next()->value()->lir() == succ) {
@@ -931,6 +932,71 @@ void LGen::ResultFromFixed(LInstruction* instr, Register reg) {
 }
 
 
+static bool IsDoubleMath(HIRInstruction* instr) {
+  if (!instr->Is(HIRInstruction::kBinOp)) return false;
+
+  switch (HIRBinOp::Cast(instr)->binop_type()) {
+   case BinOp::kAdd:
+    // Representation of `+` is a string if any side may be a string,
+    // skip only concatenations of known strings
+    return instr->left()->representation() !=
+               HIRInstruction::kStringRepresentation &&
+           instr->right()->representation() !=
+               HIRInstruction::kStringRepresentation;
+   case BinOp::kSub:
+   case BinOp::kMul:
+   case BinOp::kDiv:
+    return true;
+   default:
+    return false;
+  }
+}
+
+
+bool LGen::CanFuse(HIRInstruction* instr, HIRInstruction* use) {
+  return IsDoubleMath(instr) &&
+         IsDoubleMath(use) &&
+         instr->uses()->length() == 1 &&
+         instr->uses()->head()->value() == use &&
+         instr->block() == use->block();
+}
+
+
+bool LGen::IsFused(HIRInstruction* instr) {
+  if (instr->uses()->length() != 1) return false;
+
+  HIRInstruction* use = instr->uses()->head()->value();
+  if (!CanFuse(instr, use)) return false;
+
+  bool left;
+  bool right;
+  FusedLeaves(use, &left, &right);
+
+  return use->left() == instr ? left : right;
+}
+
+
+int LGen::FusedLeaves(HIRInstruction* instr, bool* left, bool* right) {
+  // Operands are fused greedily, left one first
+  int lcount = 1;
+  int rcount = 1;
+
+  if (CanFuse(instr->left(), instr)) {
+    int count = FusedLeaves(instr->left(), NULL, NULL);
+    if (count + rcount <= LBinOpDouble::kMaxArgs) lcount = count;
+  }
+  if (CanFuse(instr->right(), instr)) {
+    int count = FusedLeaves(instr->right(), NULL, NULL);
+    if (lcount + count <= LBinOpDouble::kMaxArgs) rcount = count;
+  }
+
+  if (left != NULL) *left = lcount > 1;
+  if (right != NULL) *right = rcount > 1;
+
+  return lcount + rcount;
+}
+
+
 LInterval* LGen::Split(LInterval* i, int pos) {
   // TODO(indutny): Find optimal split position here
   assert(!i->IsFixed());
@@ -45,6 +45,7 @@ class LInterval;
 class LInstruction;
 class LLabel;
 class LGap;
+class LBinOpDouble;
 class LRange;
 class LUse;
 class SourceMap;
@@ -250,6 +251,16 @@ class LGen : public ZoneObject {
 
   LInterval* ToFixed(HIRInstruction* instr, Register reg);
   void ResultFromFixed(LInstruction* instr, Register reg);
+
+  // Arithmetic binop used only by another one in the same block may be fused
+  // into it, the whole tree is then computed on unboxed doubles
+  bool CanFuse(HIRInstruction* instr, HIRInstruction* use);
+  bool IsFused(HIRInstruction* instr);
+  int FusedLeaves(HIRInstruction* instr, bool* left, bool* right);
+  int AddFusedArgs(LBinOpDouble* op,
+                   HIRInstruction* instr,
+                   LInterval** args,
+                   int count);
   LInterval* Split(LInterval* i, int pos);
   LGap* GetGap(int pos);
   void Spill(LInterval* interval);
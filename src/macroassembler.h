@@ -101,6 +101,20 @@ class Masm : public Assembler {
   // Allocate heap numbers
   void AllocateNumber(DoubleRegister value, Register result);
 
+  // Tag integral value if it fits into smi, allocate heap number otherwise
+  // (clobbers `tmp` and scratch)
+  void NumberFromDouble(DoubleRegister value,
+                        DoubleRegister tmp,
+                        Register result);
+
+  // Typed cdata element access, rax <- cdata, rbx <- key (and rcx <- value
+  // for stores), loaded value -> rax. Out-of-bounds loads return nil,
+  // out-of-bounds stores are ignored. Jumps to `slow` with registers intact
+  // if key isn't a smi, stored value isn't a number or loaded one doesn't
+  // fit into smi. Clobbers rcx, rdx, xmm1 and xmm2.
+  void LoadElement(Label* slow);
+  void StoreElement(Label* slow);
+
   // Allocate object&map
   void AllocateObjectLiteral(Heap::HeapTag tag,
                              Register tag_reg,
@@ -147,8 +161,13 @@ class Masm : public Assembler {
   void Call(const Operand& addr);
   void Call(char* stub);
   void CallFunction(Register fn);
+
+  // Generate `void (intptr_t leaf, uint32_t regs[4])` storing cpuid's output
   void ProbeCPU();
 
+  // Generate `intptr_t ()` returning enabled OS state components (XCR0)
+  void ProbeXCR();
+
   enum BinOpUsage {
     kIntegral,
     kDouble
@@ -172,6 +191,9 @@ class Masm : public Assembler {
   }
 
  protected:
+  // rdx <- address of element at rbx minus HCData::kDataOffset (x64 only)
+  void TypedElementAddress(Label* out_of_bounds);
+
   CodeSpace* space_;
 
   int32_t align_;
@@ -0,0 +1,146 @@
+/**
+ * Copyright (c) 2012, Fedor Indutny.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "perf-counters.h"
+
+#include <string.h>  // memset
+#include <unistd.h>  // read, close
+
+#ifdef CANDOR_PLATFORM_LINUX
+#include <linux/perf_event.h>  // perf_event_attr
+#include <sys/syscall.h>  // __NR_perf_event_open
+#endif  // CANDOR_PLATFORM_LINUX
+
+namespace candor {
+namespace internal {
+
+PerfCounters::PerfCounters() : open_(false) {
+  for (int i = 0; i < kCounterCount; i++) {
+    fds_[i] = -1;
+    start_[i] = -1;
+  }
+  memset(phases_, 0, sizeof(phases_));
+}
+
+
+PerfCounters::~PerfCounters() {
+  for (int i = 0; i < kCounterCount; i++) {
+    if (fds_[i] != -1) close(fds_[i]);
+  }
+}
+
+
+#ifdef CANDOR_PLATFORM_LINUX
+
+static int OpenCounter(uint32_t type, uint64_t config) {
+  perf_event_attr attr;
+  memset(&attr, 0, sizeof(attr));
+  attr.size = sizeof(attr);
+  attr.type = type;
+  attr.config = config;
+
+  // Only count candor itself, perf_event_paranoid=2 allows that
+  attr.exclude_kernel = 1;
+  attr.exclude_hv = 1;
+
+  return syscall(__NR_perf_event_open, &attr, 0, -1, -1, 0);
+}
+
+
+static uint64_t CacheMiss(uint64_t cache) {
+  return cache |
+         (PERF_COUNT_HW_CACHE_OP_READ << 8) |
+         (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+}
+
+
+bool PerfCounters::Open() {
+  if (open_) return true;
+
+  fds_[kCycles] = OpenCounter(PERF_TYPE_HARDWARE,
+                              PERF_COUNT_HW_CPU_CYCLES);
+  fds_[kInstructions] = OpenCounter(PERF_TYPE_HARDWARE,
+                                    PERF_COUNT_HW_INSTRUCTIONS);
+  fds_[kBranchMisses] = OpenCounter(PERF_TYPE_HARDWARE,
+                                    PERF_COUNT_HW_BRANCH_MISSES);
+  fds_[kL1DMisses] = OpenCounter(PERF_TYPE_HW_CACHE,
+                                 CacheMiss(PERF_COUNT_HW_CACHE_L1D));
+  fds_[kLLCMisses] = OpenCounter(PERF_TYPE_HW_CACHE,
+                                 CacheMiss(PERF_COUNT_HW_CACHE_LL));
+  fds_[kDTLBMisses] = OpenCounter(PERF_TYPE_HW_CACHE,
+                                  CacheMiss(PERF_COUNT_HW_CACHE_DTLB));
+
+  for (int i = 0; i < kCounterCount; i++) {
+    if (fds_[i] != -1) open_ = true;
+  }
+  Read(start_);
+
+  return open_;
+}
+
+#else
+
+bool PerfCounters::Open() {
+  // Not supported on this platform
+  return false;
+}
+
+#endif  // CANDOR_PLATFORM_LINUX
+
+
+void PerfCounters::Read(int64_t values[kCounterCount]) {
+  for (int i = 0; i < kCounterCount; i++) {
+    uint64_t value;
+    if (fds_[i] == -1 ||
+        read(fds_[i], &value, sizeof(value)) != sizeof(value)) {
+      values[i] = -1;
+    } else {
+      values[i] = static_cast<int64_t>(value);
+    }
+  }
+}
+
+
+void PerfCounters::ReadTotal(int64_t values[kCounterCount]) {
+  Read(values);
+
+  for (int i = 0; i < kCounterCount; i++) {
+    if (values[i] != -1) values[i] -= start_[i];
+  }
+}
+
+
+void PerfCounters::Account(Phase phase, int64_t start[kCounterCount]) {
+  int64_t end[kCounterCount];
+  Read(end);
+
+  for (int i = 0; i < kCounterCount; i++) {
+    if (start[i] == -1 || end[i] == -1) {
+      phases_[phase][i] = -1;
+    } else if (phases_[phase][i] != -1) {
+      phases_[phase][i] += end[i] - start[i];
+    }
+  }
+}
+
+}  // namespace internal
+}  // namespace candor
@@ -0,0 +1,101 @@
+/**
+ * Copyright (c) 2012, Fedor Indutny.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef _SRC_PERF_COUNTERS_H_
+#define _SRC_PERF_COUNTERS_H_
+
+#include <stdint.h>  // int64_t
+#include <stdlib.h>  // NULL
+
+namespace candor {
+namespace internal {
+
+// Hardware performance counters (perf_event_open on Linux).
+// Counters are opened one by one, so a counter that isn't supported by the
+// CPU or kernel reports -1 while the rest keep working.
+class PerfCounters {
+ public:
+  enum Counter {
+    kCycles,
+    kInstructions,
+    kBranchMisses,
+    kL1DMisses,
+    kLLCMisses,
+    kDTLBMisses,
+    kCounterCount
+  };
+
+  // Phases that are accounted separately from the whole run
+  enum Phase {
+    kGC,
+    kCompile,
+    kPhaseCount
+  };
+
+  PerfCounters();
+  ~PerfCounters();
+
+  // Returns false if no counter could be opened
+  bool Open();
+  inline bool is_open() { return open_; }
+
+  // Current values of all counters (-1 for unavailable ones)
+  void Read(int64_t values[kCounterCount]);
+
+  // Counter values since Open()
+  void ReadTotal(int64_t values[kCounterCount]);
+
+  // Adds counter deltas since `start` snapshot to the phase
+  void Account(Phase phase, int64_t start[kCounterCount]);
+
+  inline int64_t* phase(Phase phase) { return phases_[phase]; }
+
+ private:
+  bool open_;
+  int fds_[kCounterCount];
+  int64_t start_[kCounterCount];
+  int64_t phases_[kPhaseCount][kCounterCount];
+};
+
+// Accounts counters spent inside C++ scope to the phase,
+// does nothing if counters are disabled.
+class PerfScope {
+ public:
+  PerfScope(PerfCounters* counters, PerfCounters::Phase phase)
+      : counters_(counters), phase_(phase) {
+    if (counters_ != NULL) counters_->Read(start_);
+  }
+
+  ~PerfScope() {
+    if (counters_ != NULL) counters_->Account(phase_, start_);
+  }
+
+ private:
+  PerfCounters* counters_;
+  PerfCounters::Phase phase_;
+  int64_t start_[PerfCounters::kCounterCount];
+};
+
+}  // namespace internal
+}  // namespace candor
+
+#endif  // _SRC_PERF_COUNTERS_H_
@@ -23,21 +23,34 @@
 #include "pic.h"
 
 #include <string.h>
+#include <stdio.h>  // fprintf, snprintf
+#include <stdlib.h>  // qsort
 
 #include "heap.h"  // HObject
 #include "heap-inl.h"
 #include "code-space.h"  // CodeSpace
+#include "source-map.h"  // SourceMap
 #include "stubs.h"  // Stubs
+#include "utils.h"  // GetSourceLineByOffset
 #include "zone.h"  // Zone
 
 namespace candor {
 namespace internal {
 
+bool PIC::stats_enabled_ = false;
+
 PIC::PIC(CodeSpace* space) : space_(space),
                              chunk_(NULL),
                              protos_(NULL),
                              results_(NULL),
-                             size_(0) {
+                             size_(0),
+                             megamorphic_(false),
+                             ip_(NULL),
+                             hits_(0),
+                             misses_(0),
+                             not_object_misses_(0),
+                             disabled_misses_(0),
+                             regenerations_(0) {
 }
 
 
@@ -54,9 +67,12 @@ char* PIC::Generate() {
 
   Generate(&masm);
 
-  if (chunk_ != NULL) chunk_->Unref();
+  // Miss is called from the code of the previous version, so it should
+  // survive code space collection performed by CreateChunk
+  CodeChunk* previous = chunk_;
   chunk_ = space_->CreateChunk("__pic__", "", 0);
   space_->Put(chunk_, &masm);
+  if (previous != NULL) previous->Unref();
 
   // At this stage protos_ and results_ should contain offsets,
   // get real addresses for them and reference protos in heap
@@ -79,8 +95,14 @@ void PIC::Miss(PIC* pic, char* object, intptr_t result, char* ip) {
 
 
 void PIC::Miss(char* object, intptr_t result, char* ip) {
+  if (ip_ == NULL) ip_ = ip;
+  misses_++;
+
   Heap::HeapTag tag = HValue::GetTag(object);
-  if (tag != Heap::kTagObject) return;
+  if (tag != Heap::kTagObject) {
+    not_object_misses_++;
+    return;
+  }
 
   char** call_ip = NULL;
   // Search for correct IP to replace
@@ -94,17 +116,20 @@ void PIC::Miss(char* object, intptr_t result, char* ip) {
 
   if (call_ip == NULL) return;
 
-  // Sign extend const
-  intptr_t disabled = ~Heap::kICDisabledValue;
-  disabled = ~disabled;
-
   char* proto = HValue::As<HObject>(object)->proto();
-  if ((reinterpret_cast<intptr_t>(proto) == disabled)) {
+  if (proto == HObject::ICDisabledProto()) {
+    disabled_misses_++;
     return;
   }
 
+  // Proto is already cached, store into the shared map has missed
+  for (int i = 0; i < size_; i++) {
+    if (protos_[i] == proto) return;
+  }
+
   // Patch call site and remove call to PIC
   if (size_ >= kMaxSize) {
+    megamorphic_ = true;
     *call_ip = space_->stubs()->GetLookupPropertyStub();
     return;
   }
@@ -128,10 +153,88 @@ void PIC::Miss(char* object, intptr_t result, char* ip) {
   }
 
   size_++;
+  regenerations_++;
 
   // Generate new PIC and replace previous one
   *call_ip = Generate();
 }
 
+
+const char* PIC::StateToString(State state) {
+  switch (state) {
+    case kUninitialized: return "uninitialized";
+    case kMonomorphic: return "monomorphic";
+    case kPolymorphic: return "polymorphic";
+    case kMegamorphic: return "megamorphic";
+    default: return NULL;
+  }
+}
+
+
+static int CompareSites(const void* a, const void* b) {
+  PIC* l = *reinterpret_cast<PIC* const*>(a);
+  PIC* r = *reinterpret_cast<PIC* const*>(b);
+
+  // Megamorphic sites call generic lookup directly and don't count anything,
+  // so put them first
+  bool lmega = l->state() == PIC::kMegamorphic;
+  bool rmega = r->state() == PIC::kMegamorphic;
+  if (lmega != rmega) return lmega ? -1 : 1;
+  if (l->misses() != r->misses()) return l->misses() > r->misses() ? -1 : 1;
+  if (l->hits() != r->hits()) return l->hits() > r->hits() ? -1 : 1;
+  return 0;
+}
+
+
+void PIC::PrintStats(CodeSpace* space) {
+  PIC** sites = new PIC*[space->pics()->length()];
+  int count = 0;
+
+  List<PIC*, EmptyClass>::Item* head = space->pics()->head();
+  for (; head != NULL; head = head->next()) {
+    if (head->value()->ip() != NULL) sites[count++] = head->value();
+  }
+
+  qsort(sites, count, sizeof(*sites), CompareSites);
+
+  fprintf(stderr, "%-32s %-16s %12s %10s %10s %11s %6s\n",
+          "site", "state", "hits", "misses", "non-object", "ic-disabled",
+          "regen");
+  for (int i = 0; i < count; i++) {
+    PIC* pic = sites[i];
+    char site[256];
+    char state[32];
+
+    // Call site lies after the start of the property access instruction,
+    // so the closest preceding source map entry describes it
+    SourceInfo* info = space->heap()->source_map()->Get(pic->ip());
+    if (info != NULL) {
+      int pos;
+      int line = GetSourceLineByOffset(info->source(), info->offset(), &pos);
+      snprintf(site, sizeof(site), "%s:%d:%d", info->filename(), line, pos);
+    } else {
+      snprintf(site, sizeof(site), "%p", pic->ip());
+    }
+
+    if (pic->state() == kPolymorphic) {
+      snprintf(state, sizeof(state), "%s/%d",
+               StateToString(pic->state()), pic->size());
+    } else {
+      snprintf(state, sizeof(state), "%s", StateToString(pic->state()));
+    }
+
+    fprintf(stderr, "%-32s %-16s %12lld %10lld %10lld %11lld %6lld\n",
+            site,
+            state,
+            static_cast<long long>(pic->hits()),
+            static_cast<long long>(pic->misses()),
+            static_cast<long long>(pic->not_object_misses()),
+            static_cast<long long>(pic->disabled_misses()),
+            static_cast<long long>(pic->regenerations()));
+  }
+
+  delete[] sites;
+}
+
 }  // namespace internal
 }  // namespace candor
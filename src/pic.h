@@ -41,12 +41,44 @@ class PIC {
                                intptr_t result,
                                char* ip);
 
+  enum State {
+    kUninitialized,
+    kMonomorphic,
+    kPolymorphic,
+    kMegamorphic
+  };
+
   explicit PIC(CodeSpace* space);
   ~PIC();
 
   char* Generate();
   static void Miss(PIC* pic, char* object, intptr_t result, char* ip);
 
+  // Hits are counted only if stats were enabled before compiling
+  static inline void EnableStats() { stats_enabled_ = true; }
+  static inline bool stats_enabled() { return stats_enabled_; }
+
+  // Prints every executed site of code space with its source position,
+  // megamorphic ones first and others sorted by number of misses, to stderr
+  static void PrintStats(CodeSpace* space);
+
+  inline State state() {
+    if (megamorphic_) return kMegamorphic;
+    if (size_ == 0) return kUninitialized;
+    return size_ == 1 ? kMonomorphic : kPolymorphic;
+  }
+
+  // Return address of the call site (NULL if PIC was never missed)
+  inline char* ip() { return ip_; }
+  inline intptr_t hits() { return hits_; }
+  inline intptr_t misses() { return misses_; }
+  inline intptr_t not_object_misses() { return not_object_misses_; }
+  inline intptr_t disabled_misses() { return disabled_misses_; }
+  inline intptr_t regenerations() { return regenerations_; }
+  inline int size() { return size_; }
+
+  static const char* StateToString(State state);
+
  protected:
   void Generate(Masm* masm);
 
@@ -60,6 +92,17 @@ class PIC {
   char** proto_offsets_[kMaxSize];
   intptr_t* results_;
   int size_;
+  bool megamorphic_;
+
+  char* ip_;
+  // Incremented from generated code, so pointer-sized
+  intptr_t hits_;
+  intptr_t misses_;
+  intptr_t not_object_misses_;
+  intptr_t disabled_misses_;
+  intptr_t regenerations_;
+
+  static bool stats_enabled_;
 };
 
 }  // namespace internal
@@ -25,6 +25,7 @@
 #include "ast.h"  // AstNode
 #include "heap.h"  // HContext
 #include "heap-inl.h"
+#include "runtime.h"  // RuntimeLookupProperty
 #include "utils.h"  // List
 
 namespace candor {
@@ -47,6 +48,8 @@ Root::Root(Heap* heap) : heap_(heap) {
   values()->Push(heap->CreateString("array", 5));
   values()->Push(heap->CreateString("function", 8));
   values()->Push(heap->CreateString("cdata", 5));
+  values()->Push(heap->CreateString("map", 3));
+  values()->Push(heap->CreateString("set", 3));
 }
 
 
@@ -130,6 +133,97 @@ char* Root::StringToValue(AstNode* node) {
 }
 
 
+ScopeSlot* Root::PutBoilerplate(AstNode* node) {
+  char* result;
+
+  if (node->is(AstNode::kObjectLiteral)) {
+    ObjectLiteral* obj = ObjectLiteral::Cast(node);
+    int count = obj->keys()->length();
+    if (count == 0) return NULL;
+
+    result = HObject::NewEmpty(heap(), HObject::LiteralSize(count));
+
+    AstList::Item* khead = obj->keys()->head();
+    AstList::Item* vhead = obj->values()->head();
+    for (; khead != NULL; khead = khead->next(), vhead = vhead->next()) {
+      char* key = ConstantToValue(khead->value());
+
+      // Result of duplicate keys depends on the order of stores.
+      // NOTE: Lookup without insertion returns an empty slot for missing key,
+      // so look at the key stored in it.
+      intptr_t offset = RuntimeLookupProperty(heap(), result, key, 0);
+      if (offset != Heap::kTagNil) {
+        char* key_slot = *reinterpret_cast<char**>(HObject::Map(result) +
+                                                   offset -
+                                                   HObject::Mask(result) -
+                                                   HValue::kPointerSize);
+        if (key_slot != HNil::New()) return NULL;
+      }
+
+      *HObject::LookupProperty(heap(), result, key, 1) =
+          IsConstant(vhead->value()) ?
+              ConstantToValue(vhead->value()) : HNil::New();
+    }
+  } else {
+    assert(node->is(AstNode::kArrayLiteral));
+    int count = node->children()->length();
+    if (count == 0) return NULL;
+
+    result = HArray::NewEmpty(heap(), HArray::LiteralSize(count));
+
+    AstList::Item* head = node->children()->head();
+    for (int64_t i = 0; head != NULL; head = head->next(), i++) {
+      *HObject::LookupProperty(heap(), result, HNumber::ToPointer(i), 1) =
+          IsConstant(head->value()) ?
+              ConstantToValue(head->value()) : HNil::New();
+    }
+
+    // Clones should start with exact length, placeholders are filled later
+    HArray::Length(result, true);
+  }
+
+  return GetSlot(result);
+}
+
+
+bool Root::IsConstant(AstNode* node) {
+  switch (node->type()) {
+    case AstNode::kNumber:
+    case AstNode::kString:
+    case AstNode::kTrue:
+    case AstNode::kFalse:
+    case AstNode::kNil:
+      return true;
+    default:
+      return false;
+  }
+}
+
+
+char* Root::ConstantToValue(AstNode* node) {
+  switch (node->type()) {
+    case AstNode::kNumber:
+      {
+        ScopeSlot* slot = NULL;
+        char* value = NumberToValue(node, &slot);
+        return slot == NULL ? value : slot->value();
+      }
+    case AstNode::kProperty:
+    case AstNode::kString:
+      return StringToValue(node);
+    case AstNode::kTrue:
+      return heap()->CreateBoolean(true);
+    case AstNode::kFalse:
+      return heap()->CreateBoolean(false);
+    case AstNode::kNil:
+      return HNil::New();
+    default:
+      UNEXPECTED
+      return NULL;
+  }
+}
+
+
 HContext* Root::Allocate() {
   return HValue::As<HContext>(HContext::New(heap(), values()));
 }
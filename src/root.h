@@ -42,6 +42,14 @@ class Root {
   explicit Root(Heap* heap);
 
   ScopeSlot* Put(AstNode* node);
+
+  // Object or array with keys of literal and its constant values in place
+  // (other values are nil), NULL if literal is empty or has duplicate keys
+  ScopeSlot* PutBoilerplate(AstNode* node);
+
+  // Values that are put into boilerplate and shouldn't be stored by code
+  static bool IsConstant(AstNode* node);
+
   HContext* Allocate();
 
   inline Heap* heap() { return heap_; }
@@ -50,6 +58,7 @@ class Root {
  private:
   char* NumberToValue(AstNode* node, ScopeSlot** slot);
   char* StringToValue(AstNode* node);
+  char* ConstantToValue(AstNode* node);
   ScopeSlot* GetSlot(char* value);
 
   Heap* heap_;
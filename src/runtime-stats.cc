@@ -0,0 +1,123 @@
+/**
+ * Copyright (c) 2012, Fedor Indutny.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "runtime-stats.h"
+#include "stubs.h"  // BaseStub
+
+#include <stdio.h>  // fprintf
+#include <stdlib.h>  // qsort
+#include <string.h>  // memset
+
+namespace candor {
+namespace internal {
+
+bool RuntimeStats::enabled_ = false;
+bool RuntimeStats::cycles_ = false;
+
+static const char* runtime_function_names[] = {
+#define RUNTIME_FUNCTION_NAME(V) "Runtime" #V,
+  RUNTIME_FUNCTIONS_LIST(RUNTIME_FUNCTION_NAME)
+#undef RUNTIME_FUNCTION_NAME
+};
+
+
+RuntimeStats::RuntimeStats() {
+  stub_counts_ = new intptr_t[BaseStub::kNone];
+  memset(stub_counts_, 0, sizeof(*stub_counts_) * BaseStub::kNone);
+  memset(runtime_counts_, 0, sizeof(runtime_counts_));
+  memset(runtime_cycles_, 0, sizeof(runtime_cycles_));
+}
+
+
+RuntimeStats::~RuntimeStats() {
+  delete[] stub_counts_;
+}
+
+
+struct RuntimeStatsEntry {
+  const char* name;
+  uint64_t count;
+  uint64_t cycles;
+  bool has_cycles;
+};
+
+
+static int CompareEntries(const void* a, const void* b) {
+  const RuntimeStatsEntry* l = reinterpret_cast<const RuntimeStatsEntry*>(a);
+  const RuntimeStatsEntry* r = reinterpret_cast<const RuntimeStatsEntry*>(b);
+
+  return l->count > r->count ? -1 : l->count < r->count ? 1 : 0;
+}
+
+
+void RuntimeStats::Print() {
+  RuntimeStatsEntry* entries =
+      new RuntimeStatsEntry[BaseStub::kNone + kRuntimeFunctionCount];
+  int count = 0;
+  uint64_t total = 0;
+
+  for (int i = 0; i < BaseStub::kNone; i++) {
+    if (stub_counts_[i] == 0) continue;
+
+    RuntimeStatsEntry* e = &entries[count++];
+    e->name = BaseStub::TypeToString(static_cast<BaseStub::StubType>(i));
+    e->count = stub_counts_[i];
+    e->cycles = 0;
+    e->has_cycles = false;
+    total += e->count;
+  }
+
+  for (int i = 0; i < kRuntimeFunctionCount; i++) {
+    if (runtime_counts_[i] == 0) continue;
+
+    RuntimeStatsEntry* e = &entries[count++];
+    e->name = runtime_function_names[i];
+    e->count = runtime_counts_[i];
+    e->cycles = runtime_cycles_[i];
+    e->has_cycles = has_cycles();
+    total += e->count;
+  }
+
+  qsort(entries, count, sizeof(*entries), CompareEntries);
+
+  fprintf(stderr, "%-28s %14s %7s %16s %12s\n",
+          "function", "calls", "%", "cycles", "cycles/call");
+  for (int i = 0; i < count; i++) {
+    RuntimeStatsEntry* e = &entries[i];
+    fprintf(stderr, "%-28s %14llu %6.2f%%",
+            e->name,
+            static_cast<unsigned long long>(e->count),
+            e->count * 100.0 / total);
+    if (e->has_cycles) {
+      fprintf(stderr, " %16llu %12.1f\n",
+              static_cast<unsigned long long>(e->cycles),
+              static_cast<double>(e->cycles) / e->count);
+    } else {
+      fprintf(stderr, " %16s %12s\n", "-", "-");
+    }
+  }
+
+  delete[] entries;
+}
+
+}  // namespace internal
+}  // namespace candor
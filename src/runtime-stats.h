@@ -0,0 +1,136 @@
+/**
+ * Copyright (c) 2012, Fedor Indutny.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef _SRC_RUNTIME_STATS_H_
+#define _SRC_RUNTIME_STATS_H_
+
+#include <stdint.h>  // uint64_t
+#include <stdlib.h>  // NULL
+#include "heap.h"  // Heap
+
+namespace candor {
+namespace internal {
+
+#define RUNTIME_FUNCTIONS_LIST(V)\
+    V(Allocate)\
+    V(CollectGarbage)\
+    V(GetHash)\
+    V(LookupProperty)\
+    V(GrowObject)\
+    V(LoadVarArg)\
+    V(StoreVarArg)\
+    V(ToString)\
+    V(ToNumber)\
+    V(ToBoolean)\
+    V(StrictCompare)\
+    V(StringCompare)\
+    V(ConcatenateStrings)\
+    V(CoerceType)\
+    V(BinOp)\
+    V(Math)\
+    V(Sizeof)\
+    V(Keysof)\
+    V(LoadElement)\
+    V(StoreElement)\
+    V(CloneObject)\
+    V(DeleteProperty)\
+    V(StackTrace)
+
+// Opt-in call counters for stubs and Runtime* functions.
+// Stubs increment their counter in prologue (see BaseStub::GeneratePrologue),
+// runtime functions use RuntimeStatsScope and may also accumulate TSC cycles
+// (including nested runtime calls).
+class RuntimeStats {
+ public:
+  enum RuntimeFunction {
+#define RUNTIME_FUNCTION_ENUM(V) k##V,
+    RUNTIME_FUNCTIONS_LIST(RUNTIME_FUNCTION_ENUM)
+#undef RUNTIME_FUNCTION_ENUM
+    kRuntimeFunctionCount
+  };
+
+  RuntimeStats();
+  ~RuntimeStats();
+
+  // Should be called before creating heap
+  static inline void Enable(bool cycles) {
+    enabled_ = true;
+    cycles_ = cycles;
+  }
+  static inline bool is_enabled() { return enabled_; }
+  static inline bool has_cycles() { return cycles_; }
+
+  // Prints table of non-zero counters sorted by call count
+  void Print();
+
+  inline intptr_t* stub_count(int stub) { return &stub_counts_[stub]; }
+  inline void Count(RuntimeFunction fn) { runtime_counts_[fn]++; }
+  inline uint64_t count(RuntimeFunction fn) { return runtime_counts_[fn]; }
+  inline void AddCycles(RuntimeFunction fn, uint64_t cycles) {
+    runtime_cycles_[fn] += cycles;
+  }
+
+  static inline uint64_t ReadTSC() {
+    uint32_t lo;
+    uint32_t hi;
+    __asm__ __volatile__("rdtsc" : "=a" (lo), "=d" (hi));
+    return (static_cast<uint64_t>(hi) << 32) | lo;
+  }
+
+ private:
+  // Incremented from generated code, so pointer-sized
+  intptr_t* stub_counts_;
+  uint64_t runtime_counts_[kRuntimeFunctionCount];
+  uint64_t runtime_cycles_[kRuntimeFunctionCount];
+
+  static bool enabled_;
+  static bool cycles_;
+};
+
+class RuntimeStatsScope {
+ public:
+  // NOTE: heap may be NULL for lookups that never allocate
+  // (see HArray::Length)
+  RuntimeStatsScope(Heap* heap, RuntimeStats::RuntimeFunction fn) :
+      stats_(heap == NULL ? NULL : heap->runtime_stats()),
+      fn_(fn),
+      start_(0) {
+    if (stats_ == NULL) return;
+    stats_->Count(fn_);
+    if (RuntimeStats::has_cycles()) start_ = RuntimeStats::ReadTSC();
+  }
+
+  ~RuntimeStatsScope() {
+    if (stats_ == NULL || !RuntimeStats::has_cycles()) return;
+    stats_->AddCycles(fn_, RuntimeStats::ReadTSC() - start_);
+  }
+
+ private:
+  RuntimeStats* stats_;
+  RuntimeStats::RuntimeFunction fn_;
+  uint64_t start_;
+};
+
+}  // namespace internal
+}  // namespace candor
+
+#endif  // _SRC_RUNTIME_STATS_H_
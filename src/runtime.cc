@@ -29,10 +29,13 @@
 #include <string.h>  // strncmp
 #include <stdio.h>  // snprintf
 #include <sys/types.h>  // size_t
+#include <math.h>  // floor, sqrt, pow and etc
 
 #include "heap.h"  // Heap
 #include "heap-inl.h"
 #include "utils.h"  // ComputeHash, etc
+#include "perf-counters.h"  // PerfScope
+#include "runtime-stats.h"  // RuntimeStatsScope
 
 namespace candor {
 namespace internal {
@@ -71,19 +74,48 @@ BINARY_SUB_TYPES(BINARY_OP_TEMPLATE)
 #undef BINARY_OP_TEMPLATE
 #undef BINARY_SUB_TYPES
 
+#define MATH_SUB_TYPES(V) \
+    V(Floor) \
+    V(Ceil) \
+    V(Round) \
+    V(Sqrt) \
+    V(Abs) \
+    V(Min) \
+    V(Max) \
+    V(Pow) \
+    V(Exp) \
+    V(Log) \
+    V(Sin) \
+    V(Cos) \
+    V(Tan)
+
+#define MATH_OP_TEMPLATE(V) \
+    template char* RuntimeMath<MathOp::k##V>(Heap* heap, \
+                                             char* lhs, \
+                                             char* rhs);
+
+MATH_SUB_TYPES(MATH_OP_TEMPLATE)
+
+#undef MATH_OP_TEMPLATE
+#undef MATH_SUB_TYPES
+
 char* RuntimeAllocate(Heap* heap,
                       uint32_t bytes) {
+  RuntimeStatsScope stats(heap, RuntimeStats::kAllocate);
   return heap->new_space()->Allocate(bytes);
 }
 
 
 void RuntimeCollectGarbage(Heap* heap, char* stack_top) {
+  RuntimeStatsScope stats(heap, RuntimeStats::kCollectGarbage);
+  PerfScope perf(heap->perf_counters(), PerfCounters::kGC);
   Zone gc_zone;
   heap->gc()->CollectGarbage(stack_top);
 }
 
 
 intptr_t RuntimeGetHash(Heap* heap, char* value) {
+  RuntimeStatsScope stats(heap, RuntimeStats::kGetHash);
   Heap::HeapTag tag = HValue::GetTag(value);
 
   switch (tag) {
@@ -93,6 +125,8 @@ intptr_t RuntimeGetHash(Heap* heap, char* value) {
     case Heap::kTagObject:
     case Heap::kTagArray:
     case Heap::kTagCData:
+    case Heap::kTagHashMap:
+    case Heap::kTagHashSet:
       return reinterpret_cast<intptr_t>(value);
     case Heap::kTagNil:
       return 0;
@@ -127,15 +161,26 @@ intptr_t RuntimeLookupProperty(Heap* heap,
                                char* obj,
                                char* key,
                                intptr_t insert) {
+  RuntimeStatsScope stats(heap, RuntimeStats::kLookupProperty);
   assert(!HValue::Cast(obj)->IsGCMarked());
   assert(!HValue::Cast(obj)->IsSoftGCMarked());
 
+  // Maps and sets keep their values at the same offset as objects do
+  if (HHashTable::IsHashTable(obj)) {
+    return HHashTable::Lookup(heap, obj, key, insert != 0);
+  }
+
+  bool is_array = HValue::GetTag(obj) == Heap::kTagArray;
+
+  // Map is going to be written, copy it if it's shared with a clone
+  if (insert && HObject::IsShared(obj)) {
+    HObject::Unshare(heap, obj);
+  }
+
   char* map = HObject::Map(obj);
   char* space = HValue::As<HMap>(map)->space();
   uint32_t mask = HObject::Mask(obj);
 
-  bool is_array = HValue::GetTag(obj) == Heap::kTagArray;
-
   char* keyptr = NULL;
   int64_t numkey = 0;
   uint32_t hash = 0;
@@ -148,9 +193,15 @@ intptr_t RuntimeLookupProperty(Heap* heap,
     // Negative lookups are prohibited
     if (numkey < 0) return Heap::kTagNil;
 
-    // Update array's length on insertion (if increased)
-    if (insert && HArray::Length(obj, false) <= numkey) {
+    // Update array's length on insertion at or past the last element, it
+    // stays exact only if stored value is known to be non-nil
+    if (insert && HArray::Length(obj, false) <= numkey + 1) {
       HArray::SetLength(obj, numkey + 1);
+      if (insert == HArray::kInsertNonNil) {
+        HArray::ValidateLength(obj);
+      } else {
+        HArray::InvalidateLength(obj);
+      }
     }
   } else {
     assert(HValue::GetTag(obj) == Heap::kTagObject);
@@ -194,6 +245,9 @@ intptr_t RuntimeLookupProperty(Heap* heap,
       index = index & mask;
     } while (index != start);
 
+    // All key slots are filled and none of them matches
+    if (needs_grow && !insert) return Heap::kTagNil;
+
     if (insert) {
       // All key slots are filled - rehash and lookup again
       if (needs_grow) {
@@ -204,8 +258,7 @@ intptr_t RuntimeLookupProperty(Heap* heap,
 
       if (key_slot == HNil::New()) {
         // Reset proto, IC could not work with this object anymore
-        char** proto_slot = HObject::ProtoSlot(obj);
-        *reinterpret_cast<intptr_t*>(proto_slot) = Heap::kICDisabledValue;
+        HObject::DisableIC(obj);
       }
 
       *reinterpret_cast<char**>(space + index) = keyptr;
@@ -217,6 +270,7 @@ intptr_t RuntimeLookupProperty(Heap* heap,
 
 
 char* RuntimeGrowObject(Heap* heap, char* obj, uint32_t min_size) {
+  RuntimeStatsScope stats(heap, RuntimeStats::kGrowObject);
   char** map_addr = HObject::MapSlot(obj);
   HMap* map = HValue::As<HMap>(*map_addr);
   uint32_t size = map->size() << 1;
@@ -225,11 +279,18 @@ char* RuntimeGrowObject(Heap* heap, char* obj, uint32_t min_size) {
     size = PowerOfTwo(min_size);
   }
 
+  // NOTE: Density should be checked before replacing map
+  bool is_array = HValue::GetTag(obj) == Heap::kTagArray;
+  bool is_dense = is_array && HArray::IsDense(obj);
+
   // Create a new map
   char* new_map = HMap::NewEmpty(heap, size);
 
-  // Replace old map with a new
+  // Replace old map with a new (it's not shared with anyone)
   *map_addr = new_map;
+  if (HObject::IsShared(obj)) {
+    HValue::SetRepresentation<HObject::Representation>(obj, HObject::kOwnMap);
+  }
 
   // Update mask
   uint32_t mask = (size - 1) * HValue::kPointerSize;
@@ -237,7 +298,7 @@ char* RuntimeGrowObject(Heap* heap, char* obj, uint32_t min_size) {
 
   // And rehash properties to new map
   uint32_t original_size = map->size();
-  if (HValue::GetTag(obj) == Heap::kTagArray && HArray::IsDense(obj)) {
+  if (is_dense) {
     // Dense array's map doesn't contain key pointers, iterate values
     original_size = original_size << 1;
     for (uint32_t i = 0; i < original_size; i++) {
@@ -262,7 +323,52 @@ char* RuntimeGrowObject(Heap* heap, char* obj, uint32_t min_size) {
 }
 
 
+char* RuntimeLoadVarArg(Heap* heap, char* arr, char** args, intptr_t count) {
+  RuntimeStatsScope stats(heap, RuntimeStats::kLoadVarArg);
+  int64_t length = HNumber::Untag(count);
+
+  // Grow array's map once, instead of doubling it while inserting
+  HArray::Reserve(heap, arr, length);
+
+  if (HArray::IsDense(arr)) {
+    // Dense array's values are stored by index, no lookup is needed
+    char** slots = reinterpret_cast<char**>(HObject::Map(arr) +
+                                            HMap::kSpaceOffset);
+    for (int64_t i = 0; i < length; i++) slots[i] = args[i];
+    HArray::SetLength(arr, length);
+    HArray::InvalidateLength(arr);
+  } else {
+    for (int64_t i = 0; i < length; i++) {
+      *HObject::LookupProperty(heap, arr, HNumber::ToPointer(i), 1) = args[i];
+    }
+  }
+
+  return arr;
+}
+
+
+void RuntimeStoreVarArg(Heap* heap, char* arr, char** stack) {
+  RuntimeStatsScope stats(heap, RuntimeStats::kStoreVarArg);
+  int64_t length = HArray::Length(arr, false);
+  char** args = stack - (length - 1);
+
+  if (HArray::IsDense(arr)) {
+    char** slots = reinterpret_cast<char**>(HObject::Map(arr) +
+                                            HMap::kSpaceOffset);
+    int64_t capacity = HObject::Mask(arr) / HValue::kPointerSize + 1;
+    for (int64_t i = 0; i < length; i++) {
+      args[i] = i < capacity ? slots[i] : HNil::New();
+    }
+  } else {
+    for (int64_t i = 0; i < length; i++) {
+      args[i] = *HObject::LookupProperty(heap, arr, HNumber::ToPointer(i), 0);
+    }
+  }
+}
+
+
 char* RuntimeToString(Heap* heap, char* value) {
+  RuntimeStatsScope stats(heap, RuntimeStats::kToString);
   Heap::HeapTag tag = HValue::GetTag(value);
 
   switch (tag) {
@@ -272,6 +378,8 @@ char* RuntimeToString(Heap* heap, char* value) {
     case Heap::kTagObject:
     case Heap::kTagArray:
     case Heap::kTagCData:
+    case Heap::kTagHashMap:
+    case Heap::kTagHashSet:
     case Heap::kTagNil:
       return HString::New(heap, Heap::kTenureNew, "", 0);
     case Heap::kTagBoolean:
@@ -306,6 +414,7 @@ char* RuntimeToString(Heap* heap, char* value) {
 
 
 char* RuntimeToNumber(Heap* heap, char* value) {
+  RuntimeStatsScope stats(heap, RuntimeStats::kToNumber);
   Heap::HeapTag tag = HValue::GetTag(value);
 
   switch (tag) {
@@ -315,7 +424,7 @@ char* RuntimeToNumber(Heap* heap, char* value) {
         uint32_t length = HString::Length(value);
         double value = StringToDouble(str, length);
 
-        return HNumber::New(heap, Heap::kTenureNew, value);
+        return HNumber::FromDouble(heap, Heap::kTenureNew, value);
       }
     case Heap::kTagBoolean:
       {
@@ -326,6 +435,8 @@ char* RuntimeToNumber(Heap* heap, char* value) {
     case Heap::kTagObject:
     case Heap::kTagArray:
     case Heap::kTagCData:
+    case Heap::kTagHashMap:
+    case Heap::kTagHashSet:
     case Heap::kTagNil:
       return HNumber::New(heap, Heap::kTenureNew, static_cast<int64_t>(0));
     case Heap::kTagNumber:
@@ -339,6 +450,7 @@ char* RuntimeToNumber(Heap* heap, char* value) {
 
 
 char* RuntimeToBoolean(Heap* heap, char* value) {
+  RuntimeStatsScope stats(heap, RuntimeStats::kToBoolean);
   Heap::HeapTag tag = HValue::GetTag(value);
 
   switch (tag) {
@@ -350,6 +462,8 @@ char* RuntimeToBoolean(Heap* heap, char* value) {
     case Heap::kTagObject:
     case Heap::kTagArray:
     case Heap::kTagCData:
+    case Heap::kTagHashMap:
+    case Heap::kTagHashSet:
       return HBoolean::New(heap, Heap::kTenureNew, true);
     case Heap::kTagNil:
       return HBoolean::New(heap, Heap::kTenureNew, false);
@@ -370,6 +484,7 @@ char* RuntimeToBoolean(Heap* heap, char* value) {
 
 
 intptr_t RuntimeStrictCompare(Heap* heap, char* lhs, char* rhs) {
+  RuntimeStatsScope stats(heap, RuntimeStats::kStrictCompare);
   // Fast case - pointers are equal
   if (lhs == rhs) return 0;
 
@@ -386,6 +501,8 @@ intptr_t RuntimeStrictCompare(Heap* heap, char* lhs, char* rhs) {
     case Heap::kTagObject:
     case Heap::kTagArray:
     case Heap::kTagCData:
+    case Heap::kTagHashMap:
+    case Heap::kTagHashSet:
     case Heap::kTagNil:
       return -1;
     case Heap::kTagBoolean:
@@ -401,6 +518,7 @@ intptr_t RuntimeStrictCompare(Heap* heap, char* lhs, char* rhs) {
 
 
 intptr_t RuntimeStringCompare(Heap* heap, char* lhs, char* rhs) {
+  RuntimeStatsScope stats(heap, RuntimeStats::kStringCompare);
   uint32_t lhs_length = HString::Length(lhs);
   uint32_t rhs_length = HString::Length(rhs);
 
@@ -415,6 +533,7 @@ intptr_t RuntimeStringCompare(Heap* heap, char* lhs, char* rhs) {
 char* RuntimeConcatenateStrings(Heap* heap,
                                 char* lhs,
                                 char* rhs) {
+  RuntimeStatsScope stats(heap, RuntimeStats::kConcatenateStrings);
   int32_t lhs_length = HString::Length(lhs);
   int32_t rhs_length = HString::Length(rhs);
 
@@ -442,6 +561,7 @@ Heap::HeapTag RuntimeCoerceType(Heap* heap,
                                 BinOp::BinOpType type,
                                 char* &lhs,
                                 char* &rhs) {
+  RuntimeStatsScope stats(heap, RuntimeStats::kCoerceType);
   Heap::HeapTag lhs_tag = HValue::GetTag(lhs);
   Heap::HeapTag rhs_tag = HValue::GetTag(rhs);
 
@@ -461,6 +581,8 @@ Heap::HeapTag RuntimeCoerceType(Heap* heap,
     case Heap::kTagObject:
     case Heap::kTagArray:
     case Heap::kTagCData:
+    case Heap::kTagHashMap:
+    case Heap::kTagHashSet:
       if (!BinOp::is_math(type) && !BinOp::is_binary(type)) {
         lhs = RuntimeToString(heap, lhs);
         rhs = RuntimeToString(heap, rhs);
@@ -480,6 +602,7 @@ Heap::HeapTag RuntimeCoerceType(Heap* heap,
 
 template <BinOp::BinOpType type>
 char* RuntimeBinOp(Heap* heap, char* lhs, char* rhs) {
+  RuntimeStatsScope stats(heap, RuntimeStats::kBinOp);
   // Fast case: both sides are nil
   if (lhs == HNil::New() && rhs == HNil::New()) {
     if (BinOp::is_math(type) || BinOp::is_binary(type)) {
@@ -528,6 +651,8 @@ char* RuntimeBinOp(Heap* heap, char* lhs, char* rhs) {
       case Heap::kTagObject:
       case Heap::kTagArray:
       case Heap::kTagCData:
+      case Heap::kTagHashMap:
+      case Heap::kTagHashSet:
         // object (+) object = false
         if (BinOp::is_strict_eq(type)) {
           result = lhs == rhs;
@@ -621,7 +746,7 @@ char* RuntimeBinOp(Heap* heap, char* lhs, char* rhs) {
         default: UNEXPECTED
       }
 
-      return HNumber::New(heap, Heap::kTenureNew, result);
+      return HNumber::FromDouble(heap, Heap::kTenureNew, result);
     } else if (BinOp::is_binary(type)) {
       int64_t result = 0;
 
@@ -655,7 +780,55 @@ char* RuntimeBinOp(Heap* heap, char* lhs, char* rhs) {
 }
 
 
+double RuntimeMathValue(MathOp::MathOpType type, double lhs, double rhs) {
+  switch (type) {
+    case MathOp::kFloor: return floor(lhs);
+    case MathOp::kCeil: return ceil(lhs);
+    case MathOp::kRound:
+      // Halves are rounded up, `floor(lhs + 0.5)` isn't precise
+      // for 0.49999999999999994 and loses sign of -0.5
+      return lhs - floor(lhs) >= 0.5 ? ceil(lhs) : floor(lhs);
+    case MathOp::kSqrt: return sqrt(lhs);
+    case MathOp::kAbs: return fabs(lhs);
+    case MathOp::kMin: return rhs < lhs ? rhs : lhs;
+    case MathOp::kMax: return rhs > lhs ? rhs : lhs;
+    case MathOp::kPow: return pow(lhs, rhs);
+    case MathOp::kExp: return exp(lhs);
+    case MathOp::kLog: return log(lhs);
+    case MathOp::kSin: return sin(lhs);
+    case MathOp::kCos: return cos(lhs);
+    case MathOp::kTan: return tan(lhs);
+    default: UNEXPECTED
+  }
+
+  return 0;
+}
+
+
+template <MathOp::MathOpType type>
+char* RuntimeMath(Heap* heap, char* lhs, char* rhs) {
+  RuntimeStatsScope stats(heap, RuntimeStats::kMath);
+
+  lhs = RuntimeToNumber(heap, lhs);
+  double lval = HNumber::DoubleValue(lhs);
+  double rval = 0;
+  if (MathOp::argc(type) == 2) {
+    rhs = RuntimeToNumber(heap, rhs);
+    rval = HNumber::DoubleValue(rhs);
+  }
+
+  // Return one of arguments without allocating
+  if (type == MathOp::kMin) return rval < lval ? rhs : lhs;
+  if (type == MathOp::kMax) return rval > lval ? rhs : lhs;
+
+  return HNumber::FromDouble(heap,
+                             Heap::kTenureNew,
+                             RuntimeMathValue(type, lval, rval));
+}
+
+
 char* RuntimeSizeof(Heap* heap, char* value) {
+  RuntimeStatsScope stats(heap, RuntimeStats::kSizeof);
   Heap::HeapTag tag = HValue::GetTag(value);
 
   int64_t size = 0;
@@ -664,7 +837,11 @@ char* RuntimeSizeof(Heap* heap, char* value) {
       size = HString::Length(value);
       break;
     case Heap::kTagCData:
-      size = HCData::Size(value);
+      size = HCData::Length(value);
+      break;
+    case Heap::kTagHashMap:
+    case Heap::kTagHashSet:
+      size = HHashTable::Size(value);
       break;
     case Heap::kTagArray:
       size = HArray::Length(value, true);
@@ -685,80 +862,211 @@ char* RuntimeSizeof(Heap* heap, char* value) {
 }
 
 
+// Returns address of typed cdata's element or NULL if `key` is out of bounds
+static char* ElementAddress(char* cdata, char* key) {
+  if (HCData::ElementType(cdata) == HCData::kRaw) return NULL;
+  if (HValue::IsUnboxed(key)) {
+    int64_t index = HNumber::Untag(reinterpret_cast<int64_t>(key));
+    if (index < 0 || index >= HCData::Length(cdata)) return NULL;
+
+    int shift = HCData::ElementShift(HCData::ElementType(cdata));
+    return reinterpret_cast<char*>(HCData::Data(cdata)) + (index << shift);
+  }
+
+  // Integral heap numbers are accepted too
+  if (HValue::GetTag(key) != Heap::kTagNumber) return NULL;
+  double index = HNumber::DoubleValue(key);
+  if (index < 0 || index >= HCData::Length(cdata)) return NULL;
+  if (index != floor(index)) return NULL;
+
+  int shift = HCData::ElementShift(HCData::ElementType(cdata));
+  return reinterpret_cast<char*>(HCData::Data(cdata)) +
+         (static_cast<int64_t>(index) << shift);
+}
+
+
+char* RuntimeLoadElement(Heap* heap, char* cdata, char* key) {
+  RuntimeStatsScope stats(heap, RuntimeStats::kLoadElement);
+
+  char* elem = ElementAddress(cdata, key);
+  if (elem == NULL) return HNil::New();
+
+  switch (HCData::ElementType(cdata)) {
+#define LOAD_INTEGRAL(type, ctype)\
+    case HCData::type:\
+      return HNumber::New(heap, static_cast<int64_t>(\
+          *reinterpret_cast<ctype*>(elem)));
+    LOAD_INTEGRAL(kInt8, int8_t)
+    LOAD_INTEGRAL(kUint8, uint8_t)
+    LOAD_INTEGRAL(kInt16, int16_t)
+    LOAD_INTEGRAL(kUint16, uint16_t)
+    LOAD_INTEGRAL(kInt32, int32_t)
+    LOAD_INTEGRAL(kUint32, uint32_t)
+#undef LOAD_INTEGRAL
+    case HCData::kInt64:
+    case HCData::kUint64:
+      {
+        // Keep precision of values that fit into smi
+        int64_t num = *reinterpret_cast<int64_t*>(elem);
+        bool is_signed = HCData::ElementType(cdata) == HCData::kInt64;
+        if ((is_signed || num >= 0) &&
+            HNumber::Untag(HNumber::Tag(num)) == num) {
+          return HNumber::New(heap, num);
+        }
+        return HNumber::New(heap,
+                            Heap::kTenureNew,
+                            is_signed ?
+                                static_cast<double>(num) :
+                                static_cast<double>(
+                                    static_cast<uint64_t>(num)));
+      }
+    case HCData::kFloat32:
+      return HNumber::FromDouble(heap,
+                                 Heap::kTenureNew,
+                                 *reinterpret_cast<float*>(elem));
+    case HCData::kFloat64:
+      return HNumber::FromDouble(heap,
+                                 Heap::kTenureNew,
+                                 *reinterpret_cast<double*>(elem));
+    default:
+      UNEXPECTED
+  }
+
+  return HNil::New();
+}
+
+
+void RuntimeStoreElement(Heap* heap, char* cdata, char* key, char* value) {
+  RuntimeStatsScope stats(heap, RuntimeStats::kStoreElement);
+
+  char* elem = ElementAddress(cdata, key);
+  if (elem == NULL) return;
+
+  value = RuntimeToNumber(heap, value);
+
+  HCData::Representation type = HCData::ElementType(cdata);
+  if (type == HCData::kFloat32 || type == HCData::kFloat64) {
+    double num = HNumber::DoubleValue(value);
+    if (type == HCData::kFloat32) {
+      *reinterpret_cast<float*>(elem) = static_cast<float>(num);
+    } else {
+      *reinterpret_cast<double*>(elem) = num;
+    }
+    return;
+  }
+
+  // Integral elements are truncated like in C and wrap around
+  int64_t num;
+  if (HValue::IsUnboxed(value)) {
+    num = HNumber::IntegralValue(value);
+  } else {
+    num = HNumber::Truncate(HNumber::DoubleValue(value));
+  }
+
+  switch (type) {
+#define STORE_INTEGRAL(type, ctype)\
+    case HCData::type:\
+      *reinterpret_cast<ctype*>(elem) = static_cast<ctype>(num);\
+      break;
+    STORE_INTEGRAL(kInt8, int8_t)
+    STORE_INTEGRAL(kUint8, uint8_t)
+    STORE_INTEGRAL(kInt16, int16_t)
+    STORE_INTEGRAL(kUint16, uint16_t)
+    STORE_INTEGRAL(kInt32, int32_t)
+    STORE_INTEGRAL(kUint32, uint32_t)
+    STORE_INTEGRAL(kInt64, int64_t)
+    STORE_INTEGRAL(kUint64, uint64_t)
+#undef STORE_INTEGRAL
+    default:
+      UNEXPECTED
+  }
+}
+
+
 char* RuntimeKeysof(Heap* heap, char* value) {
+  RuntimeStatsScope stats(heap, RuntimeStats::kKeysof);
   Heap::HeapTag tag = HValue::GetTag(value);
 
-  char* result = HArray::NewEmpty(heap);
+  // Maps and sets yield keys in insertion order
+  if (tag == Heap::kTagHashMap || tag == Heap::kTagHashSet) {
+    return HHashTable::Keys(heap, value);
+  }
 
   // Fast-case - return empty array
-  if (tag != Heap::kTagArray && tag != Heap::kTagObject) return result;
+  if (tag != Heap::kTagArray && tag != Heap::kTagObject) {
+    return HArray::NewEmpty(heap);
+  }
 
-  // Slow-case visit all map's slots and put them into array
-  HMap* map = HValue::As<HMap>(HObject::Map(value));
+  // Count keys first, so result's map will be allocated only once
+  int64_t count = 0;
+  for (HObjectIterator it(value); !it.IsEnded(); it.Advance()) count++;
 
-  uint32_t size = map->size();
-  uint32_t index = 0;
-  for (uint32_t i = 0; i < size; i++) {
-    if (map->GetSlot(i) != HValue::Cast(HNil::New())) {
-      char** slot = HObject::LookupProperty(heap,
-                                            result,
-                                            HNumber::ToPointer(index),
-                                            1);
-      *slot = map->GetSlot(i)->addr();
-      index++;
-    }
+  char* result = HArray::NewEmpty(heap, HArray::LiteralSize(count));
+
+  // Map already has room for every key, so they're written straight into
+  // it (no rehashing or runtime lookups, see HArray::ElementSlot)
+  int64_t index = 0;
+  for (HObjectIterator it(value); !it.IsEnded(); it.Advance()) {
+    char** slot = HArray::ElementSlot(result, index++, true);
+    assert(slot != NULL);
+    *slot = it.Key();
   }
+  HArray::SetLength(result, count);
 
   return result;
 }
 
 
 char* RuntimeCloneObject(Heap* heap, char* obj) {
-  Heap::HeapTag tag = HValue::GetTag(obj);
-  if (tag != Heap::kTagObject && tag != Heap::kTagArray) return HNil::New();
-
-  HObject* source_obj = HValue::As<HObject>(obj);
-  HMap* source_map = HValue::As<HMap>(source_obj->map());
+  RuntimeStatsScope stats(heap, RuntimeStats::kCloneObject);
+  if (HValue::GetTag(obj) != Heap::kTagObject) return HNil::New();
 
+  // mask + map + proto
   char* result = heap->AllocateTagged(Heap::kTagObject,
                                       Heap::kTenureNew,
-                                      2 * HValue::kPointerSize);
-
-  char* map = heap->AllocateTagged(
-      Heap::kTagMap,
-      Heap::kTenureNew,
-      ((source_map->size() << 1) + 1) * HValue::kPointerSize);
-
-  // Set mask
-  *reinterpret_cast<intptr_t*>(result + HObject::kMaskOffset) =
-      (source_map->size() - 1) * HValue::kPointerSize;
-
-  // Set map
-  *reinterpret_cast<char**>(result + HObject::kMapOffset) = map;
+                                      3 * HValue::kPointerSize);
 
-  // Set map's proto
-  *reinterpret_cast<void**>(obj + HObject::kProtoOffset) = source_map;
-
-  // Set map's size
-  *reinterpret_cast<intptr_t*>(map + HMap::kSizeOffset) = source_map->size();
+  // Clone points to the source's map until one of them is changed
+  // (same as CloneObjectStub)
+  char* map = HObject::Map(obj);
+  *HObject::MaskSlot(result) = HObject::Mask(obj);
+  *HObject::MapSlot(result) = map;
+  HValue::SetRepresentation<HObject::Representation>(obj,
+                                                     HObject::kSharedMap);
+  HValue::SetRepresentation<HObject::Representation>(result,
+                                                     HObject::kSharedMap);
 
-  // Nullify all map's slots (both keys and values)
-  uint32_t size = (source_map->size() << 1) * HValue::kPointerSize;
-  memcpy(map + HMap::kSpaceOffset, source_map->space(), size);
+  // Clones share layout of the source map
+  *HObject::ProtoSlot(result) = map;
 
   return result;
 }
 
 
 void RuntimeDeleteProperty(Heap* heap, char* obj, char* property) {
+  RuntimeStatsScope stats(heap, RuntimeStats::kDeleteProperty);
   Heap::HeapTag tag = HValue::GetTag(obj);
+  if (tag == Heap::kTagHashMap || tag == Heap::kTagHashSet) {
+    HHashTable::Delete(heap, obj, property);
+    return;
+  }
   if (tag != Heap::kTagObject && tag != Heap::kTagArray) return;
 
   intptr_t offset = RuntimeLookupProperty(heap, obj, property, 0);
 
+  // No such property
+  if (offset == Heap::kTagNil) return;
+
+  if (tag == Heap::kTagArray) {
+    // Deleted element might be the last one
+    HArray::InvalidateLength(obj);
+  } else if (HObject::IsShared(obj)) {
+    // Offset is the same in the copy
+    HObject::Unshare(heap, obj);
+  }
+
   // Reset proto, IC could not work with this object anymore
-  char** proto_slot = HObject::ProtoSlot(obj);
-  *reinterpret_cast<intptr_t*>(proto_slot) = Heap::kICDisabledValue;
+  HObject::DisableIC(obj);
 
   // Dense arrays doesn't have keys
   if (HValue::GetTag(obj) != Heap::kTagArray || !HArray::IsDense(obj)) {
@@ -773,6 +1081,7 @@ void RuntimeDeleteProperty(Heap* heap, char* obj, char* property) {
 
 
 char* RuntimeStackTrace(Heap* heap, char** frame, char* ip) {
+  RuntimeStatsScope stats(heap, RuntimeStats::kStackTrace);
   SourceInfo* info;
   char* result = HArray::NewEmpty(heap);
 
@@ -61,6 +61,21 @@ typedef char* (*RuntimeGrowObjectCallback)(Heap* heap,
                                            uint32_t min_size);
 char* RuntimeGrowObject(Heap* heap, char* obj, uint32_t min_size);
 
+// Puts `count` (tagged) stack arguments starting from `args` into
+// vararg array, growing it only once
+typedef char* (*RuntimeLoadVarArgCallback)(Heap* heap,
+                                           char* arr,
+                                           char** args,
+                                           intptr_t count);
+char* RuntimeLoadVarArg(Heap* heap, char* arr, char** args, intptr_t count);
+
+// Spreads array's elements on stack, `stack` points to the slot
+// of the last one
+typedef void (*RuntimeStoreVarArgCallback)(Heap* heap,
+                                           char* arr,
+                                           char** stack);
+void RuntimeStoreVarArg(Heap* heap, char* arr, char** stack);
+
 typedef char* (*RuntimeCoerceCallback)(Heap* heap, char* value);
 char* RuntimeToString(Heap* heap, char* value);
 char* RuntimeToNumber(Heap* heap, char* value);
@@ -81,12 +96,32 @@ typedef char* (*RuntimeBinOpCallback)(Heap* heap, char* lhs, char* rhs);
 template <BinOp::BinOpType type>
 char* RuntimeBinOp(Heap* heap, char* lhs, char* rhs);
 
+typedef char* (*RuntimeMathCallback)(Heap* heap, char* lhs, char* rhs);
+template <MathOp::MathOpType type>
+char* RuntimeMath(Heap* heap, char* lhs, char* rhs);
+
+// Unboxed counterpart of RuntimeMath (used by `global.math` bindings)
+double RuntimeMathValue(MathOp::MathOpType type, double lhs, double rhs);
+
 typedef char* (*RuntimeSizeofCallback)(Heap* heap, char* value);
 char* RuntimeSizeof(Heap* heap, char* value);
 
 typedef char* (*RuntimeKeysofCallback)(Heap* heap, char* value);
 char* RuntimeKeysof(Heap* heap, char* value);
 
+// Element access into typed cdata, out-of-bounds loads return nil
+// and out-of-bounds stores are ignored
+typedef char* (*RuntimeLoadElementCallback)(Heap* heap,
+                                            char* cdata,
+                                            char* key);
+char* RuntimeLoadElement(Heap* heap, char* cdata, char* key);
+
+typedef void (*RuntimeStoreElementCallback)(Heap* heap,
+                                            char* cdata,
+                                            char* key,
+                                            char* value);
+void RuntimeStoreElement(Heap* heap, char* cdata, char* key, char* value);
+
 char* RuntimeCloneObject(Heap* heap, char* obj);
 
 typedef void (*RuntimeDeletePropertyCallback)(Heap* heap,
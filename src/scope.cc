@@ -66,6 +66,19 @@ Scope::~Scope() {
   // Assign indexes to each stack item
   Enumerate(ScopeSlot::Enumerate);
 
+  // Function that has no context slots won't allocate a context at all
+  // (see FEntry and LEntry), so outer slots are one hop closer for every
+  // inner function whose lookup has passed through it.
+  // NOTE: all inner functions are analyzed by now, so count is final here.
+  if (type_ == kFunction && context_count_ == 0) {
+    ScopeSlot::UseList::Item* item = passes_.head();
+    for (; item != NULL; item = item->next()) {
+      ScopeSlot* slot = item->value();
+      assert(slot->depth() > 0);
+      slot->depth(slot->depth() - 1);
+    }
+  }
+
   // Lift up stack and context sizes
   if (type_ != kFunction && parent() != NULL) {
     parent()->stack_count_ += stack_count_;
@@ -91,6 +104,8 @@ ScopeSlot* Scope::GetSlot(const char* name, uint32_t length) {
   // No slot was found - go through scopes up to the root one
   int depth = 1;
   Scope* scope = parent();
+  ZoneList<Scope*> passed;
+  passed.Push(this);
   while (scope != NULL) {
     slot = scope->Get(key);
 
@@ -107,6 +122,7 @@ ScopeSlot* Scope::GetSlot(const char* name, uint32_t length) {
     }
 
     depth++;
+    passed.Push(scope);
     scope = scope->parent();
   }
 
@@ -121,6 +137,13 @@ ScopeSlot* Scope::GetSlot(const char* name, uint32_t length) {
     slot = new ScopeSlot(ScopeSlot::kContext, depth);
     source->uses()->Push(slot);
     source->use();
+
+    // Remember scopes between this one and the slot's owner,
+    // depth will be shortened for those that won't have a context
+    if (depth > 0) {
+      Scope* item;
+      while ((item = passed.Shift()) != NULL) item->passes_.Push(slot);
+    }
   }
   slot->use();
   Set(key, slot);
@@ -138,6 +138,9 @@ class Scope : public ZoneMap<StringKey<ZoneObject>, ScopeSlot, ZoneObject> {
 
   int32_t depth_;
 
+  // Context slots of inner scopes that are looked up through this one
+  ScopeSlot::UseList passes_;
+
   ScopeAnalyze* a_;
   Type type_;
 
@@ -0,0 +1,184 @@
+/**
+ * Copyright (c) 2012, Fedor Indutny.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+// No include guard: simd.cc includes this file once per instruction set,
+// into a namespace that defines `Vec`, `kLanes`, SIMD_TARGET and
+// Load/Store/Set1/Add/Sub/Mul/Div/Min/Max/CmpEqMask for that set.
+
+static inline SIMD_TARGET double ReduceAdd(Vec v) {
+  double lanes[kLanes];
+  Store(lanes, v);
+
+  double result = 0;
+  for (uint32_t i = 0; i < kLanes; i++) result += lanes[i];
+  return result;
+}
+
+
+static inline SIMD_TARGET double ReduceMin(Vec v) {
+  double lanes[kLanes];
+  Store(lanes, v);
+
+  double result = lanes[0];
+  for (uint32_t i = 1; i < kLanes; i++) {
+    if (lanes[i] < result) result = lanes[i];
+  }
+  return result;
+}
+
+
+static inline SIMD_TARGET double ReduceMax(Vec v) {
+  double lanes[kLanes];
+  Store(lanes, v);
+
+  double result = lanes[0];
+  for (uint32_t i = 1; i < kLanes; i++) {
+    if (lanes[i] > result) result = lanes[i];
+  }
+  return result;
+}
+
+
+static SIMD_TARGET double Sum(const double* a, uint32_t length) {
+  // Two accumulators hide latency of additions
+  Vec acc0 = Set1(0);
+  Vec acc1 = Set1(0);
+  uint32_t i = 0;
+  for (; i + 2 * kLanes <= length; i += 2 * kLanes) {
+    acc0 = Add(acc0, Load(a + i));
+    acc1 = Add(acc1, Load(a + i + kLanes));
+  }
+  for (; i + kLanes <= length; i += kLanes) acc0 = Add(acc0, Load(a + i));
+
+  double result = ReduceAdd(Add(acc0, acc1));
+  for (; i < length; i++) result += a[i];
+  return result;
+}
+
+
+// minpd/maxpd return second operand if any of them is NaN,
+// so accumulator skips NaNs
+static SIMD_TARGET double Min(const double* a, uint32_t length) {
+  Vec acc = Set1(HUGE_VAL);
+  uint32_t i = 0;
+  for (; i + kLanes <= length; i += kLanes) acc = Min(Load(a + i), acc);
+
+  double result = ReduceMin(acc);
+  for (; i < length; i++) {
+    if (a[i] < result) result = a[i];
+  }
+  return result;
+}
+
+
+static SIMD_TARGET double Max(const double* a, uint32_t length) {
+  Vec acc = Set1(-HUGE_VAL);
+  uint32_t i = 0;
+  for (; i + kLanes <= length; i += kLanes) acc = Max(Load(a + i), acc);
+
+  double result = ReduceMax(acc);
+  for (; i < length; i++) {
+    if (a[i] > result) result = a[i];
+  }
+  return result;
+}
+
+
+static SIMD_TARGET double Dot(const double* a,
+                              const double* b,
+                              uint32_t length) {
+  Vec acc0 = Set1(0);
+  Vec acc1 = Set1(0);
+  uint32_t i = 0;
+  for (; i + 2 * kLanes <= length; i += 2 * kLanes) {
+    acc0 = Add(acc0, Mul(Load(a + i), Load(b + i)));
+    acc1 = Add(acc1, Mul(Load(a + i + kLanes), Load(b + i + kLanes)));
+  }
+  for (; i + kLanes <= length; i += kLanes) {
+    acc0 = Add(acc0, Mul(Load(a + i), Load(b + i)));
+  }
+
+  double result = ReduceAdd(Add(acc0, acc1));
+  for (; i < length; i++) result += a[i] * b[i];
+  return result;
+}
+
+
+static SIMD_TARGET void Fill(double* dst, uint32_t length, double value) {
+  Vec v = Set1(value);
+  uint32_t i = 0;
+  for (; i + kLanes <= length; i += kLanes) Store(dst + i, v);
+  for (; i < length; i++) dst[i] = value;
+}
+
+
+static SIMD_TARGET void ScaleAdd(double* dst,
+                                 const double* src,
+                                 uint32_t length,
+                                 double k) {
+  Vec vk = Set1(k);
+  uint32_t i = 0;
+  for (; i + kLanes <= length; i += kLanes) {
+    Store(dst + i, Add(Load(dst + i), Mul(Load(src + i), vk)));
+  }
+  for (; i < length; i++) dst[i] = dst[i] + src[i] * k;
+}
+
+
+static SIMD_TARGET void Arithmetic(Simd::ArithmeticType type,
+                                   double* dst,
+                                   const double* lhs,
+                                   const double* rhs,
+                                   uint32_t length) {
+  uint32_t i = 0;
+
+#define SIMD_ARITHMETIC_LOOP(op, sign)\
+    for (; i + kLanes <= length; i += kLanes) {\
+      Store(dst + i, op(Load(lhs + i), Load(rhs + i)));\
+    }\
+    for (; i < length; i++) dst[i] = lhs[i] sign rhs[i];
+
+  switch (type) {
+    case Simd::kAdd: SIMD_ARITHMETIC_LOOP(Add, +) break;
+    case Simd::kSub: SIMD_ARITHMETIC_LOOP(Sub, -) break;
+    case Simd::kMul: SIMD_ARITHMETIC_LOOP(Mul, *) break;
+    case Simd::kDiv: SIMD_ARITHMETIC_LOOP(Div, /) break;
+  }
+
+#undef SIMD_ARITHMETIC_LOOP
+}
+
+
+static SIMD_TARGET int64_t IndexOf(const double* a,
+                                   uint32_t length,
+                                   double value) {
+  Vec v = Set1(value);
+  uint32_t i = 0;
+  for (; i + kLanes <= length; i += kLanes) {
+    int mask = CmpEqMask(Load(a + i), v);
+    if (mask != 0) return i + __builtin_ctz(mask);
+  }
+  for (; i < length; i++) {
+    if (a[i] == value) return i;
+  }
+  return -1;
+}
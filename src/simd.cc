@@ -0,0 +1,315 @@
+/**
+ * Copyright (c) 2012, Fedor Indutny.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "simd.h"
+
+#include <stdint.h>  // int64_t
+#include <string.h>  // memmove
+#include <math.h>  // HUGE_VAL
+#include <immintrin.h>  // SSE2 and AVX intrinsics
+
+#include "cpu.h"  // CPU
+#include "heap.h"  // HCData
+#include "heap-inl.h"
+
+namespace candor {
+namespace internal {
+
+namespace sse2 {
+
+#define SIMD_TARGET __attribute__((target("sse2")))
+
+typedef __m128d Vec;
+static const uint32_t kLanes = 2;
+
+static inline SIMD_TARGET Vec Load(const double* p) {
+  return _mm_loadu_pd(p);
+}
+static inline SIMD_TARGET void Store(double* p, Vec v) {
+  _mm_storeu_pd(p, v);
+}
+static inline SIMD_TARGET Vec Set1(double v) { return _mm_set1_pd(v); }
+static inline SIMD_TARGET Vec Add(Vec a, Vec b) { return _mm_add_pd(a, b); }
+static inline SIMD_TARGET Vec Sub(Vec a, Vec b) { return _mm_sub_pd(a, b); }
+static inline SIMD_TARGET Vec Mul(Vec a, Vec b) { return _mm_mul_pd(a, b); }
+static inline SIMD_TARGET Vec Div(Vec a, Vec b) { return _mm_div_pd(a, b); }
+static inline SIMD_TARGET Vec Min(Vec a, Vec b) { return _mm_min_pd(a, b); }
+static inline SIMD_TARGET Vec Max(Vec a, Vec b) { return _mm_max_pd(a, b); }
+static inline SIMD_TARGET int CmpEqMask(Vec a, Vec b) {
+  return _mm_movemask_pd(_mm_cmpeq_pd(a, b));
+}
+
+#include "simd-kernels.h"
+
+#undef SIMD_TARGET
+
+}  // namespace sse2
+
+namespace avx2 {
+
+#define SIMD_TARGET __attribute__((target("avx2")))
+
+typedef __m256d Vec;
+static const uint32_t kLanes = 4;
+
+static inline SIMD_TARGET Vec Load(const double* p) {
+  return _mm256_loadu_pd(p);
+}
+static inline SIMD_TARGET void Store(double* p, Vec v) {
+  _mm256_storeu_pd(p, v);
+}
+static inline SIMD_TARGET Vec Set1(double v) { return _mm256_set1_pd(v); }
+static inline SIMD_TARGET Vec Add(Vec a, Vec b) { return _mm256_add_pd(a, b); }
+static inline SIMD_TARGET Vec Sub(Vec a, Vec b) { return _mm256_sub_pd(a, b); }
+static inline SIMD_TARGET Vec Mul(Vec a, Vec b) { return _mm256_mul_pd(a, b); }
+static inline SIMD_TARGET Vec Div(Vec a, Vec b) { return _mm256_div_pd(a, b); }
+static inline SIMD_TARGET Vec Min(Vec a, Vec b) { return _mm256_min_pd(a, b); }
+static inline SIMD_TARGET Vec Max(Vec a, Vec b) { return _mm256_max_pd(a, b); }
+static inline SIMD_TARGET int CmpEqMask(Vec a, Vec b) {
+  return _mm256_movemask_pd(_mm256_cmp_pd(a, b, _CMP_EQ_OQ));
+}
+
+#include "simd-kernels.h"
+
+#undef SIMD_TARGET
+
+}  // namespace avx2
+
+// Vector kernels are used only if all buffers hold float64 elements
+#define SIMD_IS_VECTOR(a) (HCData::ElementType(a) == HCData::kFloat64 && \
+                           CPU::HasSSE2())
+#define SIMD_DISPATCH(call) (CPU::HasAVX2() ? avx2::call : sse2::call)
+
+static inline double* Doubles(char* cdata) {
+  return reinterpret_cast<double*>(HCData::Data(cdata));
+}
+
+
+static inline uint32_t MinLength(char* a, char* b) {
+  uint32_t a_length = HCData::Length(a);
+  uint32_t b_length = HCData::Length(b);
+  return a_length < b_length ? a_length : b_length;
+}
+
+
+static double LoadElement(char* cdata, uint32_t index) {
+  void* data = HCData::Data(cdata);
+
+  switch (HCData::ElementType(cdata)) {
+#define SIMD_LOAD_CASE(type, ctype)\
+    case HCData::type:\
+      return static_cast<double>(reinterpret_cast<ctype*>(data)[index]);
+    SIMD_LOAD_CASE(kInt8, int8_t)
+    SIMD_LOAD_CASE(kUint8, uint8_t)
+    SIMD_LOAD_CASE(kInt16, int16_t)
+    SIMD_LOAD_CASE(kUint16, uint16_t)
+    SIMD_LOAD_CASE(kInt32, int32_t)
+    SIMD_LOAD_CASE(kUint32, uint32_t)
+    SIMD_LOAD_CASE(kInt64, int64_t)
+    SIMD_LOAD_CASE(kUint64, uint64_t)
+    SIMD_LOAD_CASE(kFloat32, float)
+    SIMD_LOAD_CASE(kFloat64, double)
+#undef SIMD_LOAD_CASE
+    default:
+      UNEXPECTED
+  }
+
+  return 0;
+}
+
+
+// Same conversions as RuntimeStoreElement
+static void StoreElement(char* cdata, uint32_t index, double value) {
+  void* data = HCData::Data(cdata);
+
+  switch (HCData::ElementType(cdata)) {
+#define SIMD_STORE_CASE(type, ctype)\
+    case HCData::type:\
+      reinterpret_cast<ctype*>(data)[index] = static_cast<ctype>(\
+          HNumber::Truncate(value));\
+      break;
+    SIMD_STORE_CASE(kInt8, int8_t)
+    SIMD_STORE_CASE(kUint8, uint8_t)
+    SIMD_STORE_CASE(kInt16, int16_t)
+    SIMD_STORE_CASE(kUint16, uint16_t)
+    SIMD_STORE_CASE(kInt32, int32_t)
+    SIMD_STORE_CASE(kUint32, uint32_t)
+    SIMD_STORE_CASE(kInt64, int64_t)
+    SIMD_STORE_CASE(kUint64, uint64_t)
+#undef SIMD_STORE_CASE
+    case HCData::kFloat32:
+      reinterpret_cast<float*>(data)[index] = static_cast<float>(value);
+      break;
+    case HCData::kFloat64:
+      reinterpret_cast<double*>(data)[index] = value;
+      break;
+    default:
+      UNEXPECTED
+  }
+}
+
+
+double Simd::Sum(char* a) {
+  uint32_t length = HCData::Length(a);
+  if (SIMD_IS_VECTOR(a)) return SIMD_DISPATCH(Sum(Doubles(a), length));
+
+  double result = 0;
+  for (uint32_t i = 0; i < length; i++) result += LoadElement(a, i);
+  return result;
+}
+
+
+bool Simd::Min(char* a, double* result) {
+  uint32_t length = HCData::Length(a);
+  if (length == 0) return false;
+
+  if (SIMD_IS_VECTOR(a)) {
+    *result = SIMD_DISPATCH(Min(Doubles(a), length));
+    return true;
+  }
+
+  *result = HUGE_VAL;
+  for (uint32_t i = 0; i < length; i++) {
+    double value = LoadElement(a, i);
+    if (value < *result) *result = value;
+  }
+  return true;
+}
+
+
+bool Simd::Max(char* a, double* result) {
+  uint32_t length = HCData::Length(a);
+  if (length == 0) return false;
+
+  if (SIMD_IS_VECTOR(a)) {
+    *result = SIMD_DISPATCH(Max(Doubles(a), length));
+    return true;
+  }
+
+  *result = -HUGE_VAL;
+  for (uint32_t i = 0; i < length; i++) {
+    double value = LoadElement(a, i);
+    if (value > *result) *result = value;
+  }
+  return true;
+}
+
+
+double Simd::Dot(char* a, char* b) {
+  uint32_t length = MinLength(a, b);
+  if (SIMD_IS_VECTOR(a) && SIMD_IS_VECTOR(b)) {
+    return SIMD_DISPATCH(Dot(Doubles(a), Doubles(b), length));
+  }
+
+  double result = 0;
+  for (uint32_t i = 0; i < length; i++) {
+    result += LoadElement(a, i) * LoadElement(b, i);
+  }
+  return result;
+}
+
+
+void Simd::Fill(char* dst, double value) {
+  uint32_t length = HCData::Length(dst);
+  if (SIMD_IS_VECTOR(dst)) {
+    return SIMD_DISPATCH(Fill(Doubles(dst), length, value));
+  }
+
+  for (uint32_t i = 0; i < length; i++) StoreElement(dst, i, value);
+}
+
+
+void Simd::Copy(char* dst, char* src) {
+  uint32_t length = MinLength(dst, src);
+  HCData::Representation type = HCData::ElementType(dst);
+
+  // Same element type - just move bytes (buffers may be the same)
+  if (type == HCData::ElementType(src)) {
+    memmove(HCData::Data(dst),
+            HCData::Data(src),
+            length << HCData::ElementShift(type));
+    return;
+  }
+
+  for (uint32_t i = 0; i < length; i++) {
+    StoreElement(dst, i, LoadElement(src, i));
+  }
+}
+
+
+void Simd::ScaleAdd(char* dst, char* src, double k) {
+  uint32_t length = MinLength(dst, src);
+  if (SIMD_IS_VECTOR(dst) && SIMD_IS_VECTOR(src)) {
+    return SIMD_DISPATCH(ScaleAdd(Doubles(dst), Doubles(src), length, k));
+  }
+
+  for (uint32_t i = 0; i < length; i++) {
+    StoreElement(dst, i, LoadElement(dst, i) + LoadElement(src, i) * k);
+  }
+}
+
+
+void Simd::Arithmetic(ArithmeticType type, char* dst, char* lhs, char* rhs) {
+  uint32_t length = MinLength(dst, lhs);
+  if (HCData::Length(rhs) < length) length = HCData::Length(rhs);
+
+  if (SIMD_IS_VECTOR(dst) && SIMD_IS_VECTOR(lhs) && SIMD_IS_VECTOR(rhs)) {
+    return SIMD_DISPATCH(Arithmetic(type,
+                                    Doubles(dst),
+                                    Doubles(lhs),
+                                    Doubles(rhs),
+                                    length));
+  }
+
+  for (uint32_t i = 0; i < length; i++) {
+    double l = LoadElement(lhs, i);
+    double r = LoadElement(rhs, i);
+    double result;
+    switch (type) {
+      case kAdd: result = l + r; break;
+      case kSub: result = l - r; break;
+      case kMul: result = l * r; break;
+      case kDiv: result = l / r; break;
+      default: UNEXPECTED
+    }
+    StoreElement(dst, i, result);
+  }
+}
+
+
+int64_t Simd::IndexOf(char* a, double value) {
+  uint32_t length = HCData::Length(a);
+  if (SIMD_IS_VECTOR(a)) {
+    return SIMD_DISPATCH(IndexOf(Doubles(a), length, value));
+  }
+
+  for (uint32_t i = 0; i < length; i++) {
+    if (LoadElement(a, i) == value) return i;
+  }
+  return -1;
+}
+
+#undef SIMD_IS_VECTOR
+#undef SIMD_DISPATCH
+
+}  // namespace internal
+}  // namespace candor
@@ -0,0 +1,71 @@
+/**
+ * Copyright (c) 2012, Fedor Indutny.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef _SRC_SIMD_H_
+#define _SRC_SIMD_H_
+
+#include <stdint.h>  // int64_t
+
+namespace candor {
+namespace internal {
+
+// Bulk operations over typed cdata, all arguments are HCData addresses.
+// Float64 buffers are processed by vector kernels (AVX2 or SSE2, whichever
+// CPU::Probe() reports), other element types by scalar loops.
+// Operations over several buffers process the shortest length of them.
+class Simd {
+ public:
+  enum ArithmeticType {
+    kAdd,
+    kSub,
+    kMul,
+    kDiv
+  };
+
+  static double Sum(char* a);
+
+  // NaNs are ignored, return false if `a` has no elements
+  static bool Min(char* a, double* result);
+  static bool Max(char* a, double* result);
+
+  static double Dot(char* a, char* b);
+
+  static void Fill(char* dst, double value);
+  static void Copy(char* dst, char* src);
+
+  // dst[i] = dst[i] + src[i] * k
+  static void ScaleAdd(char* dst, char* src, double k);
+
+  // dst[i] = lhs[i] (op) rhs[i]
+  static void Arithmetic(ArithmeticType type,
+                         char* dst,
+                         char* lhs,
+                         char* rhs);
+
+  // Index of the first element equal to `value` or -1
+  static int64_t IndexOf(char* a, double value);
+};
+
+}  // namespace internal
+}  // namespace candor
+
+#endif  // _SRC_SIMD_H_
@@ -0,0 +1,396 @@
+/**
+ * Copyright (c) 2012, Fedor Indutny.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "sort.h"
+
+#include <stdint.h>  // int64_t
+#include <string.h>  // strncmp
+
+#include "heap.h"  // HArray, HMap
+#include "heap-inl.h"
+#include "code-space.h"  // CodeSpace
+#include "runtime.h"  // RuntimeToNumber, RuntimeStringCompare
+
+namespace candor {
+namespace internal {
+
+// Sorts anything that can compare and swap its items by index: quicksort
+// with median-of-three pivot, heapsort once recursion gets too deep and
+// insertion sort for short ranges
+template <class Items>
+class IntroSort {
+ public:
+  static void Run(Items* items, int64_t length) {
+    int depth = 0;
+    for (int64_t n = length; n > 1; n >>= 1) depth += 2;
+
+    Sort(items, 0, length - 1, depth);
+  }
+
+ private:
+  static const int64_t kInsertionLength = 16;
+
+  static void Sort(Items* items, int64_t lo, int64_t hi, int depth) {
+    while (hi - lo >= kInsertionLength) {
+      if (depth-- == 0) return HeapSort(items, lo, hi);
+
+      // Recurse into the smaller part, so stack stays logarithmic
+      int64_t pivot = Partition(items, lo, hi);
+      if (pivot - lo < hi - pivot) {
+        Sort(items, lo, pivot - 1, depth);
+        lo = pivot + 1;
+      } else {
+        Sort(items, pivot + 1, hi, depth);
+        hi = pivot - 1;
+      }
+    }
+
+    InsertionSort(items, lo, hi);
+  }
+
+  static int64_t Partition(Items* items, int64_t lo, int64_t hi) {
+    int64_t mid = lo + ((hi - lo) >> 1);
+    if (items->Less(mid, lo)) items->Swap(mid, lo);
+    if (items->Less(hi, lo)) items->Swap(hi, lo);
+    if (items->Less(hi, mid)) items->Swap(hi, mid);
+
+    // Pivot stays at `lo` until the end, items equal to it are swapped too,
+    // so runs of equal items are split in halves
+    items->Swap(lo, mid);
+
+    int64_t i = lo + 1;
+    int64_t j = hi;
+    while (true) {
+      while (i <= j && items->Less(i, lo)) i++;
+      while (i <= j && items->Less(lo, j)) j--;
+      if (i >= j) break;
+
+      items->Swap(i, j);
+      i++;
+      j--;
+    }
+    items->Swap(lo, j);
+
+    return j;
+  }
+
+  static void HeapSort(Items* items, int64_t lo, int64_t hi) {
+    int64_t length = hi - lo + 1;
+    for (int64_t i = (length >> 1) - 1; i >= 0; i--) {
+      SiftDown(items, lo, i, length);
+    }
+    for (int64_t end = length - 1; end > 0; end--) {
+      items->Swap(lo, lo + end);
+      SiftDown(items, lo, 0, end);
+    }
+  }
+
+  static void SiftDown(Items* items,
+                       int64_t lo,
+                       int64_t root,
+                       int64_t length) {
+    while (true) {
+      int64_t child = (root << 1) + 1;
+      if (child >= length) return;
+      if (child + 1 < length && items->Less(lo + child, lo + child + 1)) {
+        child++;
+      }
+      if (!items->Less(lo + root, lo + child)) return;
+
+      items->Swap(lo + root, lo + child);
+      root = child;
+    }
+  }
+
+  static void InsertionSort(Items* items, int64_t lo, int64_t hi) {
+    for (int64_t i = lo + 1; i <= hi; i++) {
+      for (int64_t j = i; j > lo && items->Less(j, j - 1); j--) {
+        items->Swap(j, j - 1);
+      }
+    }
+  }
+};
+
+
+// Items are compared with their `<` operator
+template <class T>
+class BufferItems {
+ public:
+  explicit BufferItems(T* items) : items_(items) {
+  }
+
+  inline bool Less(int64_t a, int64_t b) { return items_[a] < items_[b]; }
+  inline void Swap(int64_t a, int64_t b) {
+    T tmp = items_[a];
+    items_[a] = items_[b];
+    items_[b] = tmp;
+  }
+
+ private:
+  T* items_;
+};
+
+
+// NaN is greater than any other number (and equal to NaN)
+static inline bool NumberLess(double a, double b) {
+  return a < b || (a == a && b != b);
+}
+
+
+struct NumberItem {
+  double key;
+  char* value;
+
+  inline bool operator<(const NumberItem& other) const {
+    return NumberLess(key, other.key);
+  }
+};
+
+
+// Same order as RuntimeStringCompare's one
+struct StringItem {
+  const char* data;
+  uint32_t length;
+  char* value;
+
+  inline bool operator<(const StringItem& other) const {
+    if (length != other.length) return length < other.length;
+    return strncmp(data, other.data, length) < 0;
+  }
+};
+
+
+// Values of different types
+class ValueItems {
+ public:
+  ValueItems(Heap* heap, char** items) : heap_(heap), items_(items) {
+  }
+
+  inline bool Less(int64_t a, int64_t b) {
+    char* lhs = items_[a];
+    char* rhs = items_[b];
+
+    int lrank = Rank(lhs);
+    int rrank = Rank(rhs);
+    if (lrank != rrank) return lrank < rrank;
+
+    switch (HValue::GetTag(lhs)) {
+      case Heap::kTagNumber:
+        return NumberLess(HNumber::DoubleValue(lhs),
+                          HNumber::DoubleValue(rhs));
+      case Heap::kTagString:
+        return RuntimeStringCompare(heap_, lhs, rhs) < 0;
+      case Heap::kTagBoolean:
+        return !HBoolean::Value(lhs) && HBoolean::Value(rhs);
+      default:
+        return false;
+    }
+  }
+
+  inline void Swap(int64_t a, int64_t b) {
+    char* tmp = items_[a];
+    items_[a] = items_[b];
+    items_[b] = tmp;
+  }
+
+ private:
+  static inline int Rank(char* value) {
+    switch (HValue::GetTag(value)) {
+      case Heap::kTagNumber: return 0;
+      case Heap::kTagString: return 1;
+      case Heap::kTagBoolean: return 2;
+      case Heap::kTagNil: return 4;
+      default: return 3;
+    }
+  }
+
+  Heap* heap_;
+  char** items_;
+};
+
+
+// Items are stored in a heap map, that is moved by GC when comparator
+// allocates. `storage` and `comparator` should be referenced by the caller.
+class CallbackItems {
+ public:
+  CallbackItems(CodeSpace* space, char** storage, char** comparator)
+      : space_(space),
+        storage_(storage),
+        comparator_(comparator) {
+  }
+
+  inline bool Less(int64_t a, int64_t b) {
+    char* argv[2] = { Slots()[a], Slots()[b] };
+
+    // Arguments are copied to the stack by the entry stub
+    char* result = reinterpret_cast<char*>(space_->Run(
+          *comparator_,
+          2,
+          reinterpret_cast<Value**>(argv)));
+
+    if (HValue::GetTag(result) != Heap::kTagNumber) {
+      result = RuntimeToNumber(space_->heap(), result);
+    }
+    if (HValue::IsUnboxed(result)) return HNumber::IntegralValue(result) < 0;
+    return HNumber::DoubleValue(result) < 0;
+  }
+
+  inline void Swap(int64_t a, int64_t b) {
+    char** slots = Slots();
+    char* tmp = slots[a];
+    slots[a] = slots[b];
+    slots[b] = tmp;
+  }
+
+ private:
+  inline char** Slots() {
+    return reinterpret_cast<char**>(*storage_ + HMap::kSpaceOffset);
+  }
+
+  CodeSpace* space_;
+  char** storage_;
+  char** comparator_;
+};
+
+
+// Copies `length` elements of array to `values` (holes become nil)
+static void Gather(char* arr, int64_t length, char** values) {
+  for (int64_t i = 0; i < length; i++) values[i] = HNil::New();
+
+  // Walk the map once instead of looking up every index
+  for (HObjectIterator it(arr); !it.IsEnded(); it.Advance()) {
+    char* key = it.Key();
+    if (!HValue::IsUnboxed(key)) continue;
+
+    int64_t index = HNumber::IntegralValue(key);
+    if (index < 0 || index >= length) continue;
+    values[index] = it.Value();
+  }
+}
+
+
+static void Scatter(Heap* heap, char* arr, int64_t length, char** values) {
+  for (int64_t i = 0; i < length; i++) {
+    // Nil doesn't need a slot, it may be stored into shared nil one
+    char** slot = HObject::LookupProperty(heap,
+                                          arr,
+                                          HNumber::ToPointer(i),
+                                          values[i] != HNil::New());
+    *slot = values[i];
+  }
+
+  // Holes are moved to the end
+  HArray::InvalidateLength(arr);
+}
+
+
+void ArraySort::Sort(Heap* heap, char* arr) {
+  int64_t length = HArray::Length(arr, true);
+  if (length < 2) return;
+
+  char** values = new char*[length];
+  Gather(arr, length, values);
+
+  bool unboxed = true;
+  bool numbers = true;
+  bool strings = true;
+  for (int64_t i = 0; i < length; i++) {
+    Heap::HeapTag tag = HValue::GetTag(values[i]);
+    unboxed = unboxed && HValue::IsUnboxed(values[i]);
+    numbers = numbers && tag == Heap::kTagNumber;
+    strings = strings && tag == Heap::kTagString;
+  }
+
+  if (unboxed) {
+    // Tagging keeps order of unboxed numbers
+    BufferItems<intptr_t> items(reinterpret_cast<intptr_t*>(values));
+    IntroSort<BufferItems<intptr_t> >::Run(&items, length);
+  } else if (numbers) {
+    NumberItem* buffer = new NumberItem[length];
+    for (int64_t i = 0; i < length; i++) {
+      buffer[i].key = HNumber::DoubleValue(values[i]);
+      buffer[i].value = values[i];
+    }
+
+    BufferItems<NumberItem> items(buffer);
+    IntroSort<BufferItems<NumberItem> >::Run(&items, length);
+
+    for (int64_t i = 0; i < length; i++) values[i] = buffer[i].value;
+    delete[] buffer;
+  } else if (strings) {
+    // NOTE: Flattening cons strings allocates, but doesn't move anything
+    StringItem* buffer = new StringItem[length];
+    for (int64_t i = 0; i < length; i++) {
+      buffer[i].data = HString::Value(heap, values[i]);
+      buffer[i].length = HString::Length(values[i]);
+      buffer[i].value = values[i];
+    }
+
+    BufferItems<StringItem> items(buffer);
+    IntroSort<BufferItems<StringItem> >::Run(&items, length);
+
+    for (int64_t i = 0; i < length; i++) values[i] = buffer[i].value;
+    delete[] buffer;
+  } else {
+    ValueItems items(heap, values);
+    IntroSort<ValueItems>::Run(&items, length);
+  }
+
+  Scatter(heap, arr, length, values);
+  delete[] values;
+}
+
+
+void ArraySort::Sort(CodeSpace* space, char* arr, char* comparator) {
+  Heap* heap = space->heap();
+  int64_t length = HArray::Length(arr, true);
+  if (length < 2) return;
+
+  // Map's size is a half of its slots count
+  char* storage = HMap::NewEmpty(heap, (length + 1) >> 1);
+  Gather(arr, length, reinterpret_cast<char**>(storage + HMap::kSpaceOffset));
+
+  // GC will update these while comparator runs
+  HValue** refs[] = {
+    reinterpret_cast<HValue**>(&arr),
+    reinterpret_cast<HValue**>(&storage),
+    reinterpret_cast<HValue**>(&comparator)
+  };
+  for (size_t i = 0; i < sizeof(refs) / sizeof(refs[0]); i++) {
+    heap->Reference(Heap::kRefPersistent, refs[i], *refs[i]);
+  }
+
+  CallbackItems items(space, &storage, &comparator);
+  IntroSort<CallbackItems>::Run(&items, length);
+
+  for (size_t i = 0; i < sizeof(refs) / sizeof(refs[0]); i++) {
+    heap->Dereference(refs[i], *refs[i]);
+  }
+
+  Scatter(heap,
+          arr,
+          length,
+          reinterpret_cast<char**>(storage + HMap::kSpaceOffset));
+}
+
+}  // namespace internal
+}  // namespace candor
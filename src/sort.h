@@ -0,0 +1,51 @@
+/**
+ * Copyright (c) 2012, Fedor Indutny.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef _SRC_SORT_H_
+#define _SRC_SORT_H_
+
+namespace candor {
+namespace internal {
+
+// Forward declarations
+class Heap;
+class CodeSpace;
+
+// In-place introsort of array's elements (holes are treated as nil).
+// Arrays of only unboxed numbers, only numbers or only strings are sorted
+// without looking at their values' tags, the rest is ordered by type first.
+class ArraySort {
+ public:
+  // Numbers go first, then strings, booleans and other values, nil is the
+  // last. Numbers and strings are ordered as `<` orders them (NaNs go after
+  // other numbers), other values keep no particular order.
+  static void Sort(Heap* heap, char* arr);
+
+  // `comparator(a, b)` should return negative number if `a` goes before `b`,
+  // it is called through the entry stub and may trigger GC
+  static void Sort(CodeSpace* space, char* arr, char* comparator);
+};
+
+}  // namespace internal
+}  // namespace candor
+
+#endif  // _SRC_SORT_H_
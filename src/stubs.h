@@ -47,9 +47,12 @@ namespace internal {
     V(Sizeof)\
     V(Keysof)\
     V(LookupProperty)\
+    V(LoadElement)\
+    V(StoreElement)\
     V(PICMiss)\
     V(CoerceToBoolean)\
     V(CloneObject)\
+    V(CloneLiteral)\
     V(DeleteProperty)\
     V(HashValue)\
     V(StackTrace)\
@@ -79,6 +82,21 @@ namespace internal {
     V(LOr)\
     V(LAnd)
 
+#define MATH_STUBS_LIST(V)\
+    V(Floor)\
+    V(Ceil)\
+    V(Round)\
+    V(Sqrt)\
+    V(Abs)\
+    V(Min)\
+    V(Max)\
+    V(Pow)\
+    V(Exp)\
+    V(Log)\
+    V(Sin)\
+    V(Cos)\
+    V(Tan)
+
 class BaseStub {
  public:
   enum StubType {
@@ -88,6 +106,9 @@ class BaseStub {
 #define BINARY_STUB_ENUM(V) kBinary##V,
     BINARY_STUBS_LIST(BINARY_STUB_ENUM)
 #undef BINARY_STUB_ENUM
+#define MATH_STUB_ENUM(V) kMath##V,
+    MATH_STUBS_LIST(MATH_STUB_ENUM)
+#undef MATH_STUB_ENUM
     kNone
   };
 
@@ -106,6 +127,21 @@ class BaseStub {
   inline StubType type() { return type_; }
   inline bool is(StubType type) { return type_ == type; }
 
+  static inline const char* TypeToString(StubType type) {
+    switch (type) {
+#define STUB_NAME(V) case k##V: return #V "Stub";
+      STUBS_LIST(STUB_NAME)
+#undef STUB_NAME
+#define BINARY_STUB_NAME(V) case kBinary##V: return "Binary" #V "Stub";
+      BINARY_STUBS_LIST(BINARY_STUB_NAME)
+#undef BINARY_STUB_NAME
+#define MATH_STUB_NAME(V) case kMath##V: return "Math" #V "Stub";
+      MATH_STUBS_LIST(MATH_STUB_NAME)
+#undef MATH_STUB_NAME
+      default: return NULL;
+    }
+  }
+
  protected:
   CodeSpace* space_;
   Masm masm_;
@@ -123,9 +159,8 @@ STUBS_LIST(STUB_CLASS_DECL)
 
 class BinOpStub : public BaseStub {
  public:
-  // TODO(indutny): Use some type instead of kNone
-  BinOpStub(CodeSpace* space, BinOp::BinOpType type) :
-      BaseStub(space, kNone), type_(type) {
+  BinOpStub(CodeSpace* space, BinOp::BinOpType type, StubType stub_type) :
+      BaseStub(space, stub_type), type_(type) {
   }
 
   BinOp::BinOpType type() { return type_; }
@@ -139,11 +174,35 @@ class BinOpStub : public BaseStub {
 #define BINARY_STUB_CLASS_DECL(V)\
     class Binary##V##Stub : public BinOpStub {\
      public:\
-      Binary##V##Stub(CodeSpace* space) : BinOpStub(space, BinOp::k##V) {}\
+      Binary##V##Stub(CodeSpace* space) :\
+          BinOpStub(space, BinOp::k##V, kBinary##V) {}\
     };
 BINARY_STUBS_LIST(BINARY_STUB_CLASS_DECL)
 #undef BINARY_STUB_CLASS_DECL
 
+class MathStub : public BaseStub {
+ public:
+  MathStub(CodeSpace* space, MathOp::MathOpType type, StubType stub_type) :
+      BaseStub(space, stub_type), type_(type) {
+  }
+
+  MathOp::MathOpType type() { return type_; }
+
+  void Generate();
+
+ protected:
+  MathOp::MathOpType type_;
+};
+
+#define MATH_STUB_CLASS_DECL(V)\
+    class Math##V##Stub : public MathStub {\
+     public:\
+      Math##V##Stub(CodeSpace* space) :\
+          MathStub(space, MathOp::k##V, kMath##V) {}\
+    };
+MATH_STUBS_LIST(MATH_STUB_CLASS_DECL)
+#undef MATH_STUB_CLASS_DECL
+
 #define STUB_LAZY_ALLOCATOR(V)\
     char* Get##V##Stub() {\
       if (stub_##V##_ == NULL) {\
@@ -158,40 +217,60 @@ BINARY_STUBS_LIST(BINARY_STUB_CLASS_DECL)
     }
 
 #define BINARY_STUB_LAZY_ALLOCATOR(V) STUB_LAZY_ALLOCATOR(Binary##V)
+#define MATH_STUB_LAZY_ALLOCATOR(V) STUB_LAZY_ALLOCATOR(Math##V)
 
 #define STUB_PROPERTY(V) char* stub_##V##_;
 #define STUB_PROPERTY_INIT(V) stub_##V##_ = NULL;
 #define BINARY_STUB_PROPERTY(V) char* stub_Binary##V##_;
 #define BINARY_STUB_PROPERTY_INIT(V) stub_Binary##V##_ = NULL;
+#define MATH_STUB_PROPERTY(V) char* stub_Math##V##_;
+#define MATH_STUB_PROPERTY_INIT(V) stub_Math##V##_ = NULL;
 
 class Stubs {
  public:
   explicit Stubs(CodeSpace* space) : space_(space) {
     STUBS_LIST(STUB_PROPERTY_INIT)
     BINARY_STUBS_LIST(BINARY_STUB_PROPERTY_INIT)
+    MATH_STUBS_LIST(MATH_STUB_PROPERTY_INIT)
   }
 
   inline CodeSpace* space() { return space_; }
 
   STUBS_LIST(STUB_LAZY_ALLOCATOR)
   BINARY_STUBS_LIST(BINARY_STUB_LAZY_ALLOCATOR)
+  MATH_STUBS_LIST(MATH_STUB_LAZY_ALLOCATOR)
+
+  // Stub for math intrinsic of given type
+  char* GetMathStub(MathOp::MathOpType type) {
+    switch (type) {
+#define MATH_STUB_CASE(V) case MathOp::k##V: return GetMath##V##Stub();
+      MATH_STUBS_LIST(MATH_STUB_CASE)
+#undef MATH_STUB_CASE
+      default: UNEXPECTED return NULL;
+    }
+  }
  protected:
   CodeSpace* space_;
 
   STUBS_LIST(STUB_PROPERTY)
   BINARY_STUBS_LIST(BINARY_STUB_PROPERTY)
+  MATH_STUBS_LIST(MATH_STUB_PROPERTY)
 };
 
+#undef MATH_STUB_LAZY_ALLOCATOR
 #undef BINARY_STUB_LAZY_ALLOCATOR
 #undef STUB_LAZY_ALLOCATOR
 #undef BINARY_STUB_PROPERTY_INIT
 #undef BINARY_STUB_PROPERTY
+#undef MATH_STUB_PROPERTY_INIT
+#undef MATH_STUB_PROPERTY
 #undef STUB_PROPERTY_INIT
 #undef STUB_PROPERTY
 
 
 #undef STUBS_LIST
 #undef BINARY_STUBS_LIST
+#undef MATH_STUBS_LIST
 
 }  // namespace internal
 }  // namespace candor
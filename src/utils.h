@@ -30,6 +30,7 @@
 #include <string.h>  // strncmp, memset
 #include <unistd.h>  // sysconf or getpagesize, intptr_t
 #include <assert.h>  // assert
+#include <sys/time.h>  // gettimeofday
 
 namespace candor {
 namespace internal {
@@ -76,6 +77,15 @@ inline uint32_t ComputeHash(const char* key, uint32_t length) {
 
 
 // Find minimum number that's greater than value and is dividable by to
+// Wall time in microseconds
+inline int64_t GetTimeMicros() {
+  timeval tv;
+  gettimeofday(&tv, NULL);
+
+  return static_cast<int64_t>(tv.tv_sec) * 1000000 + tv.tv_usec;
+}
+
+
 inline uint32_t RoundUp(uint32_t value, uint32_t to) {
   if (value % to == 0) return value;
 
@@ -37,6 +37,13 @@ inline void Assembler::emit_rex_if_high(Register src) {
 }
 
 
+inline void Assembler::emit_rex_if_high(Register dst, const Operand& src) {
+  if (dst.high() == 1 || src.base().high() == 1) {
+    emitb(0x40 | dst.high() << 2 | src.base().high());
+  }
+}
+
+
 inline void Assembler::emit_rexw(Register dst) {
   emitb(0x48 | dst.high() << 2);
 }
@@ -111,6 +111,13 @@ void Assembler::cpuid() {
 }
 
 
+void Assembler::xgetbv() {
+  emitb(0x0F);
+  emitb(0x01);
+  emitb(0xD0);
+}
+
+
 void Assembler::push(Register src) {
   emit_rex_if_high(src);
   emitb(0x50 | src.low());
@@ -357,6 +364,60 @@ void Assembler::movzxb(Register dst, const Operand& src) {
 }
 
 
+void Assembler::movsxb(Register dst, const Operand& src) {
+  emit_rexw(dst, src);
+  emitb(0x0F);
+  emitb(0xBE);
+  emit_modrm(dst, src);
+}
+
+
+void Assembler::movzxw(Register dst, const Operand& src) {
+  emit_rexw(dst, src);
+  emitb(0x0F);
+  emitb(0xB7);
+  emit_modrm(dst, src);
+}
+
+
+void Assembler::movsxw(Register dst, const Operand& src) {
+  emit_rexw(dst, src);
+  emitb(0x0F);
+  emitb(0xBF);
+  emit_modrm(dst, src);
+}
+
+
+void Assembler::movl(Register dst, const Operand& src) {
+  // Zero-extends into upper half
+  emit_rex_if_high(dst, src);
+  emitb(0x8B);
+  emit_modrm(dst, src);
+}
+
+
+void Assembler::movsxl(Register dst, const Operand& src) {
+  emit_rexw(dst, src);
+  emitb(0x63);
+  emit_modrm(dst, src);
+}
+
+
+void Assembler::movw(const Operand& dst, Register src) {
+  emitb(0x66);
+  emit_rex_if_high(src, dst);
+  emitb(0x89);
+  emit_modrm(src, dst);
+}
+
+
+void Assembler::movl(const Operand& dst, Register src) {
+  emit_rex_if_high(src, dst);
+  emitb(0x89);
+  emit_modrm(src, dst);
+}
+
+
 void Assembler::xchg(Register dst, Register src) {
   emit_rexw(dst, src);
   emitb(0x87);
@@ -613,6 +674,38 @@ void Assembler::movd(const Operand& dst, DoubleRegister src) {
 }
 
 
+void Assembler::movss(DoubleRegister dst, const Operand& src) {
+  emitb(0xF3);
+  emitb(0x0F);
+  emitb(0x10);
+  emit_modrm(dst, src);
+}
+
+
+void Assembler::movss(const Operand& dst, DoubleRegister src) {
+  emitb(0xF3);
+  emitb(0x0F);
+  emitb(0x11);
+  emit_modrm(dst, src);
+}
+
+
+void Assembler::cvtss2sd(DoubleRegister dst, DoubleRegister src) {
+  emitb(0xF3);
+  emitb(0x0F);
+  emitb(0x5A);
+  emit_modrm(dst, src);
+}
+
+
+void Assembler::cvtsd2ss(DoubleRegister dst, DoubleRegister src) {
+  emitb(0xF2);
+  emitb(0x0F);
+  emitb(0x5A);
+  emit_modrm(dst, src);
+}
+
+
 void Assembler::addqd(DoubleRegister dst, DoubleRegister src) {
   emitb(0xF2);
   emitb(0x0F);
@@ -645,6 +738,14 @@ void Assembler::divqd(DoubleRegister dst, DoubleRegister src) {
 }
 
 
+void Assembler::sqrtqd(DoubleRegister dst, DoubleRegister src) {
+  emitb(0xF2);
+  emitb(0x0F);
+  emitb(0x51);
+  emit_modrm(dst, src);
+}
+
+
 void Assembler::xorqd(DoubleRegister dst, DoubleRegister src) {
   emitb(0x66);
   emitb(0x0F);
@@ -323,6 +323,7 @@ class Assembler {
   // Instructions
   void nop();
   void cpuid();
+  void xgetbv();
 
   void push(Register src);
   void push(const Operand& src);
@@ -358,6 +359,13 @@ class Assembler {
   void movb(const Operand& dst, const Immediate src);
   void movb(const Operand& dst, Register src);
   void movzxb(Register dst, const Operand& src);
+  void movsxb(Register dst, const Operand& src);
+  void movzxw(Register dst, const Operand& src);
+  void movsxw(Register dst, const Operand& src);
+  void movl(Register dst, const Operand& src);
+  void movsxl(Register dst, const Operand& src);
+  void movw(const Operand& dst, Register src);
+  void movl(const Operand& dst, Register src);
 
   void xchg(Register dst, Register src);
 
@@ -399,10 +407,15 @@ class Assembler {
   void movd(DoubleRegister dst, const Operand& src);
   void movd(Register dst, DoubleRegister src);
   void movd(const Operand& dst, DoubleRegister src);
+  void movss(DoubleRegister dst, const Operand& src);
+  void movss(const Operand& dst, DoubleRegister src);
+  void cvtss2sd(DoubleRegister dst, DoubleRegister src);
+  void cvtsd2ss(DoubleRegister dst, DoubleRegister src);
   void addqd(DoubleRegister dst, DoubleRegister src);
   void subqd(DoubleRegister dst, DoubleRegister src);
   void mulqd(DoubleRegister dst, DoubleRegister src);
   void divqd(DoubleRegister dst, DoubleRegister src);
+  void sqrtqd(DoubleRegister dst, DoubleRegister src);
   void xorqd(DoubleRegister dst, DoubleRegister src);
   void cvtsi2sd(DoubleRegister dst, Register src);
   void cvtsd2si(Register dst, DoubleRegister src);
@@ -413,6 +426,7 @@ class Assembler {
 
   // Routines
   inline void emit_rex_if_high(Register src);
+  inline void emit_rex_if_high(Register dst, const Operand& src);
   inline void emit_rexw(Register dst);
   inline void emit_rexw(const Operand& dst);
   inline void emit_rexw(Register dst, Register src);
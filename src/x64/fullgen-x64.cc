@@ -69,7 +69,8 @@ void FEntry::Generate(Masm* masm) {
   __ mov(argc, rax);
 
   // Allocate context slots
-  __ AllocateContext(context_slots_);
+  // (functions without them are running in their parent's context)
+  if (context_slots_ != 0) __ AllocateContext(context_slots_);
 }
 
 
@@ -166,14 +167,25 @@ void FLoadContext::Generate(Masm* masm) {
 
 
 void FStoreProperty::Generate(Masm* masm) {
-  Label done;
+  Label miss, done;
   __ mov(rax, *inputs[0]->ToOperand());
   __ mov(rbx, *inputs[1]->ToOperand());
 
   // rax <- object
   // rbx <- propery
-  // rcx <- value
-  __ mov(rcx, Immediate(1));
+  // rcx <- change flag, stores of non-nil values keep array's length exact
+  __ mov(rcx, *inputs[2]->ToOperand());
+  {
+    Label store_nil, flag_set;
+
+    __ IsNil(rcx, NULL, &store_nil);
+    __ mov(rcx, Immediate(HArray::kInsertNonNil));
+    __ jmp(&flag_set);
+    __ bind(&store_nil);
+    __ mov(rcx, Immediate(1));
+    __ bind(&flag_set);
+  }
+
   __ Call(masm->stubs()->GetLookupPropertyStub());
 
   // Make rax look like unboxed number to GC
@@ -181,7 +193,7 @@ void FStoreProperty::Generate(Masm* masm) {
   __ CheckGC();
   __ inc(rax);
 
-  __ IsNil(rax, NULL, &done);
+  __ IsNil(rax, NULL, &miss);
   __ mov(rbx, *inputs[0]->ToOperand());
   __ mov(rcx, *inputs[2]->ToOperand());
   Operand qmap(rbx, HObject::kMapOffset);
@@ -190,13 +202,24 @@ void FStoreProperty::Generate(Masm* masm) {
 
   Operand slot(rax, 0);
   __ mov(slot, rcx);
+  __ jmp(&done);
+
+  // Typed cdata has no map, lookup returns nil for it
+  __ bind(&miss);
+  __ mov(rax, *inputs[0]->ToOperand());
+  __ IsUnboxed(rax, NULL, &done);
+  __ IsNil(rax, NULL, &done);
+  __ IsHeapObject(Heap::kTagCData, rax, &done, NULL);
+  __ mov(rbx, *inputs[1]->ToOperand());
+  __ mov(rcx, *inputs[2]->ToOperand());
+  __ Call(masm->stubs()->GetStoreElementStub());
 
   __ bind(&done);
 }
 
 
 void FLoadProperty::Generate(Masm* masm) {
-  Label done;
+  Label miss, done;
   __ mov(rax, *inputs[0]->ToOperand());
   __ mov(rbx, *inputs[1]->ToOperand());
 
@@ -205,7 +228,7 @@ void FLoadProperty::Generate(Masm* masm) {
   __ mov(rcx, Immediate(0));
   __ Call(masm->stubs()->GetLookupPropertyStub());
 
-  __ IsNil(rax, NULL, &done);
+  __ IsNil(rax, NULL, &miss);
   __ mov(rbx, *inputs[0]->ToOperand());
   Operand qmap(rbx, HObject::kMapOffset);
   __ mov(rbx, qmap);
@@ -213,6 +236,17 @@ void FLoadProperty::Generate(Masm* masm) {
 
   Operand slot(rax, 0);
   __ mov(rax, slot);
+  __ jmp(&done);
+
+  // Typed cdata has no map, lookup returns nil for it
+  __ bind(&miss);
+  __ mov(rbx, *inputs[0]->ToOperand());
+  __ IsUnboxed(rbx, NULL, &done);
+  __ IsNil(rbx, NULL, &done);
+  __ IsHeapObject(Heap::kTagCData, rbx, &done, NULL);
+  __ mov(rax, rbx);
+  __ mov(rbx, *inputs[1]->ToOperand());
+  __ Call(masm->stubs()->GetLoadElementStub());
 
   __ bind(&done);
   __ mov(*result->ToOperand(), rax);
@@ -349,6 +383,17 @@ void FBinOp::Generate(Masm* masm) {
 #undef BINARY_SUB_TYPES
 #undef BINARY_SUB_ENUM
 
+void FMath::Generate(Masm* masm) {
+  // rax <- lhs
+  // rbx <- rhs
+  __ mov(rax, *inputs[0]->ToOperand());
+  if (input_count_ > 1) __ mov(rbx, *inputs[1]->ToOperand());
+  __ Call(masm->stubs()->GetMathStub(sub_type_));
+  // result -> rax
+  __ mov(*result->ToOperand(), rax);
+}
+
+
 void FFunction::Generate(Masm* masm) {
   // Get function's body address from relocation info
   __ mov(scratch, Immediate(0));
@@ -372,6 +417,13 @@ void FClone::Generate(Masm* masm) {
 }
 
 
+void FCloneLiteral::Generate(Masm* masm) {
+  __ mov(rax, *inputs[0]->ToOperand());
+  __ Call(masm->stubs()->GetCloneLiteralStub());
+  __ mov(*result->ToOperand(), rax);
+}
+
+
 void FSizeof::Generate(Masm* masm) {
   __ mov(rax, *inputs[0]->ToOperand());
   __ Call(masm->stubs()->GetSizeofStub());
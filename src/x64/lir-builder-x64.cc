@@ -74,6 +74,16 @@ void LGen::VisitAllocateArray(HIRInstruction* instr) {
 }
 
 
+void LGen::VisitCloneLiteral(HIRInstruction* instr) {
+  LInterval* boilerplate = ToFixed(instr->left(), rax);
+  LInstruction* op = Bind(new LCloneLiteral())
+      ->MarkHasCall()
+      ->AddArg(boilerplate, LUse::kRegister);
+
+  ResultFromFixed(op, rax);
+}
+
+
 void LGen::VisitFunction(HIRInstruction* instr) {
   HIRFunction* fn = HIRFunction::Cast(instr);
 
@@ -96,6 +106,24 @@ void LGen::VisitNot(HIRInstruction* instr) {
 
 
 void LGen::VisitBinOp(HIRInstruction* instr) {
+  // Computed by the binop it's fused into
+  if (IsFused(instr)) return;
+
+  bool left;
+  bool right;
+  FusedLeaves(instr, &left, &right);
+  if (left || right) {
+    LBinOpDouble* tree = new LBinOpDouble();
+    LInterval* args[LBinOpDouble::kMaxArgs];
+    int count = AddFusedArgs(tree, instr, args, 0);
+
+    Bind(tree)->MarkHasCall();
+    for (int i = 0; i < count; i++) tree->AddArg(args[i], LUse::kRegister);
+
+    ResultFromFixed(tree, rax);
+    return;
+  }
+
   LInstruction* op;
   LInterval* lhs = ToFixed(instr->left(), rax);
   LInterval* rhs = ToFixed(instr->right(), rbx);
@@ -119,6 +147,52 @@ void LGen::VisitBinOp(HIRInstruction* instr) {
 }
 
 
+int LGen::AddFusedArgs(LBinOpDouble* op,
+                       HIRInstruction* instr,
+                       LInterval** args,
+                       int count) {
+  static const Register regs[] = { rax, rbx, rcx, rdx, r8, r9 };
+
+  bool fused[2];
+  HIRInstruction* operands[] = { instr->left(), instr->right() };
+  FusedLeaves(instr, &fused[0], &fused[1]);
+
+  for (int i = 0; i < 2; i++) {
+    if (fused[i]) {
+      count = AddFusedArgs(op, operands[i], args, count);
+    } else {
+      op->AddLeaf(count);
+      args[count] = ToFixed(operands[i], regs[count]);
+      count++;
+    }
+  }
+  op->AddOp(HIRBinOp::Cast(instr)->binop_type());
+
+  return count;
+}
+
+
+void LGen::VisitMath(HIRInstruction* instr) {
+  bool binary = MathOp::argc(HIRMath::Cast(instr)->math_type()) == 2;
+  LInterval* lhs = ToFixed(instr->left(), rax);
+  LInterval* rhs = binary ? ToFixed(instr->right(), rbx) : NULL;
+  LInstruction* op = Bind(new LMath())
+      ->MarkHasCall()
+      ->AddArg(lhs, LUse::kRegister);
+  if (binary) op->AddArg(rhs, LUse::kRegister);
+
+  ResultFromFixed(op, rax);
+}
+
+
+void LGen::VisitMathCheck(HIRInstruction* instr) {
+  Bind(new LMathCheck())
+      ->AddScratch(CreateVirtual())
+      ->AddArg(instr->left(), LUse::kRegister)
+      ->SetResult(CreateVirtual(), LUse::kRegister);
+}
+
+
 void LGen::VisitSizeof(HIRInstruction* instr) {
   LInterval* lhs = ToFixed(instr->left(), rax);
   LInstruction* op = Bind(new LSizeof())
@@ -139,6 +213,20 @@ void LGen::VisitTypeof(HIRInstruction* instr) {
 }
 
 
+void LGen::VisitTypeCheck(HIRInstruction* instr) {
+  // Result is known at compile time, input isn't needed
+  if (HIRTypeCheck::Cast(instr)->KnownTag() != 0) {
+    Bind(new LTypeCheck())
+        ->SetResult(CreateVirtual(), LUse::kRegister);
+    return;
+  }
+
+  Bind(new LTypeCheck())
+      ->AddArg(instr->left(), LUse::kRegister)
+      ->SetResult(CreateVirtual(), LUse::kRegister);
+}
+
+
 void LGen::VisitKeysof(HIRInstruction* instr) {
   LInterval* lhs = ToFixed(instr->left(), rax);
   LInstruction* op = Bind(new LKeysof())
@@ -188,6 +276,8 @@ void LGen::VisitLoadProperty(HIRInstruction* instr) {
     load->SetMonomorphicProperty();
   }
 
+  if (!instr->right()->IsString()) load->SetElementAccess();
+
   ResultFromFixed(load, rax);
 }
 
@@ -205,6 +295,8 @@ void LGen::VisitStoreProperty(HIRInstruction* instr) {
   if (instr->right()->Is(HIRInstruction::kLiteral)) {
     store->SetMonomorphicProperty();
   }
+
+  if (!instr->right()->IsString()) store->SetElementAccess();
 }
 
 
@@ -295,6 +387,13 @@ void LGen::VisitIf(HIRInstruction* instr) {
     return;
   }
 
+  if (instr->left()->representation() ==
+      HIRInstruction::kBooleanRepresentation) {
+    Bind(new LBranchBoolean())
+        ->AddArg(instr->left(), LUse::kRegister);
+    return;
+  }
+
   LInterval* lhs = ToFixed(instr->left(), rax);
   assert(instr->block()->succ_count() == 2);
 
@@ -66,7 +66,8 @@ void LEntry::Generate(Masm* masm) {
   __ mov(argc, rax);
 
   // Allocate context slots
-  __ AllocateContext(context_slots_);
+  // (functions without them are running in their parent's context)
+  if (context_slots_ != 0) __ AllocateContext(context_slots_);
 }
 
 
@@ -180,8 +181,32 @@ void LBranchNumber::Generate(Masm* masm) {
 }
 
 
+void LBranchBoolean::Generate(Masm* masm) {
+  // Value is definitely a boolean, no need to coerce it
+  __ IsTrue(inputs[0]->ToRegister(), TargetAt(1)->label, NULL);
+}
+
+
 void LLoadProperty::Generate(Masm* masm) {
   Label done;
+
+  // Typed cdata elements are loaded inline, without a map lookup
+  if (HasElementAccess()) {
+    Label property, slow;
+
+    __ IsUnboxed(rax, NULL, &property);
+    __ IsNil(rax, NULL, &property);
+    __ IsHeapObject(Heap::kTagCData, rax, &property, NULL);
+    __ LoadElement(&slow);
+    __ jmp(&done);
+
+    __ bind(&slow);
+    __ Call(masm->stubs()->GetLoadElementStub());
+    __ jmp(&done);
+
+    __ bind(&property);
+  }
+
   Masm::Spill rax_s(masm, rax);
 
   // rax <- object
@@ -208,13 +233,41 @@ void LLoadProperty::Generate(Masm* masm) {
 
 void LStoreProperty::Generate(Masm* masm) {
   Label done;
+
+  // Typed cdata elements are stored inline, without a map lookup
+  if (HasElementAccess()) {
+    Label property, slow;
+
+    __ IsUnboxed(rax, NULL, &property);
+    __ IsNil(rax, NULL, &property);
+    __ IsHeapObject(Heap::kTagCData, rax, &property, NULL);
+    __ StoreElement(&slow);
+    __ jmp(&done);
+
+    __ bind(&slow);
+    __ Call(masm->stubs()->GetStoreElementStub());
+    __ jmp(&done);
+
+    __ bind(&property);
+  }
+
   Masm::Spill rax_s(masm, rax);
   Masm::Spill rcx_s(masm, rcx);
 
   // rax <- object
   // rbx <- propery
-  // rcx <- value
-  __ mov(rcx, Immediate(1));
+  // rcx <- change flag, stores of non-nil values keep array's length exact
+  {
+    Label store_nil, flag_set;
+
+    __ IsNil(rcx, NULL, &store_nil);
+    __ mov(rcx, Immediate(HArray::kInsertNonNil));
+    __ jmp(&flag_set);
+    __ bind(&store_nil);
+    __ mov(rcx, Immediate(1));
+    __ bind(&flag_set);
+  }
+
   if (HasMonomorphicProperty()) {
     __ Call(masm->space()->CreatePIC());
   } else {
@@ -288,6 +341,14 @@ void LBinOp::Generate(Masm* masm) {
 }
 
 
+void LMath::Generate(Masm* masm) {
+  // rax <- lhs
+  // rbx <- rhs
+  __ Call(masm->stubs()->GetMathStub(HIRMath::Cast(hir())->math_type()));
+  // result -> rax
+}
+
+
 void LBinOpNumber::Generate(Masm* masm) {
   BinOp::BinOpType type = HIRBinOp::Cast(hir())->binop_type();
 
@@ -339,6 +400,160 @@ void LBinOpNumber::Generate(Masm* masm) {
   __ bind(&done);
 }
 
+// Leaves too large doubles to stubs: above 2^53 integers aren't exact in
+// double, while stubs compute smis without rounding.
+// NOTE: Zero results are left to stubs too, their sign depends on whether
+// operands were smis or not.
+static void CheckDouble(Masm* masm,
+                        DoubleRegister value,
+                        bool can_be_zero,
+                        Label* fail) {
+  __ movd(scratch, value);
+  __ shl(scratch, Immediate(1));
+  if (!can_be_zero) {
+    __ cmpq(scratch, Immediate(0));
+    __ jmp(kEq, fail);
+  }
+  __ shr(scratch, Immediate(53));
+  __ cmpq(scratch, Immediate(1023 + 53));
+  __ jmp(kAe, fail);
+}
+
+
+void LBinOpDouble::Generate(Masm* masm) {
+  static const Register temps[] = { r8, r9, r10, r11, r12, r13 };
+  static const DoubleRegister dtemps[] = {
+    xmm1, xmm2, xmm3, xmm4, xmm5, xmm6
+  };
+  Label doubles, stub_call, done;
+  int depth = 0;
+
+  // Every path starts from the tagged arguments
+  Masm::Spill a0(masm), a1(masm), a2(masm), a3(masm), a4(masm), a5(masm);
+  Masm::Spill* args[] = { &a0, &a1, &a2, &a3, &a4, &a5 };
+  for (int i = 0; i < input_count(); i++) {
+    args[i]->SpillReg(inputs[i]->ToRegister());
+  }
+
+  // All arguments are smis: same as BinOpNumber, but for the whole tree
+  if (!HasOp(BinOp::kDiv)) {
+    for (int i = 0; i < length(); i++) {
+      if (IsLeafAt(i)) {
+        args[LeafAt(i)]->Unspill(temps[depth]);
+        __ IsUnboxed(temps[depth], &doubles, NULL);
+        depth++;
+        continue;
+      }
+
+      Register right = temps[--depth];
+      Register left = temps[depth - 1];
+      switch (OpAt(i)) {
+        case BinOp::kAdd:
+          __ addq(left, right);
+          break;
+        case BinOp::kSub:
+          __ subq(left, right);
+          break;
+        case BinOp::kMul:
+          __ mov(rax, left);
+          __ Untag(rax);
+          __ imulq(right);
+          __ mov(left, rax);
+          break;
+        default:
+          UNEXPECTED
+      }
+      __ jmp(kOverflow, &stub_call);
+    }
+
+    __ mov(rax, temps[0]);
+    __ jmp(&done);
+  }
+
+  // Some of arguments are heap numbers: compute everything on doubles and
+  // box only the result
+  __ bind(&doubles);
+  depth = 0;
+  for (int i = 0; i < length(); i++) {
+    if (IsLeafAt(i)) {
+      Label heap_number, loaded;
+      DoubleRegister dst = dtemps[depth++];
+      Operand value(r8, HNumber::kValueOffset);
+
+      args[LeafAt(i)]->Unspill(r8);
+      __ IsUnboxed(r8, &heap_number, NULL);
+      __ Untag(r8);
+      __ xorqd(dst, dst);
+      __ cvtsi2sd(dst, r8);
+      __ jmp(&loaded);
+
+      __ bind(&heap_number);
+      __ IsNil(r8, NULL, &stub_call);
+      __ IsHeapObject(Heap::kTagNumber, r8, &stub_call, NULL);
+      __ movd(dst, value);
+
+      __ bind(&loaded);
+      CheckDouble(masm, dst, true, &stub_call);
+      continue;
+    }
+
+    DoubleRegister right = dtemps[--depth];
+    DoubleRegister left = dtemps[depth - 1];
+    switch (OpAt(i)) {
+      case BinOp::kAdd: __ addqd(left, right); break;
+      case BinOp::kSub: __ subqd(left, right); break;
+      case BinOp::kMul: __ mulqd(left, right); break;
+      case BinOp::kDiv: __ divqd(left, right); break;
+      default: UNEXPECTED
+    }
+    CheckDouble(masm, left, false, &stub_call);
+  }
+
+  __ xorq(r8, r8);
+  __ xorq(scratch, scratch);
+  __ NumberFromDouble(dtemps[0], dtemps[1], rax);
+  __ jmp(&done);
+
+  // Non-numbers, or results that need exact smi arithmetic:
+  // call stub for every node
+  __ bind(&stub_call);
+  __ xorq(rdx, rdx);
+  __ xorq(r8, r8);
+  __ xorq(scratch, scratch);
+
+  Masm::Spill s0(masm), s1(masm), s2(masm), s3(masm), s4(masm), s5(masm);
+  Masm::Spill* stack[] = { &s0, &s1, &s2, &s3, &s4, &s5 };
+  depth = 0;
+  for (int i = 0; i < length(); i++) {
+    if (IsLeafAt(i)) {
+      args[LeafAt(i)]->Unspill(rax);
+      stack[depth++]->SpillReg(rax);
+      continue;
+    }
+
+    char* stub = NULL;
+    switch (OpAt(i)) {
+      case BinOp::kAdd: stub = masm->stubs()->GetBinaryAddStub(); break;
+      case BinOp::kSub: stub = masm->stubs()->GetBinarySubStub(); break;
+      case BinOp::kMul: stub = masm->stubs()->GetBinaryMulStub(); break;
+      case BinOp::kDiv: stub = masm->stubs()->GetBinaryDivStub(); break;
+      default: UNEXPECTED
+    }
+
+    stack[--depth]->Unspill(rbx);
+    stack[depth - 1]->Unspill(rax);
+    __ Call(stub);
+    stack[depth - 1]->SpillReg(rax);
+  }
+
+  __ bind(&done);
+
+  // Don't leave untagged values for GC
+  __ xorq(rdx, rdx);
+  __ xorq(r8, r8);
+  __ xorq(scratch, scratch);
+}
+
 #undef BINARY_SUB_ENUM
 #undef BINARY_SUB_TYPES
 
@@ -559,13 +774,104 @@ void LNot::Generate(Masm* masm) {
 }
 
 
+void LMathCheck::Generate(Masm* masm) {
+  MathOp::MathOpType type = HIRMathCheck::Cast(hir())->math_type();
+  Register value = inputs[0]->ToRegister();
+  Register scratch = scratches[0]->ToRegister();
+  Register res = result->ToRegister();
+  Operand true_value(root_reg, HContext::GetIndexDisp(Heap::kRootTrueIndex));
+  Operand false_value(root_reg,
+                      HContext::GetIndexDisp(Heap::kRootFalseIndex));
+  Label mismatch, done;
+
+  __ IsNil(value, NULL, &mismatch);
+  __ IsUnboxed(value, NULL, &mismatch);
+  __ IsHeapObject(Heap::kTagFunction, value, &mismatch, NULL);
+
+  // Bindings of `math` module are the only functions with this code
+  Operand code(value, HFunction::kCodeOffset);
+  __ mov(scratch, Immediate(reinterpret_cast<intptr_t>(
+      MathOp::BindingCode(type))));
+  __ cmpq(scratch, code);
+  __ jmp(kNe, &mismatch);
+
+  __ mov(res, true_value);
+  __ jmp(&done);
+
+  __ bind(&mismatch);
+  __ mov(res, false_value);
+
+  __ bind(&done);
+}
+
+
 void LTypeof::Generate(Masm* masm) {
   __ Call(masm->stubs()->GetTypeofStub());
 }
 
 
+void LTypeCheck::Generate(Masm* masm) {
+  HIRTypeCheck* check = HIRTypeCheck::Cast(hir());
+  Register res = result->ToRegister();
+  Operand true_value(root_reg, HContext::GetIndexDisp(Heap::kRootTrueIndex));
+  Operand false_value(root_reg,
+                      HContext::GetIndexDisp(Heap::kRootFalseIndex));
+  Operand* match = check->negate() ? &false_value : &true_value;
+  Operand* mismatch = check->negate() ? &true_value : &false_value;
+
+  // Type is known from representation
+  if (input_count() == 0) {
+    __ mov(res, check->KnownTag() == check->tag() ? *match : *mismatch);
+    return;
+  }
+
+  Register value = inputs[0]->ToRegister();
+  Label is_match, is_mismatch, done;
+
+  __ IsNil(value, NULL, check->tag() == Heap::kTagNil ? &is_match :
+                                                        &is_mismatch);
+  if (check->tag() != Heap::kTagNil) {
+    // Unboxed values are numbers
+    __ IsUnboxed(value,
+                 NULL,
+                 check->tag() == Heap::kTagNumber ? &is_match : &is_mismatch);
+    __ IsHeapObject(check->tag(), value, &is_mismatch, NULL);
+  } else {
+    __ jmp(&is_mismatch);
+  }
+
+  __ bind(&is_match);
+  __ mov(res, *match);
+  __ jmp(&done);
+
+  __ bind(&is_mismatch);
+  __ mov(res, *mismatch);
+
+  __ bind(&done);
+}
+
+
 void LSizeof::Generate(Masm* masm) {
+  Label call_stub, done;
+
+  // Fast case: length of array without trailing nils is a field load
+  __ IsUnboxed(rax, NULL, &call_stub);
+  __ IsNil(rax, NULL, &call_stub);
+  __ IsHeapObject(Heap::kTagArray, rax, &call_stub, NULL);
+
+  Operand qrepr(rax, HValue::kRepresentationOffset);
+  __ cmpb(qrepr, Immediate(HArray::kExactLength));
+  __ jmp(kNe, &call_stub);
+
+  Operand qlength(rax, HArray::kLengthOffset);
+  __ mov(rax, qlength);
+  __ TagNumber(rax);
+  __ jmp(&done);
+
+  __ bind(&call_stub);
   __ Call(masm->stubs()->GetSizeofStub());
+
+  __ bind(&done);
 }
 
 
@@ -579,6 +885,11 @@ void LClone::Generate(Masm* masm) {
 }
 
 
+void LCloneLiteral::Generate(Masm* masm) {
+  __ Call(masm->stubs()->GetCloneLiteralStub());
+}
+
+
 void LCollectGarbage::Generate(Masm* masm) {
   __ Call(masm->stubs()->GetCollectGarbageStub());
 }
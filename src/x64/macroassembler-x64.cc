@@ -239,13 +239,267 @@ void Masm::AllocateContext(uint32_t slots) {
 
 
 void Masm::AllocateNumber(DoubleRegister value, Register result) {
+  // Runtime allocation may clobber xmm registers, keep value on stack
+  // (GC can't happen inside allocation, so it won't see raw bits there)
+  Operand spill(scratch, 0);
+  subqb(rsp, Immediate(16));
+  mov(scratch, rsp);
+  movd(spill, value);
+
   Allocate(Heap::kTagNumber, reg_nil, HNumber::kDoubleSize, result);
 
+  mov(scratch, rsp);
+  movd(value, spill);
+  xorq(scratch, scratch);
+  addqb(rsp, Immediate(16));
+
   Operand qvalue(result, HNumber::kValueOffset);
   movd(qvalue, value);
 }
 
 
+void Masm::NumberFromDouble(DoubleRegister value,
+                            DoubleRegister tmp,
+                            Register result) {
+  Label box, tag, done;
+
+  cvttsd2si(result, value);
+  xorqd(tmp, tmp);
+  cvtsi2sd(tmp, result);
+  ucomisd(value, tmp);
+  jmp(kNe, &box);
+
+  // NaN and infinities are truncated to INT64_MIN and fail this check too
+  mov(scratch, result);
+  TagNumber(scratch);
+  Untag(scratch);
+  cmpq(scratch, result);
+  jmp(kNe, &box);
+
+  // -0 can't be represented by smi
+  cmpq(result, Immediate(0));
+  jmp(kNe, &tag);
+  movd(scratch, value);
+  cmpq(scratch, Immediate(0));
+  jmp(kNe, &box);
+
+  bind(&tag);
+  TagNumber(result);
+  jmp(&done);
+
+  bind(&box);
+  xorq(result, result);
+  AllocateNumber(value, result);
+
+  bind(&done);
+}
+
+
+void Masm::TypedElementAddress(Label* out_of_bounds) {
+  Operand qrepr(rax, HValue::kRepresentationOffset);
+  Operand qsize(rax, HCData::kSizeOffset);
+
+  // Raw cdata has no elements
+  cmpb(qrepr, Immediate(HCData::kRaw));
+  jmp(kEq, out_of_bounds);
+
+  // log2 of element's size, two bits per element type
+  intptr_t shifts = 0;
+  for (int i = HCData::kInt8; i <= HCData::kFloat64; i++) {
+    shifts |= static_cast<intptr_t>(
+        HCData::ElementShift(static_cast<HCData::Representation>(i))) << (i * 2);
+  }
+
+  // rcx <- shift
+  movzxb(rdx, qrepr);
+  shl(rdx, Immediate(1));
+  mov(rcx, rdx);
+  mov(rdx, Immediate(shifts));
+  shr(rdx);
+  shl(rdx, Immediate(62));
+  shr(rdx, Immediate(62));
+  mov(rcx, rdx);
+
+  // Bounds check, negative keys are above length when compared unsigned
+  movl(rdx, qsize);
+  shr(rdx);
+  mov(scratch, rbx);
+  Untag(scratch);
+  cmpq(scratch, rdx);
+  jmp(kAe, out_of_bounds);
+
+  // rdx <- element's address - kDataOffset
+  shl(scratch);
+  mov(rdx, rax);
+  addq(rdx, scratch);
+  xorq(scratch, scratch);
+}
+
+
+void Masm::LoadElement(Label* slow) {
+  Label out_of_bounds, to_number, tag, boxed, done;
+  Operand qrepr(rax, HValue::kRepresentationOffset);
+  Operand elem(rdx, HCData::kDataOffset);
+
+  IsUnboxed(rbx, slow, NULL);
+  TypedElementAddress(&out_of_bounds);
+
+  for (int i = HCData::kInt8; i <= HCData::kFloat64; i++) {
+    HCData::Representation type = static_cast<HCData::Representation>(i);
+    Label next;
+
+    cmpb(qrepr, Immediate(type));
+    jmp(kNe, &next);
+
+    switch (type) {
+     case HCData::kInt8: movsxb(rcx, elem); break;
+     case HCData::kUint8: movzxb(rcx, elem); break;
+     case HCData::kInt16: movsxw(rcx, elem); break;
+     case HCData::kUint16: movzxw(rcx, elem); break;
+     case HCData::kInt32: movsxl(rcx, elem); break;
+     case HCData::kUint32: movl(rcx, elem); break;
+     case HCData::kInt64:
+     case HCData::kUint64:
+      // Values out of smi range are boxed by runtime
+      mov(rcx, elem);
+      mov(scratch, rcx);
+      TagNumber(scratch);
+      Untag(scratch);
+      cmpq(scratch, rcx);
+      jmp(kNe, &boxed);
+      if (type == HCData::kUint64) {
+        cmpq(rcx, Immediate(0));
+        jmp(kLt, &boxed);
+      }
+      break;
+     case HCData::kFloat32:
+      movss(xmm1, elem);
+      cvtss2sd(xmm1, xmm1);
+      jmp(&to_number);
+      break;
+     case HCData::kFloat64:
+      movd(xmm1, elem);
+      jmp(&to_number);
+      break;
+     default:
+      UNEXPECTED
+      break;
+    }
+    jmp(&tag);
+
+    bind(&next);
+  }
+
+  bind(&boxed);
+  xorq(rcx, rcx);
+  xorq(rdx, rdx);
+  xorq(scratch, scratch);
+  jmp(slow);
+
+  bind(&out_of_bounds);
+  mov(rax, Immediate(Heap::kTagNil));
+  jmp(&done);
+
+  bind(&tag);
+  mov(rax, rcx);
+  TagNumber(rax);
+  jmp(&done);
+
+  bind(&to_number);
+  xorq(rcx, rcx);
+  xorq(rdx, rdx);
+  NumberFromDouble(xmm1, xmm2, rax);
+
+  bind(&done);
+
+  // Cleanup interior pointers and untagged values
+  xorq(rcx, rcx);
+  xorq(rdx, rdx);
+  xorq(scratch, scratch);
+}
+
+
+void Masm::StoreElement(Label* slow) {
+  Label value_ok, heap_value, converted, done;
+  Operand qrepr(rax, HValue::kRepresentationOffset);
+  Operand qvalue(rcx, HNumber::kValueOffset);
+  Operand elem(rdx, HCData::kDataOffset);
+
+  // Only numbers are stored inline, runtime coerces everything else
+  IsUnboxed(rbx, slow, NULL);
+  IsUnboxed(rcx, NULL, &value_ok);
+  IsNil(rcx, NULL, slow);
+  IsHeapObject(Heap::kTagNumber, rcx, slow, NULL);
+
+  bind(&value_ok);
+
+  // rcx <- integral value, xmm1 <- double value
+  IsUnboxed(rcx, &heap_value, NULL);
+  Untag(rcx);
+  xorqd(xmm1, xmm1);
+  cvtsi2sd(xmm1, rcx);
+  jmp(&converted);
+
+  bind(&heap_value);
+  movd(xmm1, qvalue);
+  cvttsd2si(rcx, xmm1);
+
+  bind(&converted);
+
+  // Address computation needs rcx
+  movd(xmm2, rcx);
+  TypedElementAddress(&done);
+  movd(rcx, xmm2);
+
+  for (int i = HCData::kInt8; i <= HCData::kFloat64; i++) {
+    HCData::Representation type = static_cast<HCData::Representation>(i);
+    Label next;
+
+    cmpb(qrepr, Immediate(type));
+    jmp(kNe, &next);
+
+    switch (type) {
+     case HCData::kInt8:
+     case HCData::kUint8:
+      movb(elem, rcx);
+      break;
+     case HCData::kInt16:
+     case HCData::kUint16:
+      movw(elem, rcx);
+      break;
+     case HCData::kInt32:
+     case HCData::kUint32:
+      movl(elem, rcx);
+      break;
+     case HCData::kInt64:
+     case HCData::kUint64:
+      mov(elem, rcx);
+      break;
+     case HCData::kFloat32:
+      cvtsd2ss(xmm1, xmm1);
+      movss(elem, xmm1);
+      break;
+     case HCData::kFloat64:
+      movd(elem, xmm1);
+      break;
+     default:
+      UNEXPECTED
+      break;
+    }
+    jmp(&done);
+
+    bind(&next);
+  }
+
+  // Out-of-bounds stores are ignored
+  bind(&done);
+
+  // Cleanup interior pointers and untagged values
+  xorq(rcx, rcx);
+  xorq(rdx, rdx);
+  xorq(scratch, scratch);
+}
+
 void Masm::AllocateObjectLiteral(Heap::HeapTag tag,
                                  Register tag_reg,
                                  Register size,
@@ -663,9 +917,20 @@ void Masm::ProbeCPU() {
   push(rcx);
   push(rdx);
 
-  mov(rax, Immediate(0x01));
+  // rdi <- leaf
+  // rsi <- regs
+  mov(rax, rdi);
+  xorq(rcx, rcx);
   cpuid();
-  mov(rax, rcx);
+
+  Operand reax(rsi, 0);
+  Operand rebx(rsi, 4);
+  Operand recx(rsi, 8);
+  Operand redx(rsi, 12);
+  movl(reax, rax);
+  movl(rebx, rbx);
+  movl(recx, rcx);
+  movl(redx, rdx);
 
   pop(rdx);
   pop(rcx);
@@ -676,5 +941,24 @@ void Masm::ProbeCPU() {
   ret(0);
 }
 
+
+void Masm::ProbeXCR() {
+  push(rbp);
+  mov(rbp, rsp);
+
+  push(rcx);
+  push(rdx);
+
+  xorq(rcx, rcx);
+  xgetbv();
+
+  pop(rdx);
+  pop(rcx);
+
+  mov(rsp, rbp);
+  pop(rbp);
+  ret(0);
+}
+
 }  // namespace internal
 }  // namespace candor
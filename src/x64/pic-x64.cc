@@ -56,6 +56,15 @@ void PIC::Generate(Masm* masm) {
     __ mov(rdx, proto_op);
     __ cmpq(rdx, Immediate(Heap::kICDisabledValue));
     __ jmp(kEq, &miss);
+
+    // Stores into shared map should go through runtime (it'll copy map)
+    Label own_map;
+    Operand repr_op(rax, HValue::kRepresentationOffset);
+    __ cmpq(rcx, Immediate(0));
+    __ jmp(kEq, &own_map);
+    __ cmpb(repr_op, Immediate(HObject::kOwnMap));
+    __ jmp(kNe, &miss);
+    __ bind(&own_map);
   }
 
   for (int i = size_ - 1; i >= 0; i--) {
@@ -66,6 +75,13 @@ void PIC::Generate(Masm* masm) {
           masm->offset() - 8));
     __ cmpq(rdx, rbx);
     __ jmp(kNe, &local_miss);
+    if (stats_enabled_) {
+      // Count hit (rax and rbx are overwritten below)
+      __ mov(rax, Immediate(reinterpret_cast<intptr_t>(&hits_)));
+      __ mov(rbx, Operand(rax, 0));
+      __ inc(rbx);
+      __ mov(Operand(rax, 0), rbx);
+    }
     __ mov(rax, Immediate(results_[i]));
     __ xorq(rbx, rbx);
     __ mov(rsp, rbp);
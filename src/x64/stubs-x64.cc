@@ -28,6 +28,7 @@
 #include "macroassembler-inl.h"
 #include "runtime.h"
 #include "pic.h"
+#include "runtime-stats.h"  // RuntimeStats
 
 namespace candor {
 namespace internal {
@@ -43,6 +44,21 @@ BaseStub::BaseStub(CodeSpace* space, StubType type) : space_(space),
 void BaseStub::GeneratePrologue() {
   __ push(rbp);
   __ mov(rbp, rsp);
+
+  // Count invocations, preserving all registers
+  RuntimeStats* stats = space()->heap()->runtime_stats();
+  if (stats != NULL) {
+    intptr_t* counter = stats->stub_count(type());
+    __ push(rax);
+    __ push(rbx);
+    __ mov(rax, Immediate(reinterpret_cast<intptr_t>(counter)));
+    __ mov(rbx, Operand(rax, 0));
+    __ inc(rbx);
+    __ mov(Operand(rax, 0), rbx);
+    __ pop(rbx);
+    __ pop(rax);
+  }
+
   __ AllocateSpills();
 }
 
@@ -227,9 +243,10 @@ void AllocateStub::Generate() {
     Masm::Align a(masm());
     __ Pushad();
 
-    // Two arguments: heap, size
+    // Two arguments: heap, size (untagged)
     __ mov(rdi, heapref);
     __ mov(rsi, size);
+    __ Untag(rsi);
 
     __ mov(scratch, Immediate(*reinterpret_cast<intptr_t*>(&allocate)));
 
@@ -302,6 +319,128 @@ void CallBindingStub::Generate() {
   Operand argc(rbp, 24);
   Operand fn(rbp, 16);
 
+  // Fast bindings are called directly with unboxed arguments
+  Operand root(scratch, HFunction::kRootOffset);
+  Operand fast_code(rbx, HFunction::kFastCodeOffset);
+  Operand fast_type(rbx, HFunction::kFastTypeOffset);
+  Operand fast_argc(rbx, HFunction::kFastArgcOffset);
+
+  Label slow, integral, fast_done;
+
+  // Only fast bindings have root
+  __ mov(scratch, fn);
+  __ mov(rbx, root);
+  __ cmpqb(rbx, Immediate(0));
+  __ jmp(kEq, &slow);
+
+  // Arguments count should match signature
+  __ mov(rax, argc);
+  __ cmpq(rax, fast_argc);
+  __ jmp(kNe, &slow);
+
+  __ cmpq(fast_type, Immediate(HFunction::kFastIntegral));
+  __ jmp(kEq, &integral);
+
+  // double(double, ...)
+  DoubleRegister dregs[] = { xmm0, xmm1 };
+  for (uint32_t i = 0; i < HFunction::kMaxFastArgc; i++) {
+    Operand arg(rbp, 32 + i * HValue::kPointerSize);
+    Operand arg_value(rcx, HNumber::kValueOffset);
+    DoubleRegister dst = dregs[i];
+    Label heap_number, next;
+
+    __ cmpq(fast_argc, Immediate(HNumber::Tag(i)));
+    __ jmp(kLe, &next);
+
+    __ mov(rcx, arg);
+    __ IsUnboxed(rcx, &heap_number, NULL);
+    __ Untag(rcx);
+    __ xorqd(dst, dst);
+    __ cvtsi2sd(dst, rcx);
+    __ jmp(&next);
+
+    __ bind(&heap_number);
+    __ IsNil(rcx, NULL, &slow);
+    __ IsHeapObject(Heap::kTagNumber, rcx, &slow, NULL);
+    __ movd(dst, arg_value);
+
+    __ bind(&next);
+  }
+
+  {
+    Masm::Align a(masm());
+    __ Call(fast_code);
+  }
+
+  // Result is boxed only if it isn't integral
+  __ NumberFromDouble(xmm0, xmm1, rax);
+  __ jmp(&fast_done);
+
+  // int64_t(int64_t, ...)
+  __ bind(&integral);
+
+  Register tmp[] = { rdx, r8 };
+  Register regs[] = { rdi, rsi };
+  for (uint32_t i = 0; i < HFunction::kMaxFastArgc; i++) {
+    Operand arg(rbp, 32 + i * HValue::kPointerSize);
+    Label next;
+
+    __ cmpq(fast_argc, Immediate(HNumber::Tag(i)));
+    __ jmp(kLe, &next);
+
+    __ mov(tmp[i], arg);
+    __ IsUnboxed(tmp[i], &slow, NULL);
+    __ Untag(tmp[i]);
+
+    __ bind(&next);
+  }
+
+  // Move arguments to their places only after all checks, as
+  // slow path will push root and context registers on stack
+  for (uint32_t i = 0; i < HFunction::kMaxFastArgc; i++) {
+    __ mov(regs[i], tmp[i]);
+  }
+
+  {
+    Masm::Align a(masm());
+    __ Call(fast_code);
+  }
+
+  // Results that don't fit into unboxed number are boxed
+  Label overflow;
+
+  __ mov(rcx, rax);
+  __ TagNumber(rcx);
+  __ Untag(rcx);
+  __ cmpq(rcx, rax);
+  __ jmp(kNe, &overflow);
+
+  __ TagNumber(rax);
+  __ jmp(&fast_done);
+
+  __ bind(&overflow);
+  __ xorqd(xmm0, xmm0);
+  __ cvtsi2sd(xmm0, rax);
+  __ xorq(rax, rax);
+  __ AllocateNumber(xmm0, rax);
+
+  __ bind(&fast_done);
+
+  // Remove junk from registers, GC may see them on stack
+  __ xorq(rcx, rcx);
+  __ xorq(rdx, rdx);
+  __ xorq(rsi, rsi);
+  __ xorq(rdi, rdi);
+  __ xorq(r8, r8);
+  __ xorq(r9, r9);
+  __ xorq(r10, r10);
+  __ xorq(r11, r11);
+
+  __ CheckGC();
+  GenerateEpilogue(2);
+
+  __ bind(&slow);
+
   // Save all registers
   __ Pushad();
 
@@ -434,7 +573,7 @@ void KeysofStub::Generate() {
 void LookupPropertyStub::Generate() {
   GeneratePrologue();
 
-  Label is_object, is_array, cleanup, slow_case;
+  Label is_object, is_array, is_table, cleanup, slow_case;
   Label non_object_error, done;
 
   // rax <- object
@@ -450,10 +589,25 @@ void LookupPropertyStub::Generate() {
 
   // Or into non-object
   __ IsHeapObject(Heap::kTagObject, rax, NULL, &is_object);
-  __ IsHeapObject(Heap::kTagArray, rax, &non_object_error, &is_array);
+  __ IsHeapObject(Heap::kTagArray, rax, NULL, &is_array);
+  __ IsHeapObject(Heap::kTagHashMap, rax, NULL, &is_table);
+  __ IsHeapObject(Heap::kTagHashSet, rax, &non_object_error, &is_table);
 
   __ bind(&is_object);
 
+  // Stores into map shared with clone should copy it first
+  {
+    Label own_map;
+    Operand qrepr(rax, HValue::kRepresentationOffset);
+
+    __ cmpq(rcx, Immediate(0));
+    __ jmp(kEq, &own_map);
+    __ cmpb(qrepr, Immediate(HObject::kOwnMap));
+    __ jmp(kNe, &slow_case);
+
+    __ bind(&own_map);
+  }
+
   // Fast case: object and a string key
   {
     __ IsUnboxed(rbx, NULL, &slow_case);
@@ -550,18 +704,25 @@ void LookupPropertyStub::Generate() {
     // Apply mask
     __ andq(rsi, rdx);
 
-    // Check if length was increased
+    // Stores at or past the last element update length, it stays exact
+    // only if stored value is known to be non-nil
     Label length_set;
 
     Operand qlength(rax, HArray::kLengthOffset);
+    Operand qrepr(rax, HValue::kRepresentationOffset);
     __ mov(rdx, qlength);
     __ Untag(rbx);
     __ inc(rbx);
     __ cmpq(rbx, rdx);
-    __ jmp(kLe, &length_set);
+    __ jmp(kLt, &length_set);
+    __ cmpq(rcx, Immediate(0));
+    __ jmp(kEq, &length_set);
 
-    // Update length
     __ mov(qlength, rbx);
+    __ movb(qrepr, Immediate(HArray::kDirtyLength));
+    __ cmpq(rcx, Immediate(HArray::kInsertNonNil));
+    __ jmp(kNe, &length_set);
+    __ movb(qrepr, Immediate(HArray::kExactLength));
 
     __ bind(&length_set);
     // Rbx is untagged here - so nullify it
@@ -579,6 +740,104 @@ void LookupPropertyStub::Generate() {
     GenerateEpilogue(0);
   }
 
+  __ bind(&is_table);
+  // Fast case: map or set and a string key, that is either absent or
+  // stored under the same pointer
+  {
+    Label probe, next, hit, found, miss, table_slow;
+
+    __ IsUnboxed(rbx, NULL, &slow_case);
+    __ IsNil(rbx, NULL, &slow_case);
+    __ IsHeapObject(Heap::kTagString, rbx, &slow_case, NULL);
+
+    // Buckets keep hash in their upper half
+    __ StringHash(rbx, rdx);
+    __ shl(rdx, Immediate(32));
+
+    // rsi = bucket's offset in index
+    Operand qmask(rax, HHashTable::kMaskOffset);
+    __ mov(rsi, rdx);
+    __ shr(rsi, Immediate(29));
+    __ mov(scratch, qmask);
+    __ andq(rsi, scratch);
+
+    __ bind(&probe);
+
+    Operand qindex(rax, HHashTable::kIndexOffset);
+    Operand bucket(scratch, HCData::kDataOffset);
+    __ mov(scratch, qindex);
+    __ addq(scratch, rsi);
+    __ mov(scratch, bucket);
+
+    // Empty bucket - there's no such key
+    __ cmpq(scratch, Immediate(0));
+    __ jmp(kEq, &miss);
+
+    // rcx = entry + 1, if hashes are equal
+    __ mov(rcx, scratch);
+    __ xorq(rcx, rdx);
+    __ mov(scratch, rcx);
+    __ shr(scratch, Immediate(32));
+    __ cmpq(scratch, Immediate(0));
+    __ jmp(kNe, &next);
+
+    // Compare key with entry's one
+    Operand qentries(rax, HHashTable::kEntriesOffset);
+    Operand key(scratch, HMap::kSpaceOffset - 2 * HValue::kPointerSize);
+    __ shl(rcx, Immediate(4));
+    __ mov(scratch, qentries);
+    __ addq(scratch, rcx);
+    __ mov(scratch, key);
+    __ cmpq(scratch, rbx);
+    __ jmp(kEq, &hit);
+
+    // Entry was deleted, or it's the same string at other address
+    __ IsNil(scratch, &table_slow, NULL);
+
+    __ bind(&next);
+    __ addqb(rsi, Immediate(sizeof(uint64_t)));
+    __ mov(scratch, qmask);
+    __ andq(rsi, scratch);
+    __ jmp(&probe);
+
+    __ bind(&hit);
+
+    // Stores into set only add the key, runtime handles them
+    change_s.Unspill(scratch);
+    __ cmpq(scratch, Immediate(0));
+    __ jmp(kEq, &found);
+    __ IsHeapObject(Heap::kTagHashSet, rax, NULL, &table_slow);
+
+    __ bind(&found);
+
+    // rax = value's offset
+    __ mov(rax, rcx);
+    __ addqb(rax, Immediate(HMap::kSpaceOffset - HValue::kPointerSize));
+
+    // Cleanup
+    change_s.Unspill();
+    __ xorq(rdx, rdx);
+    rsi_s.Unspill();
+
+    // Return value
+    GenerateEpilogue(0);
+
+    __ bind(&miss);
+
+    // Insertion is done by runtime
+    change_s.Unspill();
+    __ cmpq(rcx, Immediate(0));
+    __ jmp(kNe, &cleanup);
+
+    __ xorq(rdx, rdx);
+    rsi_s.Unspill();
+    __ jmp(&non_object_error);
+
+    __ bind(&table_slow);
+    change_s.Unspill();
+    __ jmp(&cleanup);
+  }
+
   __ bind(&cleanup);
 
   rsi_s.Unspill();
@@ -614,6 +873,76 @@ void LookupPropertyStub::Generate() {
 }
 
 
+void LoadElementStub::Generate() {
+  GeneratePrologue();
+
+  Label call_runtime, done;
+
+  // rax <- typed cdata
+  // rbx <- key
+  __ LoadElement(&call_runtime);
+  __ jmp(&done);
+
+  __ bind(&call_runtime);
+  {
+    Masm::Align a(masm());
+    __ Pushad();
+
+    RuntimeLoadElementCallback loadc = &RuntimeLoadElement;
+
+    // RuntimeLoadElement(heap, cdata, key)
+    __ mov(rdi, Immediate(reinterpret_cast<intptr_t>(masm()->heap())));
+    __ mov(rsi, rax);
+    __ mov(rdx, rbx);
+    __ mov(scratch, Immediate(*reinterpret_cast<intptr_t*>(&loadc)));
+    __ callq(scratch);
+
+    __ Popad(rax);
+  }
+
+  __ bind(&done);
+
+  __ CheckGC();
+
+  GenerateEpilogue(0);
+}
+
+
+void StoreElementStub::Generate() {
+  GeneratePrologue();
+
+  Label call_runtime, done;
+
+  // rax <- typed cdata
+  // rbx <- key
+  // rcx <- value
+  __ StoreElement(&call_runtime);
+  __ jmp(&done);
+
+  __ bind(&call_runtime);
+  {
+    Masm::Align a(masm());
+    __ Pushad();
+
+    RuntimeStoreElementCallback storec = &RuntimeStoreElement;
+
+    // RuntimeStoreElement(heap, cdata, key, value)
+    __ mov(rdi, Immediate(reinterpret_cast<intptr_t>(masm()->heap())));
+    __ mov(rsi, rax);
+    __ mov(rdx, rbx);
+    // rcx already contains value
+    __ mov(scratch, Immediate(*reinterpret_cast<intptr_t*>(&storec)));
+    __ callq(scratch);
+
+    __ Popad(reg_nil);
+  }
+
+  __ bind(&done);
+
+  GenerateEpilogue(0);
+}
+
+
 void PICMissStub::Generate() {
   GeneratePrologue();
 
@@ -699,66 +1028,119 @@ void CloneObjectStub::Generate() {
   __ IsNil(rax, NULL, &non_object);
   __ IsHeapObject(Heap::kTagObject, rax, &non_object, NULL);
 
-  // Get map
+  // Allocate new object without a map (mask + map + proto)
+  __ Allocate(Heap::kTagObject, reg_nil, 3 * HValue::kPointerSize, rdx);
+
+  // Clone points to the source's map, the first store into any of them
+  // will copy it (see RuntimeLookupProperty)
+  Operand qmask(rax, HObject::kMaskOffset);
   Operand qmap(rax, HObject::kMapOffset);
-  __ mov(rax, qmap);
+  Operand qrepr(rax, HValue::kRepresentationOffset);
+  Operand qmask_rdx(rdx, HObject::kMaskOffset);
+  Operand qmap_rdx(rdx, HObject::kMapOffset);
+  Operand qproto_rdx(rdx, HObject::kProtoOffset);
+  Operand qrepr_rdx(rdx, HValue::kRepresentationOffset);
 
-  // Get size
-  Operand qsize(rax, HMap::kSizeOffset);
-  __ mov(rcx, qsize);
+  __ mov(scratch, qmask);
+  __ mov(qmask_rdx, scratch);
+  __ mov(scratch, qmap);
+  __ mov(qmap_rdx, scratch);
 
-  __ TagNumber(rcx);
+  // Set proto
+  __ mov(qproto_rdx, scratch);
+  __ xorq(scratch, scratch);
+
+  __ movb(qrepr, Immediate(HObject::kSharedMap));
+  __ movb(qrepr_rdx, Immediate(HObject::kSharedMap));
+
+  __ mov(rax, rdx);
+  __ xorq(rdx, rdx);
+
+  __ jmp(&done);
+  __ bind(&non_object);
+
+  __ mov(rcx, Immediate(HNumber::Tag(16)));
 
   // Allocate new object
-  __ AllocateObjectLiteral(Heap::kTagObject, reg_nil, rcx, rdx);
+  __ AllocateObjectLiteral(Heap::kTagObject, reg_nil, rcx, rax);
 
-  __ mov(rbx, rdx);
+  __ bind(&done);
 
-  // Get new object's map
-  Operand qmap_rbx(rbx, HObject::kMapOffset);
-  __ mov(rbx, qmap_rbx);
+  GenerateEpilogue(0);
+}
 
-  // Set proto
-  Operand qproto(rdx, HObject::kProtoOffset);
-  __ mov(qproto, rax);
+
+void CloneLiteralStub::Generate() {
+  GeneratePrologue();
+
+  // rax <- boilerplate (object or array)
+  Operand qtag(rax, HValue::kTagOffset);
+  Operand qrepr(rax, HValue::kRepresentationOffset);
+  Operand qmap(rax, HObject::kMapOffset);
+  Operand qlength(rax, HArray::kLengthOffset);
+  Operand qrepr_rdx(rdx, HValue::kRepresentationOffset);
+  Operand qmap_rdx(rdx, HObject::kMapOffset);
+  Operand qproto_rdx(rdx, HObject::kProtoOffset);
+  Operand qlength_rdx(rdx, HArray::kLengthOffset);
+  Operand qsize(rbx, HMap::kSizeOffset);
+
+  // Allocate object of the same type with a map of the same size
+  __ mov(rbx, qmap);
+  __ mov(rcx, qsize);
+  __ TagNumber(rcx);
+  __ movzxb(rbx, qtag);
+  __ TagNumber(rbx);
+
+  __ AllocateObjectLiteral(Heap::kTagNil, rbx, rcx, rdx);
+
+  Label is_array, copy;
+
+  __ mov(rbx, qmap);
+  __ IsHeapObject(Heap::kTagArray, rax, NULL, &is_array);
+
+  // All copies of boilerplate share its layout
+  __ mov(qproto_rdx, rbx);
+  __ jmp(&copy);
+
+  __ bind(&is_array);
+  __ mov(rcx, qlength);
+  __ mov(qlength_rdx, rcx);
+  __ movzxb(rcx, qrepr);
+  __ movb(qrepr_rdx, rcx);
+
+  __ bind(&copy);
+
+  // Copy both keys and values
+  __ mov(rcx, qmap_rdx);
+  __ mov(rax, qsize);
+  __ shl(rax, Immediate(1));
 
   // Skip headers
-  __ addqb(rax, Immediate(HMap::kSpaceOffset));
   __ addqb(rbx, Immediate(HMap::kSpaceOffset));
+  __ addqb(rcx, Immediate(HMap::kSpaceOffset));
 
-  // NOTE: rcx is tagged here
-
-  // Copy all fields from it
-  Label loop_start, loop_cond;
-  __ jmp(&loop_cond);
-  __ bind(&loop_start);
+  Label loop;
+  __ bind(&loop);
 
-  Operand from(rax, 0), to(rbx, 0);
+  Operand from(rbx, 0), to(rcx, 0);
   __ mov(scratch, from);
   __ mov(to, scratch);
 
   // Move forward
-  __ addqb(rax, Immediate(8));
-  __ addqb(rbx, Immediate(8));
+  __ addqb(rbx, Immediate(HValue::kPointerSize));
+  __ addqb(rcx, Immediate(HValue::kPointerSize));
 
-  __ dec(rcx);
-
-  // Loop
-  __ bind(&loop_cond);
-  __ cmpq(rcx, Immediate(0));
-  __ jmp(kNe, &loop_start);
+  __ dec(rax);
+  __ cmpq(rax, Immediate(0));
+  __ jmp(kNe, &loop);
 
   __ mov(rax, rdx);
 
-  __ jmp(&done);
-  __ bind(&non_object);
-
-  __ mov(rcx, Immediate(HNumber::Tag(16)));
-
-  // Allocate new object
-  __ AllocateObjectLiteral(Heap::kTagObject, reg_nil, rcx, rax);
-
-  __ bind(&done);
+  // Cleanup interior pointers
+  __ xorq(scratch, scratch);
+  __ xorq(rbx, rbx);
+  __ xorq(rcx, rcx);
+  __ xorq(rdx, rdx);
 
   GenerateEpilogue(0);
 }
@@ -968,6 +1350,33 @@ void BinOpStub::Generate() {
   __ IsNil(rax, NULL, &call_runtime);
   __ IsNil(rbx, NULL, &call_runtime);
 
+  Label math_op, box_lhs;
+  if (BinOp::is_math(type())) {
+    // Load numbers right into xmm registers, without boxing smis
+    Register sides[] = { rax, rbx };
+    DoubleRegister values[] = { xmm1, xmm2 };
+    for (int i = 0; i < 2; i++) {
+      Label heap_number, loaded;
+      Operand value(sides[i], HNumber::kValueOffset);
+
+      __ IsUnboxed(sides[i], &heap_number, NULL);
+      __ mov(scratch, sides[i]);
+      __ Untag(scratch);
+      __ xorqd(values[i], values[i]);
+      __ cvtsi2sd(values[i], scratch);
+      __ xorq(scratch, scratch);
+      __ jmp(&loaded);
+
+      __ bind(&heap_number);
+      __ IsHeapObject(Heap::kTagNumber, sides[i], &box_lhs, NULL);
+      __ movd(values[i], value);
+      __ bind(&loaded);
+    }
+    __ jmp(&math_op);
+  }
+
+  __ bind(&box_lhs);
+
   // Convert lhs to heap number if needed
   __ IsUnboxed(rax, &box_rhs, NULL);
 
@@ -1013,6 +1422,7 @@ void BinOpStub::Generate() {
   __ xorq(rbx, rbx);
 
   if (BinOp::is_math(type())) {
+    __ bind(&math_op);
     switch (type()) {
      case BinOp::kAdd: __ addqd(xmm1, xmm2); break;
      case BinOp::kSub: __ subqd(xmm1, xmm2); break;
@@ -1021,7 +1431,8 @@ void BinOpStub::Generate() {
      default: __ emitb(0xcc); break;
     }
 
-    __ AllocateNumber(xmm1, rax);
+    // Return integral results unboxed, if they fit into smi
+    __ NumberFromDouble(xmm1, xmm2, rax);
   } else if (BinOp::is_binary(type())) {
     // Truncate lhs and rhs first
     __ cvttsd2si(rax, xmm1);
@@ -1130,6 +1541,226 @@ void BinOpStub::Generate() {
 #undef BINARY_SUB_TYPES
 
 
+#define MATH_SUB_TYPES(V)\
+    V(Floor)\
+    V(Ceil)\
+    V(Round)\
+    V(Sqrt)\
+    V(Abs)\
+    V(Min)\
+    V(Max)\
+    V(Pow)\
+    V(Exp)\
+    V(Log)\
+    V(Sin)\
+    V(Cos)\
+    V(Tan)
+
+void MathStub::Generate() {
+  GeneratePrologue();
+
+  Label call_runtime, done;
+  bool binary = MathOp::argc(type()) == 2;
+
+  // rax <- lhs
+  // rbx <- rhs (only for binary functions)
+  if (!binary) __ xorq(rbx, rbx);
+
+  // libm is always called for transcendental functions
+  if (!MathOp::is_transcendental(type())) {
+    Label lhs_boxed, both_unboxed, lhs_loaded;
+
+    __ IsNil(rax, NULL, &call_runtime);
+    __ IsUnboxed(rax, &lhs_boxed, NULL);
+    if (binary) {
+      __ IsNil(rbx, NULL, &call_runtime);
+      __ IsUnboxed(rbx, &lhs_boxed, &both_unboxed);
+    } else {
+      __ jmp(&both_unboxed);
+    }
+
+    // Fast case: smi arguments
+    __ bind(&both_unboxed);
+    switch (type()) {
+     case MathOp::kFloor:
+     case MathOp::kCeil:
+     case MathOp::kRound:
+      __ jmp(&done);
+      break;
+     case MathOp::kAbs:
+      __ cmpq(rax, Immediate(0));
+      __ jmp(kGe, &done);
+      __ subq(rbx, rax);
+      __ jmp(kOverflow, &call_runtime);
+      __ mov(rax, rbx);
+      __ jmp(&done);
+      break;
+     case MathOp::kMin:
+     case MathOp::kMax:
+      __ cmpq(rax, rbx);
+      __ jmp(type() == MathOp::kMin ? kLe : kGe, &done);
+      __ mov(rax, rbx);
+      __ jmp(&done);
+      break;
+     default:
+      // Compute in doubles
+      break;
+    }
+
+    // Load arguments into xmm1 and xmm2
+    __ bind(&lhs_boxed);
+
+    Operand lvalue(rax, HNumber::kValueOffset);
+    Operand rvalue(rbx, HNumber::kValueOffset);
+    Label lhs_heap, rhs_heap, rhs_loaded;
+
+    __ IsUnboxed(rax, &lhs_heap, NULL);
+    __ mov(scratch, rax);
+    __ Untag(scratch);
+    __ xorqd(xmm1, xmm1);
+    __ cvtsi2sd(xmm1, scratch);
+    __ jmp(&lhs_loaded);
+
+    __ bind(&lhs_heap);
+    __ IsHeapObject(Heap::kTagNumber, rax, &call_runtime, NULL);
+    __ movd(xmm1, lvalue);
+
+    __ bind(&lhs_loaded);
+    if (binary) {
+      __ IsUnboxed(rbx, &rhs_heap, NULL);
+      __ mov(scratch, rbx);
+      __ Untag(scratch);
+      __ xorqd(xmm2, xmm2);
+      __ cvtsi2sd(xmm2, scratch);
+      __ jmp(&rhs_loaded);
+
+      __ bind(&rhs_heap);
+      __ IsNil(rbx, NULL, &call_runtime);
+      __ IsHeapObject(Heap::kTagNumber, rbx, &call_runtime, NULL);
+      __ movd(xmm2, rvalue);
+
+      __ bind(&rhs_loaded);
+    }
+
+    switch (type()) {
+     case MathOp::kFloor:
+     case MathOp::kCeil:
+     case MathOp::kRound:
+      // roundsd is a part of SSE4.1
+      if (!CPU::HasSSE4_1()) {
+        __ jmp(&call_runtime);
+        break;
+      }
+
+      if (type() == MathOp::kRound) {
+        // ceil(x) if x - floor(x) >= 0.5, floor(x) otherwise.
+        // (`floor(x + 0.5)` is off for 0.49999999999999994 and loses -0)
+        Label use_floor, rounded;
+        double half = 0.5;
+
+        __ roundsd(xmm2, xmm1, kRoundDown);
+        __ roundsd(xmm3, xmm1, kRoundUp);
+        __ subqd(xmm1, xmm2);
+        __ mov(scratch, Immediate(*reinterpret_cast<intptr_t*>(&half)));
+        __ movd(xmm4, scratch);
+        __ ucomisd(xmm1, xmm4);
+        __ jmp(kBelow, &use_floor);
+        __ movd(scratch, xmm3);
+        __ jmp(&rounded);
+        __ bind(&use_floor);
+        __ movd(scratch, xmm2);
+        __ bind(&rounded);
+        __ movd(xmm1, scratch);
+      } else {
+        __ roundsd(xmm1,
+                   xmm1,
+                   type() == MathOp::kCeil ? kRoundUp : kRoundDown);
+      }
+      break;
+     case MathOp::kSqrt:
+      __ sqrtqd(xmm1, xmm1);
+      break;
+     case MathOp::kAbs:
+      // Clear sign bit
+      __ movd(scratch, xmm1);
+      __ shl(scratch, Immediate(1));
+      __ shr(scratch, Immediate(1));
+      __ movd(xmm1, scratch);
+      break;
+     case MathOp::kMin:
+     case MathOp::kMax:
+      {
+        // Return one of arguments, unordered comparison keeps lhs
+        Label select_rhs;
+        if (type() == MathOp::kMin) {
+          __ ucomisd(xmm1, xmm2);
+        } else {
+          __ ucomisd(xmm2, xmm1);
+        }
+        __ jmp(kAbove, &select_rhs);
+        __ jmp(&done);
+        __ bind(&select_rhs);
+        __ mov(rax, rbx);
+        __ jmp(&done);
+      }
+      break;
+     default:
+      UNEXPECTED
+      break;
+    }
+
+    if (!MathOp::is_selection(type())) {
+      __ xorq(rbx, rbx);
+      __ NumberFromDouble(xmm1, xmm2, rax);
+      __ jmp(&done);
+    }
+  }
+
+  __ bind(&call_runtime);
+
+  RuntimeMathCallback cb;
+
+#define MATH_ENUM_CASES(V)\
+    case MathOp::k##V: cb = &RuntimeMath<MathOp::k##V>; break;
+
+  switch (type()) {
+    MATH_SUB_TYPES(MATH_ENUM_CASES)
+    default:
+      UNEXPECTED
+      break;
+  }
+#undef MATH_ENUM_CASES
+
+  {
+    Masm::Align a(masm());
+    __ Pushad();
+
+    Immediate heapref(reinterpret_cast<intptr_t>(masm()->heap()));
+
+    // math(heap, lhs, rhs)
+    __ mov(rdi, heapref);
+    __ mov(rsi, rax);
+    __ mov(rdx, rbx);
+
+    __ mov(scratch, Immediate(*reinterpret_cast<intptr_t*>(&cb)));
+    __ callq(scratch);
+
+    __ Popad(rax);
+  }
+
+  __ bind(&done);
+
+  // Cleanup
+  __ xorq(rbx, rbx);
+
+  __ CheckGC();
+
+  GenerateEpilogue(0);
+}
+
+#undef MATH_SUB_TYPES
+
+
 void LoadVarArgStub::Generate() {
   __ mov(rdx, rbp);
   GeneratePrologue();
@@ -1138,13 +1769,9 @@ void LoadVarArgStub::Generate() {
   Register offset = rax;
   Register rest = rbx;
   Register arr = rcx;
-  Masm::Spill rbp_s(masm(), rdx);
   Operand argc(rdx, -HValue::kPointerSize * 2);
-  Operand qmap(arr, HObject::kMapOffset);
-  Operand slot(scratch, 0);
-  Operand stack_slot(offset, 0);
 
-  Label loop, preloop, end;
+  Label end;
 
   // Calculate length of vararg array
   __ mov(scratch, offset);
@@ -1154,69 +1781,37 @@ void LoadVarArgStub::Generate() {
   __ cmpq(scratch, argc);
   __ jmp(kGe, &end);
 
-  // rdx = argc - offset - rest
-  __ mov(rdx, argc);
-  __ subq(rdx, scratch);
-
-  // Array index
-  __ mov(rbx, Immediate(HNumber::Tag(0)));
-
-  Masm::Spill arr_s(masm(), arr), rdx_s(masm());
-  Masm::Spill offset_s(masm(), offset), rbx_s(masm());
+  // rbx = argc - offset - rest
+  __ mov(rbx, argc);
+  __ subq(rbx, scratch);
 
-  __ bind(&loop);
+  // rdx = address of the first argument that goes into array
+  __ addqb(offset, Immediate(HNumber::Tag(2)));
+  __ shl(offset, Immediate(2));
+  __ addq(rdx, offset);
 
-  // while (rdx > 0)
-  __ cmpq(rdx, Immediate(HNumber::Tag(0)));
-  __ jmp(kEq, &end);
+  Masm::Spill arr_s(masm(), arr);
 
-  rdx_s.SpillReg(rdx);
-  rbx_s.SpillReg(rbx);
+  __ Pushad();
 
-  __ mov(rax, arr);
+  RuntimeLoadVarArgCallback load = &RuntimeLoadVarArg;
 
-  // rax <- object
-  // rbx <- property
-  __ mov(rcx, Immediate(1));
-  __ Call(masm()->stubs()->GetLookupPropertyStub());
+  // RuntimeLoadVarArg(heap, arr, args, count)
+  __ mov(rdi, Immediate(reinterpret_cast<intptr_t>(masm()->heap())));
+  __ mov(rsi, arr);
+  // rdx already contains args
+  __ mov(rcx, rbx);
+  __ mov(rax, Immediate(*reinterpret_cast<intptr_t*>(&load)));
+  __ callq(rax);
 
-  arr_s.Unspill();
-  rbx_s.Unspill();
+  __ Popad(reg_nil);
 
-  // Make rax look like unboxed number to GC
-  __ dec(rax);
+  // Array might have grown, stack pointers shouldn't be visible to GC
+  __ xorq(rax, rax);
+  __ xorq(rdx, rdx);
   __ CheckGC();
-  __ inc(rax);
-
-  __ IsNil(rax, NULL, &preloop);
-
-  __ mov(arr, qmap);
-  __ addq(rax, arr);
-  __ mov(scratch, rax);
-
-  // Get stack offset
-  offset_s.Unspill();
-  __ addqb(offset, Immediate(HNumber::Tag(2)));
-  __ addq(offset, rbx);
-  __ shl(offset, Immediate(2));
-  __ addq(offset, *rbp_s.GetOperand());
-  __ mov(offset, stack_slot);
-
-  // Put argument in array
-  __ mov(slot, offset);
-
   arr_s.Unspill();
 
-  __ bind(&preloop);
-
-  // Increment array index
-  __ addqb(rbx, Immediate(HNumber::Tag(1)));
-
-  // rdx --
-  rdx_s.Unspill();
-  __ subqb(rdx, Immediate(HNumber::Tag(1)));
-  __ jmp(&loop);
-
   __ bind(&end);
 
   // Cleanup?
@@ -1233,107 +1828,31 @@ void StoreVarArgStub::Generate() {
   GeneratePrologue();
 
   Register varg = rax;
-  Register index = rbx;
-  Register map = rcx;
   Register stack = rdx;
-  Operand stack_slot(stack, 0);
 
   // rax <- varg
-  Label loop, not_array, odd_end, r1_nil, r2_nil;
-  Masm::Spill index_s(masm()), map_s(masm()), array_s(masm()), r1(masm());
-  Masm::Spill stack_s(masm(), stack);
-  Operand slot(rax, 0);
+  Label not_array;
 
   __ IsUnboxed(varg, NULL, &not_array);
   __ IsNil(varg, NULL, &not_array);
   __ IsHeapObject(Heap::kTagArray, varg, &not_array, NULL);
 
-  Operand qmap(varg, HObject::kMapOffset);
-  __ mov(map, qmap);
-  map_s.SpillReg(map);
-
-  // index = sizeof(array)
-  Operand qlength(varg, HArray::kLengthOffset);
-  __ mov(index, qlength);
-  __ TagNumber(index);
-
-  // while ...
-  __ bind(&loop);
-
-  array_s.SpillReg(varg);
-
-  // while ... (index != 0) {
-  __ cmpq(index, Immediate(HNumber::Tag(0)));
-  __ jmp(kEq, &not_array);
-
-  // index--;
-  __ subqb(index, Immediate(HNumber::Tag(1)));
-
-  index_s.SpillReg(index);
-
-  // odd case: array[index]
-  __ mov(rbx, index);
-  __ mov(rcx, Immediate(0));
-  __ Call(masm()->stubs()->GetLookupPropertyStub());
-
-  __ IsNil(rax, NULL, &r1_nil);
-  map_s.Unspill();
-  __ addq(rax, map);
-  __ mov(rax, slot);
-
-  __ bind(&r1_nil);
-  r1.SpillReg(rax);
-
-  index_s.Unspill();
-
-  // if (index == 0) goto odd_end;
-  __ cmpq(index, Immediate(HNumber::Tag(0)));
-  __ jmp(kEq, &odd_end);
-
-  // index--;
-  __ subqb(index, Immediate(HNumber::Tag(1)));
-
-  array_s.Unspill();
-  index_s.SpillReg(index);
-
-  // even case: array[index]
-  __ mov(rbx, index);
-  __ mov(rcx, Immediate(0));
-  __ Call(masm()->stubs()->GetLookupPropertyStub());
-
-  __ IsNil(rax, NULL, &r2_nil);
-  map_s.Unspill();
-  __ addq(rax, map);
-  __ mov(rax, slot);
-
-  __ bind(&r2_nil);
-
-  // Push two item at the same time (to preserve alignment)
-  r1.Unspill(index);
-  stack_s.Unspill();
-  __ mov(stack_slot, index);
-  __ subqb(stack, Immediate(8));
-  __ mov(stack_slot, rax);
-  __ subqb(stack, Immediate(8));
-  stack_s.SpillReg(stack);
-
-  index_s.Unspill();
-  array_s.Unspill();
+  __ Pushad();
 
-  __ jmp(&loop);
+  RuntimeStoreVarArgCallback store = &RuntimeStoreVarArg;
 
-  // }
-  __ bind(&odd_end);
+  // RuntimeStoreVarArg(heap, varg, stack)
+  __ mov(rdi, Immediate(reinterpret_cast<intptr_t>(masm()->heap())));
+  __ mov(rsi, varg);
+  // rdx already contains stack
+  __ mov(rax, Immediate(*reinterpret_cast<intptr_t*>(&store)));
+  __ callq(rax);
 
-  r1.Unspill(rax);
-  stack_s.Unspill();
-  __ mov(stack_slot, rax);
-  __ subqb(stack, Immediate(8));
-  stack_s.SpillReg(stack);
+  __ Popad(reg_nil);
 
   __ bind(&not_array);
 
-  __ xorl(map, map);
+  __ xorl(stack, stack);
   GenerateEpilogue(0);
 }
 
@@ -0,0 +1,183 @@
+#include "test.h"
+#include <code-space.h>
+#include <parser.h>
+#include <scope.h>
+#include <utils.h>
+
+#include <stdarg.h>
+
+// Growable buffer for generated sources
+class Source {
+ public:
+  Source() : size_(1024), length_(0) {
+    data_ = new char[size_];
+  }
+
+  ~Source() {
+    delete[] data_;
+  }
+
+  void Append(const char* format, ...) {
+    va_list args;
+    while (true) {
+      va_start(args, format);
+      int written = vsnprintf(data_ + length_, size_ - length_, format, args);
+      va_end(args);
+
+      if (length_ + written < size_) {
+        length_ += written;
+        return;
+      }
+
+      char* data = new char[size_ << 1];
+      memcpy(data, data_, length_);
+      delete[] data_;
+      data_ = data;
+      size_ <<= 1;
+    }
+  }
+
+  inline const char* data() { return data_; }
+  inline uint32_t length() { return length_; }
+
+ private:
+  char* data_;
+  uint32_t size_;
+  uint32_t length_;
+};
+
+
+static void ManyFunctions(Source* src, int scale) {
+  for (int i = 0; i < 100 * scale; i++) {
+    src->Append("f%d(a, b) {\n  return a + b * %d\n}\n", i, i);
+  }
+  src->Append("x = 0\n");
+  for (int i = 0; i < 100 * scale; i++) {
+    src->Append("x = f%d(x, %d)\n", i, i);
+  }
+  src->Append("return x\n");
+}
+
+
+static void HugeFunction(Source* src, int scale) {
+  src->Append("x0 = 0\n");
+  for (int i = 1; i < 500 * scale; i++) {
+    src->Append("x%d = x%d + %d\n", i % 64, (i - 1) % 64, i);
+  }
+  src->Append("return x0\n");
+}
+
+
+static void DeepNesting(Source* src, int scale) {
+  int depth = 20 * scale;
+  src->Append("x = 0\n");
+  for (int i = 0; i < depth; i++) {
+    src->Append("if (x < %d) {\n  x = x + 1\n", i + 1);
+  }
+  for (int i = 0; i < depth; i++) src->Append("}\n");
+  src->Append("return x\n");
+}
+
+
+static void IfElseChain(Source* src, int scale) {
+  src->Append("test(x) {\n  if (x == 0) {\n    return 0\n");
+  for (int i = 1; i < 100 * scale; i++) {
+    src->Append("  } else if (x == %d) {\n    return %d\n", i, i);
+  }
+  src->Append("  }\n  return -1\n}\nreturn test(7)\n");
+}
+
+
+static void BigObjectLiteral(Source* src, int scale) {
+  src->Append("o = {\n");
+  for (int i = 0; i < 100 * scale; i++) {
+    src->Append("  key%d: %d,\n", i, i);
+  }
+  src->Append("  last: true\n}\nreturn o.key1\n");
+}
+
+
+static const char* TierName(CodeSpace::Tier tier) {
+  switch (tier) {
+    case CodeSpace::kTierAuto: return "auto";
+    case CodeSpace::kTierFullgen: return "fullgen";
+    case CodeSpace::kTierOptimizing: return "hir/lir";
+  }
+
+  return NULL;
+}
+
+
+static void Report(const char* shape,
+                   int scale,
+                   const char* tier,
+                   uint32_t length,
+                   int64_t micros,
+                   int64_t code_size) {
+  fprintf(stdout,
+          "%s x%d %s : %u bytes in %.2fms, %f KB/sec",
+          shape,
+          scale,
+          tier,
+          length,
+          micros * 1e-3,
+          length / 1024.0 / (micros * 1e-6));
+  if (code_size >= 0) {
+    fprintf(stdout, ", %lld bytes of code", static_cast<long long>(code_size));
+  }
+  fprintf(stdout, "\n");
+}
+
+
+static void Measure(const char* shape, void (*generate)(Source*, int)) {
+  const int kScales[] = { 1, 2, 4 };
+  const CodeSpace::Tier kTiers[] = {
+    CodeSpace::kTierAuto,
+    CodeSpace::kTierFullgen,
+    CodeSpace::kTierOptimizing
+  };
+
+  for (size_t i = 0; i < sizeof(kScales) / sizeof(kScales[0]); i++) {
+    Source src;
+    generate(&src, kScales[i]);
+
+    // Front-end only: parsing and scope analysis
+    {
+      Zone zone;
+      int64_t start = GetTimeMicros();
+      Parser p(src.data(), src.length());
+      AstNode* ast = p.Execute();
+      ASSERT(!p.has_error());
+      Scope::Analyze(ast);
+      Report(shape, kScales[i], "parse", src.length(),
+             GetTimeMicros() - start, -1);
+    }
+
+    for (size_t j = 0; j < sizeof(kTiers) / sizeof(kTiers[0]); j++) {
+      Heap heap(2 * 1024 * 1024);
+      CodeSpace space(&heap);
+      CodeSpace::tier(kTiers[j]);
+
+      uint32_t code_size = space.code_size();
+      char* root;
+      Error* error = NULL;
+      int64_t start = GetTimeMicros();
+      space.Compile(shape, src.data(), src.length(), &root, &error);
+      int64_t end = GetTimeMicros();
+      ASSERT(error == NULL);
+
+      Report(shape, kScales[i], TierName(kTiers[j]), src.length(),
+             end - start, space.code_size() - code_size);
+    }
+    CodeSpace::tier(CodeSpace::kTierAuto);
+  }
+}
+
+
+TEST_START(compile)
+  Measure("many_functions", ManyFunctions);
+  Measure("huge_function", HugeFunction);
+  Measure("deep_nesting", DeepNesting);
+  Measure("if_else_chain", IfElseChain);
+  Measure("object_literal", BigObjectLiteral);
+TEST_END(compile)
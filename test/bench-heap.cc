@@ -0,0 +1,152 @@
+#include "test.h"
+#include <runtime.h>
+#include <gc.h>
+#include <utils.h>
+
+static char* MakeKey(Heap* heap, const char* name) {
+  return heap->CreateString(name, strlen(name));
+}
+
+
+static void Store(Heap* heap, char* obj, char* key, char* value) {
+  intptr_t offset = RuntimeLookupProperty(heap, obj, key, 1);
+  *reinterpret_cast<char**>(HObject::Map(obj) + offset) = value;
+}
+
+
+static void Report(const char* name, int ops, int64_t micros) {
+  fprintf(stdout, "%s : %f ops/sec\n", name, ops / (micros * 1e-6));
+}
+
+
+TEST_START(copyto)
+  Heap heap(2 * 1024 * 1024);
+  const int kBatch = 10000;
+  const int kBatches = 20;
+
+  const char* text = "string value";
+  char* values[] = {
+    HNumber::New(&heap, Heap::kTenureOld, 1.5),
+    HBoolean::New(&heap, Heap::kTenureOld, true),
+    HString::New(&heap, Heap::kTenureOld, text, strlen(text)),
+    HObject::NewEmpty(&heap),
+    HArray::NewEmpty(&heap),
+    HMap::NewEmpty(&heap, 16),
+    HCData::New(&heap, 32)
+  };
+  const char* names[] = {
+    "copyto_number",
+    "copyto_boolean",
+    "copyto_string",
+    "copyto_object",
+    "copyto_array",
+    "copyto_map",
+    "copyto_cdata"
+  };
+
+  for (size_t i = 0; i < sizeof(values) / sizeof(values[0]); i++) {
+    int64_t total = 0;
+    for (int j = 0; j < kBatches; j++) {
+      // Fresh spaces for every batch, so memory use stays flat
+      Space old_space(&heap, heap.new_space()->page_size());
+      Space new_space(&heap, heap.new_space()->page_size());
+
+      int64_t start = GetTimeMicros();
+      for (int k = 0; k < kBatch; k++) {
+        // CopyTo bumps generation, keep it young to stay on one path
+        *reinterpret_cast<uint8_t*>(values[i] + HValue::kGenerationOffset) = 0;
+        ASSERT(HValue::Cast(values[i])->CopyTo(&old_space, &new_space) != NULL);
+      }
+      total += GetTimeMicros() - start;
+    }
+    Report(names[i], kBatch * kBatches, total);
+  }
+TEST_END(copyto)
+
+
+// Runs GC `count` times with `root` being the only thing on the stack,
+// only time spent inside collector is accounted.
+static void Collect(Heap* heap, char** root, int count) {
+  char* stack[] = { NULL, reinterpret_cast<char*>(Heap::kEnterFrameTag), NULL };
+  for (int i = 0; i < count; i++) {
+    stack[0] = *root;
+    RuntimeCollectGarbage(heap, reinterpret_cast<char*>(stack));
+    *root = stack[0];
+  }
+}
+
+
+static void ReportGC(const char* name, Heap* heap, int objects) {
+  GC* gc = heap->gc();
+  uint32_t count = gc->count(GC::kNewSpace) + gc->count(GC::kOldSpace);
+  int64_t pause = gc->total_pause(GC::kNewSpace) +
+                  gc->total_pause(GC::kOldSpace);
+  fprintf(stdout,
+          "%s : %d collections, %f us/collection, %f objects/sec\n",
+          name,
+          count,
+          static_cast<double>(pause) / count,
+          static_cast<double>(objects) * count / (pause * 1e-6));
+}
+
+
+TEST_START(collect)
+  const int kCollections = 50;
+  const int kLive = 10000;
+
+  // Linked list which is entirely live
+  {
+    Heap heap(2 * 1024 * 1024);
+    char* next = MakeKey(&heap, "next");
+    char* head = HNil::New();
+    for (int i = 0; i < kLive; i++) {
+      char* node = HObject::NewEmpty(&heap);
+      Store(&heap, node, next, head);
+      head = node;
+    }
+
+    Collect(&heap, &head, kCollections);
+    ASSERT(HValue::GetTag(head) == Heap::kTagObject);
+    ReportGC("gc_live_list", &heap, kLive);
+  }
+
+  // Mostly garbage: only every 100th object is reachable
+  {
+    Heap heap(2 * 1024 * 1024);
+    char* next = MakeKey(&heap, "next");
+    char* head = HNil::New();
+    for (int i = 0; i < kCollections; i++) {
+      for (int j = 0; j < kLive; j++) {
+        char* node = HObject::NewEmpty(&heap);
+        if (j % 100 == 0) {
+          Store(&heap, node, next, head);
+          head = node;
+        }
+      }
+      Collect(&heap, &head, 1);
+    }
+    ReportGC("gc_mostly_garbage", &heap, kLive / 100);
+  }
+
+  // Few wide arrays
+  {
+    Heap heap(2 * 1024 * 1024);
+    const int kArrays = 16;
+    const int kWidth = 1024;
+    char* root = HArray::NewEmpty(&heap);
+    for (int i = 0; i < kArrays; i++) {
+      char* arr = HArray::NewEmpty(&heap);
+      for (int j = 0; j < kWidth; j++) {
+        Store(&heap,
+              arr,
+              HNumber::ToPointer(j),
+              HNumber::New(&heap, Heap::kTenureNew, j + 0.5));
+      }
+      Store(&heap, root, HNumber::ToPointer(i), arr);
+    }
+
+    Collect(&heap, &root, kCollections);
+    ASSERT(HArray::Length(root, false) == kArrays);
+    ReportGC("gc_wide_arrays", &heap, kArrays * (kWidth + 1));
+  }
+TEST_END(collect)
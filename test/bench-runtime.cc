@@ -0,0 +1,211 @@
+#include "test.h"
+#include <runtime.h>
+
+static char* Smi(int64_t value) {
+  return HNumber::ToPointer(value);
+}
+
+
+static char* MakeKey(Heap* heap, int prefix, int i) {
+  char buf[32];
+  int len = snprintf(buf, sizeof(buf), "%c%d", prefix, i);
+  return heap->CreateString(buf, len);
+}
+
+
+static void Store(Heap* heap, char* obj, char* key, char* value) {
+  intptr_t offset = RuntimeLookupProperty(heap, obj, key, 1);
+  *reinterpret_cast<char**>(HObject::Map(obj) + offset) = value;
+}
+
+
+TEST_START(lookup)
+  Heap heap(2 * 1024 * 1024);
+  const int kKeys = 32;
+  const int kIterations = 2000000;
+  intptr_t sink = 0;
+
+  char* hit_keys[kKeys];
+  char* miss_keys[kKeys];
+  char* obj = HObject::NewEmpty(&heap, 64);
+  for (int i = 0; i < kKeys; i++) {
+    hit_keys[i] = MakeKey(&heap, 'k', i);
+    miss_keys[i] = MakeKey(&heap, 'm', i);
+    Store(&heap, obj, hit_keys[i], Smi(i));
+  }
+
+  {
+    BENCH_START(object_hit, kIterations)
+    for (int i = 0; i < kIterations; i++) {
+      sink += RuntimeLookupProperty(&heap, obj, hit_keys[i % kKeys], 0);
+    }
+    BENCH_END(object_hit, kIterations)
+  }
+
+  {
+    BENCH_START(object_miss, kIterations)
+    for (int i = 0; i < kIterations; i++) {
+      sink += RuntimeLookupProperty(&heap, obj, miss_keys[i % kKeys], 0);
+    }
+    BENCH_END(object_miss, kIterations)
+  }
+
+  // Dense array: values are stored directly at `index * kPointerSize`
+  char* dense = HArray::NewEmpty(&heap);
+  for (int i = 0; i < 64; i++) Store(&heap, dense, Smi(i), Smi(i));
+  ASSERT(HArray::IsDense(dense));
+
+  {
+    BENCH_START(dense_array, kIterations)
+    for (int i = 0; i < kIterations; i++) {
+      sink += RuntimeLookupProperty(&heap, dense, Smi(i & 63), 0);
+    }
+    BENCH_END(dense_array, kIterations)
+  }
+
+  // Sparse array: above kDenseLengthMax indexes are hashed like object keys
+  const int kSparse = 4096;
+  char* sparse = HArray::NewEmpty(&heap);
+  for (int i = 0; i < kSparse; i++) Store(&heap, sparse, Smi(i), Smi(i));
+  ASSERT(!HArray::IsDense(sparse));
+
+  {
+    BENCH_START(sparse_array_hit, kIterations)
+    for (int i = 0; i < kIterations; i++) {
+      sink += RuntimeLookupProperty(&heap, sparse, Smi(i & (kSparse - 1)), 0);
+    }
+    BENCH_END(sparse_array_hit, kIterations)
+  }
+
+  // Maps are grown only when completely full, so a miss may probe every
+  // slot: run fewer iterations here
+  {
+    BENCH_START(sparse_array_miss, kIterations / 100)
+    for (int i = 0; i < kIterations / 100; i++) {
+      sink += RuntimeLookupProperty(&heap,
+                                    sparse,
+                                    Smi(kSparse + (i & (kSparse - 1))),
+                                    0);
+    }
+    BENCH_END(sparse_array_miss, kIterations / 100)
+  }
+
+  ASSERT(sink != 0);
+TEST_END(lookup)
+
+
+TEST_START(grow)
+  Heap heap(2 * 1024 * 1024);
+  const int kObjects = 10000;
+  const int kKeys = 12;
+
+  char* keys[kKeys];
+  for (int i = 0; i < kKeys; i++) keys[i] = MakeKey(&heap, 'k', i);
+
+  // Populate everything up front, so only rehashing is measured
+  char** objects = new char*[kObjects];
+  for (int i = 0; i < kObjects; i++) {
+    objects[i] = HObject::NewEmpty(&heap);
+    for (int j = 0; j < kKeys; j++) Store(&heap, objects[i], keys[j], Smi(j));
+  }
+
+  {
+    BENCH_START(grow_object, kObjects)
+    for (int i = 0; i < kObjects; i++) {
+      RuntimeGrowObject(&heap, objects[i], 0);
+    }
+    BENCH_END(grow_object, kObjects)
+  }
+
+  for (int i = 0; i < kObjects; i++) {
+    intptr_t offset = RuntimeLookupProperty(&heap, objects[i], keys[7], 0);
+    ASSERT(*reinterpret_cast<char**>(HObject::Map(objects[i]) + offset) ==
+           Smi(7));
+  }
+
+  delete[] objects;
+TEST_END(grow)
+
+
+TEST_START(strings)
+  Heap heap(2 * 1024 * 1024);
+  const int kIterations = 200000;
+  uint32_t sink = 0;
+
+  const char* text = "some reasonably long property name";
+  char* str = HString::New(&heap, Heap::kTenureOld, text, strlen(text));
+
+  {
+    BENCH_START(string_hash, kIterations)
+    for (int i = 0; i < kIterations; i++) {
+      // Drop cached hash to measure the hashing itself
+      *reinterpret_cast<uint32_t*>(str + HString::kHashOffset) = 0;
+      sink += HString::Hash(&heap, str);
+    }
+    BENCH_END(string_hash, kIterations)
+  }
+
+  // Cons tree of 64 leaves
+  char* cons = str;
+  for (int i = 0; i < 63; i++) {
+    cons = RuntimeConcatenateStrings(&heap, cons, str);
+  }
+  ASSERT(HString::Length(cons) == 64 * strlen(text));
+
+  char* buffer = new char[HString::Length(cons)];
+  {
+    BENCH_START(string_flatten_cons, kIterations / 10)
+    for (int i = 0; i < kIterations / 10; i++) {
+      HString::FlattenCons(cons, buffer);
+      sink += buffer[i % HString::Length(cons)];
+    }
+    BENCH_END(string_flatten_cons, kIterations / 10)
+  }
+  delete[] buffer;
+
+  char* a = HString::New(&heap, Heap::kTenureOld, "abc", 3);
+  char* b = HString::New(&heap, Heap::kTenureOld, "def", 3);
+  {
+    BENCH_START(concat_short, kIterations)
+    for (int i = 0; i < kIterations; i++) {
+      sink += HString::Length(RuntimeConcatenateStrings(&heap, a, b));
+    }
+    BENCH_END(concat_short, kIterations)
+  }
+
+  {
+    BENCH_START(concat_long, kIterations)
+    for (int i = 0; i < kIterations; i++) {
+      sink += HString::Length(RuntimeConcatenateStrings(&heap, str, str));
+    }
+    BENCH_END(concat_long, kIterations)
+  }
+
+  ASSERT(sink != 0);
+TEST_END(strings)
+
+
+TEST_START(tostring)
+  Heap heap(2 * 1024 * 1024);
+  const int kIterations = 200000;
+  uint32_t sink = 0;
+
+  {
+    BENCH_START(tostring_smi, kIterations)
+    for (int i = 0; i < kIterations; i++) {
+      sink += HString::Length(RuntimeToString(&heap, Smi(i)));
+    }
+    BENCH_END(tostring_smi, kIterations)
+  }
+
+  char* num = HNumber::New(&heap, Heap::kTenureOld, 3.14159);
+  {
+    BENCH_START(tostring_double, kIterations)
+    for (int i = 0; i < kIterations; i++) {
+      sink += HString::Length(RuntimeToString(&heap, num));
+    }
+    BENCH_END(tostring_double, kIterations)
+  }
+
+  ASSERT(sink != 0);
+TEST_END(tostring)
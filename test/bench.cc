@@ -0,0 +1,803 @@
+#include <stdio.h>  // fprintf
+#include <stdlib.h>  // exit, atoi, qsort
+#include <string.h>  // strcmp, strrchr
+#include <math.h>  // sqrt, ceil
+#include <unistd.h>  // fork, pipe
+#include <fcntl.h>  // open
+#include <sys/types.h>  // pid_t
+#include <sys/time.h>  // gettimeofday
+#include <sys/resource.h>  // rusage
+#include <sys/wait.h>  // wait4
+
+#include "candor.h"
+
+using namespace candor;
+
+// Benchmark runner: every iteration of every benchmark is executed in a
+// forked process with a fresh isolate, so heap state and peak RSS of one run
+// doesn't affect others. Warmup runs are executed in the same process right
+// before the measured one.
+
+static const int kMaxIterations = 1000;
+static const int kMaxBaseline = 256;
+static const int kMaxPauses = 1024;
+
+struct Options {
+  int warmup;
+  int iterations;
+  bool json;
+  bool perf;
+  bool gc;
+  double threshold;
+  const char* baseline;
+  const char* save;
+};
+
+// Result of one run, passed from child to parent through the pipe
+struct RunResult {
+  double time;
+  GCStats gc;
+  int64_t max_rss;
+
+  bool has_perf;
+  PerfStats perf;
+
+  // Individual collections (only last kMaxPauses are kept)
+  uint32_t pause_count;
+  GCPause pauses[kMaxPauses];
+};
+
+// Distribution of pauses of one GC type (in milliseconds)
+struct PauseSummary {
+  int count;
+  double p50;
+  double p99;
+  double max;
+};
+
+struct Summary {
+  char name[128];
+  int runs;
+
+  // Benchmark couldn't be read or one of its runs didn't complete,
+  // nothing else is filled
+  bool failed;
+
+  double median;
+  double p95;
+  double mean;
+  double stddev;
+  double min;
+
+  double gc_new_count;
+  double gc_old_count;
+  double gc_pause;
+  int64_t gc_max_pause;
+  int64_t max_rss;
+
+  PauseSummary new_space_pauses;
+  PauseSummary old_space_pauses;
+
+  // Reclaimed megabytes per second of GC, and share of run time spent
+  // outside of GC
+  double gc_throughput;
+  double mutator_utilization;
+
+  // Per-run averages of hardware counters
+  bool has_perf;
+  PerfStats perf;
+
+  // Change of median relative to baseline (in percents)
+  bool has_baseline;
+  double change;
+  bool regression;
+};
+
+struct BaselineEntry {
+  char name[128];
+  double median;
+};
+
+
+static double Now() {
+  timeval tv;
+  gettimeofday(&tv, NULL);
+
+  return tv.tv_sec * 1e3 + tv.tv_usec * 1e-3;
+}
+
+
+static const char* ReadContents(const char* filename, off_t* size) {
+  int fd = open(filename, O_RDONLY);
+  if (fd == -1) return NULL;
+
+  off_t s = lseek(fd, 0, SEEK_END);
+  char* contents = new char[s];
+  if (s == -1 || pread(fd, contents, s, 0) != s) {
+    delete[] contents;
+    close(fd);
+    return NULL;
+  }
+  close(fd);
+
+  *size = s;
+  return contents;
+}
+
+
+static Value* Print(uint32_t argc, Value* argv[]) {
+  // Benchmarks shouldn't spam output
+  return Nil::New();
+}
+
+
+static Value* ToString(uint32_t argc, Value* argv[]) {
+  if (argc < 1) return Nil::New();
+
+  // Flatten strings
+  String* str = argv[0]->ToString();
+  str->Value();
+
+  return str;
+}
+
+
+static Value* Buffer(uint32_t argc, Value* argv[]) {
+  if (argc < 1) return Nil::New();
+
+  // Off-heap-like payload for GC benchmarks
+  return CData::New(argv[0]->ToNumber()->IntegralValue());
+}
+
+
+static void Execute(const char* filename,
+                    const char* source,
+                    uint32_t length,
+                    bool perf,
+                    RunResult* result) {
+  Isolate isolate;
+
+  // Counters are started before compilation to see its share
+  if (perf) result->has_perf = isolate.EnablePerfCounters();
+
+  Function* fn = Function::New(filename, source, length);
+  if (isolate.HasError()) {
+    isolate.PrintError();
+    _exit(1);
+  }
+
+  Object* global = Object::New();
+  global->Set("print", Function::New(Print));
+  global->Set("toString", Function::New(ToString));
+  global->Set("buffer", Function::New(Buffer));
+  fn->SetContext(global);
+
+  double start = Now();
+  fn->Call(0, NULL);
+  result->time = Now() - start;
+
+  isolate.GetGCStats(&result->gc);
+  if (result->has_perf) isolate.GetPerfStats(&result->perf);
+  result->pause_count = isolate.GetGCPauses(result->pauses, kMaxPauses);
+}
+
+
+// Pipe may return less than was written
+static bool ReadAll(int fd, void* data, size_t size) {
+  char* ptr = reinterpret_cast<char*>(data);
+  while (size > 0) {
+    ssize_t bytes = read(fd, ptr, size);
+    if (bytes <= 0) return false;
+    ptr += bytes;
+    size -= bytes;
+  }
+
+  return true;
+}
+
+
+static bool Run(const char* filename,
+                const char* source,
+                uint32_t length,
+                int warmup,
+                bool perf,
+                RunResult* result) {
+  int fds[2];
+  if (pipe(fds) == -1) return false;
+
+  pid_t pid = fork();
+  if (pid == -1) return false;
+
+  if (pid == 0) {
+    close(fds[0]);
+
+    RunResult r;
+    for (int i = 0; i < warmup; i++) {
+      memset(&r, 0, sizeof(r));
+      Execute(filename, source, length, false, &r);
+    }
+
+    memset(&r, 0, sizeof(r));
+    Execute(filename, source, length, perf, &r);
+
+    if (write(fds[1], &r, sizeof(r)) != sizeof(r)) _exit(1);
+    _exit(0);
+  }
+
+  close(fds[1]);
+  bool complete = ReadAll(fds[0], result, sizeof(*result));
+  close(fds[0]);
+
+  int status;
+  rusage usage;
+  if (wait4(pid, &status, 0, &usage) == -1) return false;
+  if (!WIFEXITED(status) || WEXITSTATUS(status) != 0) return false;
+  if (!complete) return false;
+
+  // ru_maxrss is in bytes on OS X and in kilobytes everywhere else
+#ifdef __APPLE__
+  result->max_rss = usage.ru_maxrss;
+#else
+  result->max_rss = static_cast<int64_t>(usage.ru_maxrss) * 1024;
+#endif
+
+  return true;
+}
+
+
+static int CompareDoubles(const void* a, const void* b) {
+  double l = *reinterpret_cast<const double*>(a);
+  double r = *reinterpret_cast<const double*>(b);
+
+  return l < r ? -1 : l > r ? 1 : 0;
+}
+
+
+static const int kCounterCount = sizeof(PerfCounterValues) / sizeof(int64_t);
+
+
+static int64_t* CounterValues(PerfCounterValues* values) {
+  return reinterpret_cast<int64_t*>(values);
+}
+
+
+// Sums counters, unavailable (-1) in any run is unavailable in the sum
+static void AddCounters(PerfCounterValues* to, PerfCounterValues* from) {
+  int64_t* t = CounterValues(to);
+  int64_t* f = CounterValues(from);
+  for (int i = 0; i < kCounterCount; i++) {
+    t[i] = t[i] == -1 || f[i] == -1 ? -1 : t[i] + f[i];
+  }
+}
+
+
+static void DivideCounters(PerfCounterValues* values, int count) {
+  int64_t* v = CounterValues(values);
+  for (int i = 0; i < kCounterCount; i++) {
+    if (v[i] != -1) v[i] /= count;
+  }
+}
+
+
+// Nearest-rank percentile of sorted values
+static double Percentile(double* sorted, int count, double p) {
+  int rank = static_cast<int>(ceil(p * count)) - 1;
+  return sorted[rank < 0 ? 0 : rank];
+}
+
+
+static uint32_t RecordedPauses(RunResult* r) {
+  return r->pause_count < static_cast<uint32_t>(kMaxPauses) ?
+      r->pause_count : kMaxPauses;
+}
+
+
+static void SummarizePauses(RunResult* results,
+                            int count,
+                            bool old_space,
+                            PauseSummary* s) {
+  double* pauses = new double[count * kMaxPauses];
+  int total = 0;
+
+  for (int i = 0; i < count; i++) {
+    RunResult* r = &results[i];
+    for (uint32_t j = 0; j < RecordedPauses(r); j++) {
+      if (r->pauses[j].old_space != old_space) continue;
+      pauses[total++] = r->pauses[j].pause * 1e-3;
+    }
+  }
+  qsort(pauses, total, sizeof(*pauses), CompareDoubles);
+
+  s->count = total;
+  if (total == 0) {
+    s->p50 = s->p99 = s->max = 0;
+  } else {
+    s->p50 = Percentile(pauses, total, 0.5);
+    s->p99 = Percentile(pauses, total, 0.99);
+    s->max = pauses[total - 1];
+  }
+
+  delete[] pauses;
+}
+
+
+static void Summarize(RunResult* results, int count, Summary* s) {
+  double times[kMaxIterations];
+  double sum = 0;
+
+  s->runs = count;
+  s->gc_new_count = 0;
+  s->gc_old_count = 0;
+  s->gc_pause = 0;
+  s->gc_max_pause = 0;
+  s->max_rss = 0;
+  s->has_perf = true;
+  memset(&s->perf, 0, sizeof(s->perf));
+
+  double reclaimed = 0;
+  double total_time = 0;
+
+  for (int i = 0; i < count; i++) {
+    RunResult* r = &results[i];
+
+    for (uint32_t j = 0; j < RecordedPauses(r); j++) {
+      reclaimed += r->pauses[j].reclaimed;
+    }
+    total_time += r->time;
+
+    if (r->has_perf) {
+      AddCounters(&s->perf.total, &r->perf.total);
+      AddCounters(&s->perf.gc, &r->perf.gc);
+      AddCounters(&s->perf.compile, &r->perf.compile);
+    } else {
+      s->has_perf = false;
+    }
+
+    times[i] = r->time;
+    sum += r->time;
+
+    s->gc_new_count += r->gc.new_space_count;
+    s->gc_old_count += r->gc.old_space_count;
+    s->gc_pause += (r->gc.new_space_pause + r->gc.old_space_pause) * 1e-3;
+    if (r->gc.max_pause > s->gc_max_pause) s->gc_max_pause = r->gc.max_pause;
+    if (r->max_rss > s->max_rss) s->max_rss = r->max_rss;
+  }
+  qsort(times, count, sizeof(*times), CompareDoubles);
+
+  s->mean = sum / count;
+  s->min = times[0];
+  if (count % 2 == 0) {
+    s->median = (times[count / 2 - 1] + times[count / 2]) / 2;
+  } else {
+    s->median = times[count / 2];
+  }
+
+  s->p95 = Percentile(times, count, 0.95);
+
+  double variance = 0;
+  for (int i = 0; i < count; i++) {
+    variance += (times[i] - s->mean) * (times[i] - s->mean);
+  }
+  s->stddev = count > 1 ? sqrt(variance / (count - 1)) : 0;
+
+  SummarizePauses(results, count, false, &s->new_space_pauses);
+  SummarizePauses(results, count, true, &s->old_space_pauses);
+
+  // gc_pause is still a sum over all runs at this point
+  s->gc_throughput = s->gc_pause > 0 ?
+      reclaimed / (1024.0 * 1024.0) / (s->gc_pause * 1e-3) : 0;
+  s->mutator_utilization = total_time > 0 ?
+      (1 - s->gc_pause / total_time) * 100 : 100;
+
+  // Per-run averages
+  s->gc_new_count /= count;
+  s->gc_old_count /= count;
+  s->gc_pause /= count;
+  DivideCounters(&s->perf.total, count);
+  DivideCounters(&s->perf.gc, count);
+  DivideCounters(&s->perf.compile, count);
+}
+
+
+static void BenchmarkName(const char* filename, char* result, size_t size) {
+  const char* name = strrchr(filename, '/');
+  name = name == NULL ? filename : name + 1;
+
+  // Strip extension
+  const char* ext = strrchr(name, '.');
+  size_t length = ext == NULL ? strlen(name) : ext - name;
+  if (length > size - 1) length = size - 1;
+
+  memcpy(result, name, length);
+  result[length] = 0;
+}
+
+
+static int LoadBaseline(const char* filename, BaselineEntry* entries) {
+  FILE* f = fopen(filename, "r");
+  if (f == NULL) {
+    fprintf(stderr, "bench: failed to open baseline %s\n", filename);
+    exit(1);
+  }
+
+  int count = 0;
+  while (count < kMaxBaseline &&
+         fscanf(f, "%127s %lf", entries[count].name,
+                &entries[count].median) == 2) {
+    count++;
+  }
+  fclose(f);
+
+  return count;
+}
+
+
+static void SaveBaseline(const char* filename, Summary* s, int count) {
+  FILE* f = fopen(filename, "w");
+  if (f == NULL) {
+    fprintf(stderr, "bench: failed to write baseline %s\n", filename);
+    exit(1);
+  }
+
+  for (int i = 0; i < count; i++) {
+    if (s[i].failed) continue;
+    fprintf(f, "%s %f\n", s[i].name, s[i].median);
+  }
+  fclose(f);
+}
+
+
+static void CompareToBaseline(Summary* s,
+                              BaselineEntry* entries,
+                              int count,
+                              double threshold) {
+  s->has_baseline = false;
+  s->regression = false;
+
+  for (int i = 0; i < count; i++) {
+    if (strcmp(entries[i].name, s->name) != 0) continue;
+
+    s->has_baseline = true;
+    s->change = (s->median - entries[i].median) * 100 / entries[i].median;
+    s->regression = s->change > threshold;
+    return;
+  }
+}
+
+
+static void PrintHeader() {
+  fprintf(stdout,
+          "%-16s %11s %11s %9s %11s %11s %9s %10s %9s\n",
+          "benchmark", "median", "p95", "stddev", "gc new/old",
+          "gc pause", "max pause", "peak rss", "baseline");
+}
+
+
+static void PrintSummary(Summary* s) {
+  char gc_count[32];
+  char change[32];
+
+  if (s->failed) {
+    fprintf(stdout, "%-16s %11s\n", s->name, "FAILED");
+    return;
+  }
+
+  snprintf(gc_count, sizeof(gc_count), "%.0f/%.0f",
+           s->gc_new_count, s->gc_old_count);
+  if (s->has_baseline) {
+    snprintf(change, sizeof(change), "%+.1f%%", s->change);
+  } else {
+    snprintf(change, sizeof(change), "-");
+  }
+
+  fprintf(stdout,
+          "%-16s %9.2fms %9.2fms %7.2fms %11s %9.2fms %7.2fms %8.1fMB %9s%s\n",
+          s->name,
+          s->median,
+          s->p95,
+          s->stddev,
+          gc_count,
+          s->gc_pause,
+          s->gc_max_pause * 1e-3,
+          s->max_rss / (1024.0 * 1024.0),
+          change,
+          s->regression ? " REGRESSION" : "");
+}
+
+
+// Formats counter as 1.23G, 4.5M, ...
+static const char* FormatCount(int64_t value, char* buf, size_t size) {
+  if (value == -1) {
+    snprintf(buf, size, "-");
+  } else if (value >= 1000000000) {
+    snprintf(buf, size, "%.2fG", value * 1e-9);
+  } else if (value >= 1000000) {
+    snprintf(buf, size, "%.2fM", value * 1e-6);
+  } else if (value >= 1000) {
+    snprintf(buf, size, "%.2fK", value * 1e-3);
+  } else {
+    snprintf(buf, size, "%lld", static_cast<long long>(value));
+  }
+
+  return buf;
+}
+
+
+static const char* FormatShare(int64_t part,
+                               int64_t total,
+                               char* buf,
+                               size_t size) {
+  if (part == -1 || total <= 0) {
+    snprintf(buf, size, "-");
+  } else {
+    snprintf(buf, size, "%.1f%%", part * 100.0 / total);
+  }
+
+  return buf;
+}
+
+
+static void PrintPerf(Summary* s) {
+  PerfCounterValues* t = &s->perf.total;
+  char buf[7][16];
+
+  if (t->cycles > 0 && t->instructions != -1) {
+    snprintf(buf[6], sizeof(buf[6]), "%.2f",
+             static_cast<double>(t->instructions) / t->cycles);
+  } else {
+    snprintf(buf[6], sizeof(buf[6]), "-");
+  }
+
+  fprintf(stdout,
+          "  %s cycles, %s instructions, IPC %s, %s branch misses, "
+          "%s L1d misses, %s LLC misses, %s dTLB misses\n",
+          FormatCount(t->cycles, buf[0], sizeof(buf[0])),
+          FormatCount(t->instructions, buf[1], sizeof(buf[1])),
+          buf[6],
+          FormatCount(t->branch_misses, buf[2], sizeof(buf[2])),
+          FormatCount(t->l1d_misses, buf[3], sizeof(buf[3])),
+          FormatCount(t->llc_misses, buf[4], sizeof(buf[4])),
+          FormatCount(t->dtlb_misses, buf[5], sizeof(buf[5])));
+  fprintf(stdout,
+          "  cycles: gc %s, compile %s; L1d misses: gc %s, compile %s\n",
+          FormatShare(s->perf.gc.cycles, t->cycles, buf[0], sizeof(buf[0])),
+          FormatShare(s->perf.compile.cycles, t->cycles,
+                      buf[1], sizeof(buf[1])),
+          FormatShare(s->perf.gc.l1d_misses, t->l1d_misses,
+                      buf[2], sizeof(buf[2])),
+          FormatShare(s->perf.compile.l1d_misses, t->l1d_misses,
+                      buf[3], sizeof(buf[3])));
+}
+
+
+static void PrintPauses(Summary* s) {
+  PauseSummary* n = &s->new_space_pauses;
+  PauseSummary* o = &s->old_space_pauses;
+
+  fprintf(stdout,
+          "  gc pauses new: %d, p50 %.2fms, p99 %.2fms, max %.2fms; "
+          "old: %d, p50 %.2fms, p99 %.2fms, max %.2fms\n",
+          n->count, n->p50, n->p99, n->max,
+          o->count, o->p50, o->p99, o->max);
+  fprintf(stdout,
+          "  gc throughput %.1fMB/s, mutator utilization %.1f%%\n",
+          s->gc_throughput,
+          s->mutator_utilization);
+}
+
+
+static void PrintPausesJSON(const char* name, PauseSummary* p) {
+  fprintf(stdout,
+          "\"%s\": { \"count\": %d, \"p50_ms\": %f, \"p99_ms\": %f, "
+          "\"max_ms\": %f }",
+          name, p->count, p->p50, p->p99, p->max);
+}
+
+
+static void PrintCountersJSON(const char* name, PerfCounterValues* v) {
+  fprintf(stdout,
+          "\"%s\": { \"cycles\": %lld, \"instructions\": %lld, "
+          "\"branch_misses\": %lld, \"l1d_misses\": %lld, "
+          "\"llc_misses\": %lld, \"dtlb_misses\": %lld }",
+          name,
+          static_cast<long long>(v->cycles),
+          static_cast<long long>(v->instructions),
+          static_cast<long long>(v->branch_misses),
+          static_cast<long long>(v->l1d_misses),
+          static_cast<long long>(v->llc_misses),
+          static_cast<long long>(v->dtlb_misses));
+}
+
+
+static void PrintJSON(Summary* summaries, int count, Options* options) {
+  fprintf(stdout, "{\n  \"warmup\": %d,\n  \"iterations\": %d,\n",
+          options->warmup, options->iterations);
+  fprintf(stdout, "  \"benchmarks\": [\n");
+  for (int i = 0; i < count; i++) {
+    Summary* s = &summaries[i];
+    if (s->failed) {
+      fprintf(stdout, "    { \"name\": \"%s\", \"failed\": true }%s\n",
+              s->name,
+              i == count - 1 ? "" : ",");
+      continue;
+    }
+
+    fprintf(stdout,
+            "    { \"name\": \"%s\", \"failed\": false, \"runs\": %d, "
+            "\"median_ms\": %f, "
+            "\"p95_ms\": %f, \"mean_ms\": %f, \"stddev_ms\": %f, "
+            "\"min_ms\": %f, \"gc_new_space_count\": %f, "
+            "\"gc_old_space_count\": %f, \"gc_pause_ms\": %f, "
+            "\"gc_max_pause_ms\": %f, \"peak_rss_bytes\": %lld",
+            s->name,
+            s->runs,
+            s->median,
+            s->p95,
+            s->mean,
+            s->stddev,
+            s->min,
+            s->gc_new_count,
+            s->gc_old_count,
+            s->gc_pause,
+            s->gc_max_pause * 1e-3,
+            static_cast<long long>(s->max_rss));
+    fprintf(stdout, ", ");
+    PrintPausesJSON("gc_new_space_pauses", &s->new_space_pauses);
+    fprintf(stdout, ", ");
+    PrintPausesJSON("gc_old_space_pauses", &s->old_space_pauses);
+    fprintf(stdout,
+            ", \"gc_throughput_mb_s\": %f, \"mutator_utilization\": %f",
+            s->gc_throughput,
+            s->mutator_utilization);
+    if (s->has_baseline) {
+      fprintf(stdout, ", \"baseline_change\": %f, \"regression\": %s",
+              s->change,
+              s->regression ? "true" : "false");
+    }
+    if (s->has_perf) {
+      fprintf(stdout, ", \"perf\": { ");
+      PrintCountersJSON("total", &s->perf.total);
+      fprintf(stdout, ", ");
+      PrintCountersJSON("gc", &s->perf.gc);
+      fprintf(stdout, ", ");
+      PrintCountersJSON("compile", &s->perf.compile);
+      fprintf(stdout, " }");
+    }
+    fprintf(stdout, " }%s\n", i == count - 1 ? "" : ",");
+  }
+  fprintf(stdout, "  ]\n}\n");
+}
+
+
+static void Usage() {
+  fprintf(stderr,
+          "Usage: bench [options] file.can ...\n"
+          "  --warmup N       runs before each measured one (default: 1)\n"
+          "  --iterations N   measured runs (default: 5)\n"
+          "  --json           print results as JSON\n"
+          "  --perf           report hardware performance counters\n"
+          "  --gc             report GC pause percentiles and throughput\n"
+          "  --baseline FILE  compare medians with a saved baseline\n"
+          "  --threshold PCT  regression threshold (default: 10)\n"
+          "  --save FILE      save medians as a new baseline\n");
+  exit(1);
+}
+
+
+int main(int argc, char** argv) {
+  Options options;
+  options.warmup = 1;
+  options.iterations = 5;
+  options.json = false;
+  options.perf = false;
+  options.gc = false;
+  options.threshold = 10;
+  options.baseline = NULL;
+  options.save = NULL;
+
+  int i;
+  for (i = 1; i < argc; i++) {
+    const char* arg = argv[i];
+    bool has_value = i + 1 < argc;
+
+    if (strcmp(arg, "--json") == 0) {
+      options.json = true;
+    } else if (strcmp(arg, "--perf") == 0) {
+      options.perf = true;
+    } else if (strcmp(arg, "--gc") == 0) {
+      options.gc = true;
+    } else if (strcmp(arg, "--warmup") == 0 && has_value) {
+      options.warmup = atoi(argv[++i]);
+    } else if (strcmp(arg, "--iterations") == 0 && has_value) {
+      options.iterations = atoi(argv[++i]);
+    } else if (strcmp(arg, "--threshold") == 0 && has_value) {
+      options.threshold = atof(argv[++i]);
+    } else if (strcmp(arg, "--baseline") == 0 && has_value) {
+      options.baseline = argv[++i];
+    } else if (strcmp(arg, "--save") == 0 && has_value) {
+      options.save = argv[++i];
+    } else if (strncmp(arg, "--", 2) == 0) {
+      Usage();
+    } else {
+      break;
+    }
+  }
+
+  if (i == argc ||
+      options.iterations < 1 ||
+      options.iterations > kMaxIterations ||
+      options.warmup < 0) {
+    Usage();
+  }
+
+  BaselineEntry* baseline = new BaselineEntry[kMaxBaseline];
+  int baseline_count = 0;
+  if (options.baseline != NULL) {
+    baseline_count = LoadBaseline(options.baseline, baseline);
+  }
+
+  int count = argc - i;
+  Summary* summaries = new Summary[count];
+  RunResult* results = new RunResult[options.iterations];
+  bool failed = false;
+  bool regressed = false;
+  bool perf_warned = false;
+
+  if (!options.json) PrintHeader();
+
+  for (int j = 0; j < count; j++) {
+    const char* filename = argv[i + j];
+    Summary* s = &summaries[j];
+    BenchmarkName(filename, s->name, sizeof(s->name));
+    s->failed = false;
+
+    // Failed benchmark is reported, but others are still measured
+    off_t size;
+    const char* source = ReadContents(filename, &size);
+    if (source == NULL) {
+      fprintf(stderr, "bench: failed to read %s\n", filename);
+      s->failed = true;
+    }
+
+    for (int k = 0; !s->failed && k < options.iterations; k++) {
+      if (!Run(filename,
+               source,
+               size,
+               options.warmup,
+               options.perf,
+               &results[k])) {
+        fprintf(stderr, "bench: %s failed\n", filename);
+        s->failed = true;
+      }
+    }
+    delete[] source;
+
+    if (s->failed) {
+      failed = true;
+      if (!options.json) PrintSummary(s);
+      continue;
+    }
+
+    Summarize(results, options.iterations, s);
+    CompareToBaseline(s, baseline, baseline_count, options.threshold);
+    if (s->regression) regressed = true;
+
+    if (options.perf && !s->has_perf && !perf_warned) {
+      fprintf(stderr, "bench: hardware counters are unavailable\n");
+      perf_warned = true;
+    }
+
+    if (!options.json) {
+      PrintSummary(s);
+      if (options.gc) PrintPauses(s);
+      if (s->has_perf) PrintPerf(s);
+    }
+  }
+
+  if (options.json) PrintJSON(summaries, count, &options);
+  if (options.save != NULL) SaveBaseline(options.save, summaries, count);
+
+  // Failures take precedence over regressions
+  if (failed) return 1;
+  return regressed ? 2 : 0;
+}
@@ -0,0 +1,18 @@
+#ifndef _TEST_MICROBENCH_LIST_H_
+#define _TEST_MICROBENCH_LIST_H_
+
+#define MICROBENCH_ENUM(V)\
+    V(lookup)\
+    V(grow)\
+    V(strings)\
+    V(tostring)\
+    V(copyto)\
+    V(collect)\
+    V(compile)
+
+#define MICROBENCH_DECLARE(name)\
+    void __test_runner_##name();
+MICROBENCH_ENUM(MICROBENCH_DECLARE)
+#undef MICROBENCH_DECLARE
+
+#endif // _TEST_MICROBENCH_LIST_H_
@@ -0,0 +1,25 @@
+#include "test.h"
+#include "microbench-list.h"
+
+#define BENCH_RUN(name) \
+    fprintf(stdout, "-- microbench: %s --\n", #name); \
+    __test_runner_##name();
+
+#define BENCH_SWITCH(name) \
+    if (strcmp(argv[1], #name) == 0) { \
+      BENCH_RUN(name) \
+    } else \
+
+int main(int argc, char** argv) {
+  if (argc == 1) {
+    MICROBENCH_ENUM(BENCH_RUN)
+    return 0;
+  }
+
+  MICROBENCH_ENUM(BENCH_SWITCH) {
+    fprintf(stderr, "Microbenchmark: %s was not found\n", argv[1]);
+    exit(1);
+  }
+
+  return 0;
+}
@@ -1,4 +1,13 @@
 #include "test.h"
+#include <runtime-stats.h>
+
+// Exposes runtime calls counters
+class StatsIsolate : public Isolate {
+ public:
+  uint64_t Count(RuntimeStats::RuntimeFunction fn) {
+    return heap->runtime_stats()->count(fn);
+  }
+};
 
 static Value* Callback(uint32_t argc, Value* argv[]) {
   ASSERT(argc == 3);
@@ -165,6 +174,42 @@ static Value* Unwrap(uint32_t argc, Value* argv[]) {
   return w->Wrap();
 }
 
+static int fast_calls = 0;
+static int slow_calls = 0;
+
+static double FastAdd(double lhs, double rhs) {
+  fast_calls++;
+  return lhs + rhs;
+}
+
+static Value* SlowAdd(uint32_t argc, Value* argv[]) {
+  ASSERT(argc == 2);
+  slow_calls++;
+
+  return Number::NewDouble(argv[0]->ToNumber()->Value() +
+                           argv[1]->ToNumber()->Value());
+}
+
+static int64_t FastNeg(int64_t value) {
+  fast_calls++;
+  return -value;
+}
+
+static Value* SlowNeg(uint32_t argc, Value* argv[]) {
+  ASSERT(argc == 1);
+  slow_calls++;
+
+  return Number::NewIntegral(-argv[0]->ToNumber()->IntegralValue());
+}
+
+static int64_t FastShift(int64_t value) {
+  return value << 60;
+}
+
+static Value* SlowShift(uint32_t argc, Value* argv[]) {
+  return Number::NewIntegral(argv[0]->ToNumber()->IntegralValue() << 60);
+}
+
 TEST_START(api)
   FUN_TEST("return (a, b, c) {\n"
            "return a + b + c(1, 2, () { __$gc()\nreturn 3 }) + 2\n"
@@ -216,6 +261,168 @@ TEST_START(api)
     ASSERT(clone->Get("b")->As<Number>()->Value() == 2);
   })
 
+  FUN_TEST("return { a: 1, b: 2 }", {
+    Handle<Object> obj(result->As<Object>());
+    Key a("a");
+    Key c("c", 1);
+
+    ASSERT(obj->Get(&a)->As<Number>()->Value() == 1);
+    ASSERT(obj->Get(&c)->Is<Nil>());
+
+    obj->Set(&c, Number::NewIntegral(3));
+    ASSERT(obj->Get(&c)->As<Number>()->Value() == 3);
+    ASSERT(obj->Get("c")->As<Number>()->Value() == 3);
+
+    // Keys should survive relocation
+    Function* gc = Function::New("gc", "__$gc()");
+    gc->Call(0, NULL);
+    ASSERT(obj->Get(&a)->As<Number>()->Value() == 1);
+    ASSERT(strncmp((*a)->Value(), "a", 1) == 0);
+
+    // Same key on a different object
+    Object* other = Object::New();
+    other->Set(&a, Number::NewIntegral(4));
+    ASSERT(other->Get(&a)->As<Number>()->Value() == 4);
+    ASSERT(other->Get("a")->As<Number>()->Value() == 4);
+    ASSERT(obj->Get(&a)->As<Number>()->Value() == 1);
+
+    obj->Delete(&a);
+    ASSERT(obj->Get(&a)->Is<Nil>());
+  })
+
+  FUN_TEST("return (arr) { return arr[2] + arr[199] + sizeof arr }", {
+    Handle<Array> arr(Array::New(200));
+    ASSERT(arr->Length() == 0);
+
+    int64_t ints[200];
+    for (int i = 0; i < 200; i++) ints[i] = i;
+    arr->SetRange(0, 200, ints);
+
+    double doubles[2];
+    doubles[0] = 0.5;
+    doubles[1] = 1.5;
+    arr->SetRange(200, 2, doubles);
+    ASSERT(arr->Length() == 202);
+
+    Value* argv[1] = { *arr };
+    Value* ret = result->As<Function>()->Call(1, argv);
+    ASSERT(ret->As<Number>()->Value() == 403);
+
+    int64_t iout[3];
+    arr->GetRange(198, 3, iout);
+    ASSERT(iout[0] == 198 && iout[1] == 199 && iout[2] == 0);
+
+    double dout[3];
+    arr->GetRange(200, 3, dout);
+    ASSERT(dout[0] == 0.5 && dout[1] == 1.5 && dout[2] == 0);
+
+    Value* values[2];
+    values[0] = Nil::New();
+    values[1] = String::New("x");
+    arr->SetRange(1, 2, values);
+
+    Value* vout[3];
+    arr->GetRange(0, 3, vout);
+    ASSERT(vout[0]->As<Number>()->Value() == 0);
+    ASSERT(vout[1]->Is<Nil>());
+    ASSERT(vout[2]->Is<String>());
+
+    // Dense arrays
+    Array* small = Array::New(4);
+    small->SetRange(2, 2, ints);
+    ASSERT(small->Length() == 4);
+    ASSERT(small->Get(3)->As<Number>()->Value() == 1);
+
+    // Integral doubles are stored unboxed
+    ASSERT(arr->Get(200)->As<Number>()->IsIntegral() == false);
+    doubles[0] = 2;
+    arr->SetRange(200, 1, doubles);
+    ASSERT(arr->Get(200)->As<Number>()->IsIntegral());
+
+    // Integers out of unboxed range are stored as doubles
+    int64_t bounds[4];
+    bounds[0] = (1LL << 62) - 1;
+    bounds[1] = 1LL << 62;
+    bounds[2] = -(1LL << 62);
+    bounds[3] = -(1LL << 62) - 2048;
+    small->SetRange(0, 4, bounds);
+    ASSERT(small->Get(0)->As<Number>()->IsIntegral());
+    ASSERT(small->Get(0)->As<Number>()->IntegralValue() == bounds[0]);
+    ASSERT(!small->Get(1)->As<Number>()->IsIntegral());
+    ASSERT(small->Get(1)->As<Number>()->Value() == 4611686018427387904.0);
+    ASSERT(small->Get(2)->As<Number>()->IsIntegral());
+    ASSERT(small->Get(2)->As<Number>()->IntegralValue() == bounds[2]);
+    ASSERT(!small->Get(3)->As<Number>()->IsIntegral());
+    ASSERT(small->Get(3)->As<Number>()->Value() == -4611686018427389952.0);
+
+    // Large ranges go into a hashmap
+    Handle<Array> large(Array::New());
+    int64_t* rows = new int64_t[100000];
+    for (int i = 0; i < 100000; i++) rows[i] = i * 3;
+    large->SetRange(0, 100000, rows);
+    large->SetRange(100000, 1, ints + 5);
+    ASSERT(large->Length() == 100001);
+    ASSERT(large->Get(99999)->As<Number>()->Value() == 299997);
+    ASSERT(large->Get(100000)->As<Number>()->Value() == 5);
+
+    for (int i = 0; i < 100000; i++) rows[i] = 0;
+    large->GetRange(1, 100000, rows);
+    ASSERT(rows[0] == 3 && rows[99998] == 299997 && rows[99999] == 5);
+    delete[] rows;
+  })
+
+  FUN_TEST("return (a, b) { return b - a }", {
+    Handle<Array> arr(Array::New());
+    for (int i = 0; i < 300; i++) {
+      arr->Set(i, Number::NewIntegral((i * 31) % 300));
+    }
+    arr->Sort();
+    ASSERT(arr->Length() == 300);
+    ASSERT(arr->Get(0)->As<Number>()->Value() == 0);
+    ASSERT(arr->Get(299)->As<Number>()->Value() == 299);
+
+    arr->Sort(result->As<Function>());
+    ASSERT(arr->Length() == 300);
+    ASSERT(arr->Get(0)->As<Number>()->Value() == 299);
+    ASSERT(arr->Get(299)->As<Number>()->Value() == 0);
+  })
+
+  FUN_TEST("return (add, neg) {\n"
+           "  x = add(1, 2.5) + add(0.5, 0.25) + neg(5) + neg(1.5)\n"
+           "  x = x + add('3', 1)\n"
+           "  i = 0\n"
+           "  while (i < 100000) {\n"
+           "    y = add(i, 0.5)\n"
+           "    i++\n"
+           "  }\n"
+           "  return x + y\n"
+           "}", {
+    Value* argv[2];
+    argv[0] = Function::New(SlowAdd, FastAdd);
+    argv[1] = Function::New(SlowNeg, FastNeg);
+
+    Value* ret = result->As<Function>()->Call(2, argv);
+    ASSERT(ret->As<Number>()->Value() == 2.25 + 99999.5);
+    ASSERT(fast_calls == 100003);
+    ASSERT(slow_calls == 2);
+  })
+
+  FUN_TEST("return (shift) { return [shift(7), shift(-8), shift(0.5)] }", {
+    Value* argv[1];
+    argv[0] = Function::New(SlowShift, FastShift);
+
+    // Results out of unboxed range are boxed
+    Handle<Array> ret(result->As<Function>()->Call(1, argv)->As<Array>());
+    Number* big = ret->Get(0)->As<Number>();
+    ASSERT(!big->IsIntegral());
+    ASSERT(big->Value() == 8070450532247928832.0);
+    ASSERT(ret->Get(1)->As<Number>()->Value() == -9223372036854775808.0);
+    ASSERT(ret->Get(2)->As<Number>()->IntegralValue() == 0);
+
+    ASSERT(!Number::NewIntegral(int64_t(1) << 62)->IsIntegral());
+    ASSERT(Number::NewIntegral((int64_t(1) << 62) - 1)->IsIntegral());
+  })
+
   FUN_TEST("return () { return global.g }", {
     Handle<Object> global(Object::New());
     global->Set(String::New("g", 1), Number::NewIntegral(1234));
@@ -324,6 +531,118 @@ TEST_START(api)
     ASSERT(ret->Is<Nil>());
   }
 
+  // Typed CData
+  {
+    Isolate i;
+    const char* code = "data = global.data\n"
+                       "data[1] = data[0] + data[2]\n"
+                       "return sizeof data";
+
+    Function* f = Function::New("api", code, strlen(code));
+
+    CData* data = CData::New(CData::kInt16, 3);
+    ASSERT(data->GetElementType() == CData::kInt16);
+    ASSERT(data->Length() == 3);
+
+    int16_t* elems = reinterpret_cast<int16_t*>(data->GetContents());
+    ASSERT(elems[1] == 0);
+    elems[0] = -300;
+    elems[2] = 100;
+
+    Object* global = Object::New();
+    global->Set(String::New("data", 4), data);
+
+    f->SetContext(global);
+
+    Value* ret = f->Call(0, NULL);
+    ASSERT(ret->As<Number>()->IntegralValue() == 3);
+
+    elems = reinterpret_cast<int16_t*>(data->GetContents());
+    ASSERT(elems[1] == -200);
+  }
+
+  // Bulk operations on typed CData
+  {
+    Isolate i;
+
+    // Odd length exercises vector tails
+    CData* a = CData::New(CData::kFloat64, 1001);
+    CData* b = CData::New(CData::kFloat64, 1001);
+    CData* c = CData::New(CData::kInt32, 500);
+    double* av = reinterpret_cast<double*>(a->GetContents());
+    for (int j = 0; j < 1001; j++) av[j] = j;
+
+    ASSERT(a->Sum() == 500500);
+    b->Fill(2);
+    ASSERT(a->Dot(b) == 1001000);
+
+    double min, max;
+    ASSERT(a->Min(&min) && a->Max(&max));
+    ASSERT(min == 0 && max == 1000);
+    ASSERT(a->IndexOf(777) == 777 && a->IndexOf(0.5) == -1);
+
+    b->ScaleAdd(a, 0.5);
+    ASSERT(reinterpret_cast<double*>(b->GetContents())[10] == 7);
+    b->Mul(a, b);
+    ASSERT(reinterpret_cast<double*>(b->GetContents())[10] == 70);
+
+    // Conversions and shortest length
+    c->Copy(a);
+    c->Add(c, c);
+    ASSERT(c->Sum() == 249500);
+    b->Sub(a, c);
+    ASSERT(reinterpret_cast<double*>(b->GetContents())[499] == -499);
+    ASSERT(reinterpret_cast<double*>(b->GetContents())[500] == 126000);
+
+    // Raw data is empty
+    CData* raw = CData::New(16);
+    ASSERT(raw->Sum() == 0 && !raw->Min(&min) && raw->IndexOf(0) == -1);
+    a->Div(raw, b);
+    ASSERT(a->Sum() == 500500);
+  }
+
+  // Map and Set
+  {
+    Isolate i;
+    const char* code = "m = global.m\n"
+                       "s = global.s\n"
+                       "m[s] = m.a + 1\n"
+                       "s.c = true\n"
+                       "delete m.a\n"
+                       "return typeof m";
+
+    Function* f = Function::New("api", code, strlen(code));
+
+    Map* m = Map::New();
+    Set* s = Set::New();
+    m->Set(String::New("a", 1), Number::NewIntegral(41));
+    s->Add(String::New("b", 1));
+    ASSERT(m->Size() == 1 && s->Size() == 1);
+    ASSERT(m->Has(String::New("a", 1)));
+    ASSERT(!s->Has(String::New("c", 1)));
+
+    Object* global = Object::New();
+    global->Set(String::New("m", 1), m);
+    global->Set(String::New("s", 1), s);
+
+    f->SetContext(global);
+
+    Value* ret = f->Call(0, NULL);
+    ASSERT(ret->As<String>()->Length() == 3);
+
+    ASSERT(m->Is<Map>() && m->Type() == Value::kMap);
+    ASSERT(m->Size() == 1 && !m->Has(String::New("a", 1)));
+    ASSERT(m->Get(s)->As<Number>()->IntegralValue() == 42);
+    ASSERT(s->Has(String::New("c", 1)) && s->Size() == 2);
+
+    Array* keys = s->Keys();
+    ASSERT(keys->Length() == 2);
+    ASSERT(keys->Get(1)->As<String>()->Length() == 1);
+
+    s->Delete(String::New("b", 1));
+    ASSERT(s->Size() == 1 && !s->Has(String::New("b", 1)));
+  }
+
   // CWrapper
   {
     Isolate i;
@@ -352,6 +671,145 @@ TEST_START(api)
     ASSERT(wrapper_destroyed == 1);
   }
 
+  // GC pauses
+  {
+    Isolate i;
+    const char* code = "i = 0\n"
+                       "while (i < 1100) {\n"
+                       "  __$gc()\n"
+                       "  i++\n"
+                       "}";
+
+    Function* f = Function::New("api", code, strlen(code));
+    f->Call(0, NULL);
+
+    GCStats stats;
+    i.GetGCStats(&stats);
+    uint32_t total = stats.new_space_count + stats.old_space_count;
+    ASSERT(total >= 1100);
+
+    // Only the most recent ones are copied
+    GCPause pauses[4];
+    ASSERT(i.GetGCPauses(pauses, 4) == total);
+    ASSERT(pauses[3].pause >= 0);
+  }
+
+  // Heap histogram
+  {
+    Isolate i;
+    const char* code = "a = []\n"
+                       "i = 0\n"
+                       "while (i < 100) {\n"
+                       "  a[i] = { key: 'str' + i }\n"
+                       "  i++\n"
+                       "}\n"
+                       "return a";
+
+    Function* f = Function::New("api", code, strlen(code));
+    Handle<Array> ret(f->Call(0, NULL)->As<Array>());
+
+    HeapHistogram h;
+    i.GetHeapHistogram(&h);
+
+    // Every byte belongs to exactly one type and generation
+    uint64_t total = h.new_space.bytes + h.old_space.bytes;
+    uint64_t types = 0;
+    for (int j = 0; j < HeapHistogram::kTypeCount; j++) {
+      types += h.types[j].bytes;
+    }
+    uint64_t generations = 0;
+    for (int j = 0; j < HeapHistogram::kGenerationCount; j++) {
+      generations += h.generations[j].bytes;
+    }
+    ASSERT(total > 0);
+    ASSERT(types == total);
+    ASSERT(generations == total);
+
+    ASSERT(h.types[HeapHistogram::kObject].count >= 100);
+    ASSERT(h.types[HeapHistogram::kString].count >= 100);
+    ASSERT(h.flat_strings.count + h.cons_strings.count ==
+           h.types[HeapHistogram::kString].count);
+    ASSERT(h.empty_map_slots.count > 0);
+  }
+
+  // Heap histogram after allocation-triggered collections
+  {
+    Isolate i;
+    const char* code = "i = 0\n"
+                       "while (i < 400000) {\n"
+                       "  sum = { a: i, b: i + 0.5 }\n"
+                       "  i++\n"
+                       "}\n"
+                       "return sum";
+
+    Function* f = Function::New("api", code, strlen(code));
+    Handle<Object> ret(f->Call(0, NULL)->As<Object>());
+
+    GCStats stats;
+    i.GetGCStats(&stats);
+    ASSERT(stats.new_space_count > 0);
+
+    HeapHistogram h;
+    i.GetHeapHistogram(&h);
+
+    uint64_t types = 0;
+    for (int j = 0; j < HeapHistogram::kTypeCount; j++) {
+      types += h.types[j].bytes;
+    }
+    ASSERT(types == h.new_space.bytes + h.old_space.bytes);
+    ASSERT(h.types[HeapHistogram::kObject].count > 0);
+  }
+
+  // Math module is installed by embedder
+  {
+    Isolate i;
+    const char* code = "m = global.math\n"
+                       "return m.round(0.49999999999999994) + "
+                       "global.math.floor(2.5) + m.pow(2, 3)";
+
+    Function* f = Function::New("api", code, strlen(code));
+    ASSERT(f->GetContext()->Get("math")->Is<Nil>());
+
+    Object* global = Object::New();
+    global->Set("math", Object::NewMath());
+    f->SetContext(global);
+
+    Value* ret = f->Call(0, NULL);
+    ASSERT(ret->Is<Number>());
+    ASSERT(ret->As<Number>()->Value() == 10);
+
+    // Contexts don't get it implicitly
+    global = Object::New();
+    f->SetContext(global);
+    ASSERT(global->Get("math")->Is<Nil>());
+  }
+
+  // Keys hit hinted slot when object stores property name as another string
+  {
+    RuntimeStats::Enable(false);
+    StatsIsolate i;
+    Handle<Array> objs(Array::New());
+
+    for (int64_t j = 0; j < 10; j++) {
+      Object* obj = Object::New();
+      obj->Set("a", Number::NewIntegral(1));
+      obj->Set("b", Number::NewIntegral(2));
+      objs->Set(j, obj);
+    }
+
+    // Only the first lookup goes to runtime (array elements are loaded
+    // through it too, so count only key lookups)
+    Key b("b");
+    uint64_t key_lookups = 0;
+    for (int64_t j = 0; j < objs->Length(); j++) {
+      Object* obj = objs->Get(j)->As<Object>();
+      uint64_t before = i.Count(RuntimeStats::kLookupProperty);
+      ASSERT(obj->Get(&b)->As<Number>()->Value() == 2);
+      key_lookups += i.Count(RuntimeStats::kLookupProperty) - before;
+    }
+    ASSERT(key_lookups == 1);
+  }
+
   // Regressions
   {
     Isolate i;
@@ -22,19 +22,24 @@ TEST_START(hir)
   HIR_TEST("return { a: 1 }",
            "# Block 0\n"
            "i0 = Entry[0]\n"
-           "i2 = AllocateObject\n"
-           "i4 = Literal[1]\n"
-           "i6 = Literal[a]\n"
-           "i8 = StoreProperty(i2, i6, i4)\n"
-           "i10 = Return(i2)\n")
+           "i2 = Literal\n"
+           "i4 = CloneLiteral(i2)\n"
+           "i6 = Return(i4)\n")
   HIR_TEST("return ['a']",
            "# Block 0\n"
            "i0 = Entry[0]\n"
-           "i2 = AllocateArray\n"
-           "i4 = Literal[0]\n"
-           "i6 = Literal[a]\n"
-           "i8 = StoreProperty(i2, i4, i6)\n"
-           "i10 = Return(i2)\n")
+           "i2 = Literal\n"
+           "i4 = CloneLiteral(i2)\n"
+           "i6 = Return(i4)\n")
+  // Typeof checks
+  HIR_TEST("a = {}\nreturn \"string\" !== typeof a.b",
+           "# Block 0\n"
+           "i0 = Entry[0]\n"
+           "i2 = AllocateObject\n"
+           "i4 = Literal[b]\n"
+           "i6 = LoadProperty(i2, i4)\n"
+           "i8 = TypeCheck[!5](i6)\n"
+           "i10 = Return(i8)\n")
   HIR_TEST("a = {}\na.b = 1\ndelete a.b\nreturn a.b",
            "# Block 0\n"
            "i0 = Entry[0]\n"
@@ -70,37 +75,18 @@ TEST_START(hir)
            "i2 = Function\n"
            "i4 = Literal[1]\n"
            "i6 = Literal[2]\n"
-           "i8 = AllocateArray\n"
-           "i10 = Literal[0]\n"
-           "i12 = Literal[3]\n"
-           "i14 = StoreProperty(i8, i10, i12)\n"
-           "i18 = Literal[4]\n"
-           "i20 = StoreProperty(i8, i4, i18)\n"
-           "i24 = Sizeof(i8)\n"
-           "i26 = BinOp(i6, i24)\n"
-           "i28 = AlignStack(i26)\n"
-           "i40 = BinOp(i26, i4)\n"
-           "i42 = StoreVarArg(i8, i40)\n"
-           "i44 = StoreArg(i6, i4)\n"
-           "i46 = StoreArg(i4, i10)\n"
-           "i48 = Call(i2, i26)\n"
-           "i50 = Return(i48)\n"
-           "# Block 1\n"
-           "i52 = Entry[0]\n"
-           "i54 = Literal[0]\n"
-           "i56 = LoadArg(i54)\n"
-           "i58 = Literal[1]\n"
-           "i60 = AllocateArray\n"
-           "i64 = LoadVarArg(i58, i58, i60)\n"
-           "i66 = Sizeof(i60)\n"
-           "i68 = BinOp(i58, i66)\n"
-           "i70 = LoadArg(i68)\n"
-           "i74 = LoadProperty(i60, i54)\n"
-           "i78 = LoadProperty(i60, i58)\n"
-           "i80 = BinOp(i78, i70)\n"
-           "i82 = BinOp(i74, i80)\n"
-           "i84 = BinOp(i56, i82)\n"
-           "i86 = Return(i84)\n")
+           "i8 = Literal\n"
+           "i10 = CloneLiteral(i8)\n"
+           "i14 = Sizeof(i10)\n"
+           "i16 = BinOp(i6, i14)\n"
+           "i18 = AlignStack(i16)\n"
+           "i20 = Literal[0]\n"
+           "i30 = BinOp(i16, i4)\n"
+           "i32 = StoreVarArg(i10, i30)\n"
+           "i34 = StoreArg(i6, i4)\n"
+           "i36 = StoreArg(i4, i20)\n"
+           "i38 = Call(i2, i16)\n"
+           "i40 = Return(i38)\n")
 
   // Unary operations
   HIR_TEST("i = 0\nreturn !i",
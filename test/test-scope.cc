@@ -12,30 +12,30 @@ TEST_START(scope)
   // Function
   SCOPE_TEST("() { a }", "[kFunction (anonymous) @[] [a @stack:0]]")
   SCOPE_TEST("a\n() { a }", "[a @context[0]:0] "
-                            "[kFunction (anonymous) @[] [a @context[1]:0]]")
+                            "[kFunction (anonymous) @[] [a @context[0]:0]]")
   SCOPE_TEST("a\n(a) { a }", "[a @stack:0] "
                             "[kFunction (anonymous) @[[a @stack:0]] [a @stack:0]]")
   SCOPE_TEST("(b) { a }(a = 1)",
-             "[kCall [kFunction (anonymous) @[[b @stack:0]] [a @context[1]:0]] "
+             "[kCall [kFunction (anonymous) @[[b @stack:0]] [a @context[0]:0]] "
              "@[[kAssign [a @context[0]:0] [1]]] ]")
   SCOPE_TEST("x = () { a }\na = 1",
              "[kAssign [x @stack:0] [kFunction (anonymous) @[] "
-             "[a @context[1]:0]]] [kAssign [a @context[0]:0] [1]]")
+             "[a @context[0]:0]]] [kAssign [a @context[0]:0] [1]]")
   SCOPE_TEST("a\n(a, b) { a\nb }",
              "[a @stack:0] "
              "[kFunction (anonymous) @[[a @stack:0] [b @stack:1]] "
              "[a @stack:0] [b @stack:1]]")
   SCOPE_TEST("() { a\n() { a } }",
              "[kFunction (anonymous) @[] [a @context[0]:0] "
-             "[kFunction (anonymous) @[] [a @context[1]:0]]]")
+             "[kFunction (anonymous) @[] [a @context[0]:0]]]")
   SCOPE_TEST("a() { }\nb(() { a })",
              "[kAssign [a @context[0]:0] [kFunction (anonymous) @[] [kNop ]]] "
              "[kCall [b @stack:0] "
-             "@[[kFunction (anonymous) @[] [a @context[1]:0]]]"
+             "@[[kFunction (anonymous) @[] [a @context[0]:0]]]"
              " ]")
   SCOPE_TEST("a() { b = 1234 }\nb = 13589\na()\nreturn b",
              "[kAssign [a @stack:0] "
-             "[kFunction (anonymous) @[] [kAssign [b @context[1]:0] [1234]]]] "
+             "[kFunction (anonymous) @[] [kAssign [b @context[0]:0] [1234]]]] "
              "[kAssign [b @context[0]:0] [13589]] "
              "[kCall [a @stack:0] @[] ] [return [b @context[0]:0]]")
 
@@ -65,7 +65,7 @@ TEST_START(scope)
              "[kCall [a @stack:0] @[[kFunction (anonymous) "
              "@[[b @stack:0]] [kCall [b @stack:0] @[] ]]] ]] "
              "@[[kFunction (anonymous) @[[fn @stack:0]] "
-             "[print @context[1]:0] "
+             "[print @context[0]:0] "
              "[kCall [fn @stack:0] "
-             "@[[kFunction (anonymous) @[] [print @context[2]:0]]] ]]] ]")
+             "@[[kFunction (anonymous) @[] [print @context[0]:0]]] ]]] ]")
 TEST_END(scope)
@@ -42,5 +42,38 @@
       'test-splaytree.cc',
       'test-list.cc',
     ]
+  }, {
+    'target_name': 'bench',
+    'type': 'executable',
+    'include_dirs': [
+      '../include'
+    ],
+    'cflags': ['-Wall', '-Wextra', '-Wno-unused-parameter',
+               '-fPIC', '-fno-strict-aliasing', '-fno-exceptions',
+               '-pedantic'],
+    'dependencies': ['../candor.gyp:candor'],
+    'sources': [
+      'bench.cc',
+    ]
+  }, {
+    'target_name': 'microbench',
+    'type': 'executable',
+    'include_dirs': [
+      '../include',
+      '../src',
+      '../test'
+    ],
+    'cflags': ['-Wall', '-Wextra', '-Wno-unused-parameter',
+               '-fPIC', '-fno-strict-aliasing', '-fno-exceptions',
+               '-pedantic'],
+    'dependencies': ['../candor.gyp:candor'],
+    'sources': [
+      'test.h',
+      'microbench.cc',
+      'microbench-list.h',
+      'bench-runtime.cc',
+      'bench-heap.cc',
+      'bench-compiler.cc',
+    ]
   }]
 }